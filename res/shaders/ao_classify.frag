@@ -0,0 +1,67 @@
+#version 330
+
+// Flags the tiles where the coarse AO is not enough. Every fragment of a tile
+// looks at the same 4x4 grid of pixels spanning the tile edges, so the whole
+// tile takes the same decision. Complex tiles write the stencil, simple ones
+// are discarded.
+
+uniform sampler2D coarse_texture;
+uniform sampler2D normalDepthTexture;
+
+uniform mat4 projection;
+
+uniform ivec2 viewport_size;
+uniform int tile_size;
+
+uniform float variance_threshold; // AO variance.
+uniform float depth_threshold; // Relative view depth range.
+
+float view_z(float p_depth) {
+  return -projection[3][2] / (2.0 * p_depth - 1.0 + projection[2][2]);
+}
+
+void main (void) {
+  ivec2 tile_origin = (ivec2(gl_FragCoord.xy) / tile_size) * tile_size;
+
+  float sum = 0.0;
+  float sum2 = 0.0;
+  float z_min = 1e30;
+  float z_max = -1e30;
+  int background = 0;
+
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      ivec2 pixel = tile_origin + (ivec2(x, y) * tile_size) / 3;
+      pixel = clamp(pixel, ivec2(0), viewport_size - 1);
+
+      float depth = texelFetch(normalDepthTexture, pixel, 0).a;
+      if (depth == 0.0) {
+        ++background;
+        continue;
+      }
+
+      float z = -view_z(depth);
+      z_min = min(z_min, z);
+      z_max = max(z_max, z);
+
+      float ao = texelFetch(coarse_texture, pixel, 0).r;
+      sum += ao;
+      sum2 += ao * ao;
+    }
+  }
+
+  if (background == 16) { // Nothing to shade.
+    discard;
+  }
+
+  float n = float(16 - background);
+  float mean = sum / n;
+  float variance = max(sum2 / n - mean * mean, 0.0);
+
+  bool silhouette = background > 0;
+  bool discontinuity = (z_max - z_min) > depth_threshold * z_min;
+
+  if (!silhouette && !discontinuity && variance < variance_threshold) {
+    discard;
+  }
+}
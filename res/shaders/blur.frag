@@ -6,21 +6,27 @@ out vec4 frag_color;
 
 uniform bool h;
 uniform sampler2D normalDepthTexture;
+uniform vec2 uv_scale; // Viewport size over texture size.
 
 uniform float weight[5] = float[] (0.2270270270, 0.1945945946, 0.1216216216, 0.0540540541, 0.0162162162);
 
+vec3 sample_viewport(vec2 uv, vec2 offset) { // Clamp to the viewport edge.
+  return texture(normalDepthTexture, clamp(uv, offset * 0.5, uv_scale - offset * 0.5)).rgb;
+}
+
 void main (void) {
   vec2 offset = 1.0 / textureSize(normalDepthTexture, 0);
+  vec2 uv = pos * uv_scale;
 
-  vec3 res = texture(normalDepthTexture, pos).rgb * weight[0];
+  vec3 res = texture(normalDepthTexture, uv).rgb * weight[0];
 
   for(int i = 1; i < 5; ++i) {
     if (h) {
-      res += texture(normalDepthTexture, pos + vec2(offset.x * i, 0.0)).rgb * weight[i];
-      res += texture(normalDepthTexture, pos - vec2(offset.x * i, 0.0)).rgb * weight[i];
+      res += sample_viewport(uv + vec2(offset.x * i, 0.0), offset) * weight[i];
+      res += sample_viewport(uv - vec2(offset.x * i, 0.0), offset) * weight[i];
     } else {
-      res += texture(normalDepthTexture, pos + vec2(0.0, offset.y * i)).rgb * weight[i];
-      res += texture(normalDepthTexture, pos - vec2(0.0, offset.y * i)).rgb * weight[i];
+      res += sample_viewport(uv + vec2(0.0, offset.y * i), offset) * weight[i];
+      res += sample_viewport(uv - vec2(0.0, offset.y * i), offset) * weight[i];
     }
   }
 
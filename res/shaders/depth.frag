@@ -5,8 +5,9 @@ smooth in vec2 pos;
 out vec4 frag_color;
 
 uniform sampler2D normalDepthTexture;
+uniform vec2 uv_scale;
 
 void main (void) {
-  float d = texture(normalDepthTexture, pos).a;
+  float d = texture(normalDepthTexture, pos * uv_scale).a;
   frag_color = vec4(d, d, d, 1.0);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 layout (location = 0) in vec3 vert;
 layout (location = 1) in vec3 normal;
+layout (location = 2) in mat4 instance_model;
 
 uniform mat4 projection;
 uniform mat4 view;
@@ -11,7 +12,7 @@ smooth out vec3 pos_view;
 smooth out float depth_view;
 
 void main(void) {
-  gl_Position = view * model * vec4(vert, 1.0);
+  gl_Position = view * model * instance_model * vec4(vert, 1.0);
   pos_view = gl_Position.xyz;
   gl_Position = projection * gl_Position;
 
@@ -0,0 +1,12 @@
+#version 330
+
+layout (location = 0) in vec3 vert;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in mat4 instance_model;
+
+uniform mat4 model;
+
+void main(void) {
+  // World space, g_layered.geom applies the view of every layer.
+  gl_Position = model * instance_model * vec4(vert, 1.0);
+}
@@ -0,0 +1,147 @@
+#version 330
+
+// Ground truth ambient occlusion (Jimenez et al. 2016). Every slice is a plane
+// containing the view vector: the two horizons of the slice are searched in
+// opposite screen directions and the cosine weighted visibility between them
+// is integrated analytically, so each slice covers two HBAO directions.
+
+const float PI = 3.14159265359;
+const float HALF_PI = 1.57079632679;
+
+smooth in vec2 pos;
+smooth in vec2 screen_ray;
+
+uniform sampler2D normalDepthTexture;
+
+uniform sampler2D noise_texture;
+
+uniform mat4 projection;
+
+uniform float aspect_ratio;
+uniform float tan_half_fov;
+uniform vec2 ray_center;
+
+uniform vec2 pixel_size;
+uniform ivec2 pixel_offset; // Viewport origin in the whole image, non zero for tiles.
+uniform vec2 uv_scale; // Viewport size over texture size.
+
+// Parameters
+uniform int slices;
+uniform int steps;
+uniform float radius;
+uniform float strength;
+
+out vec4 frag_color;
+
+vec3 unproject (vec2 screen_ray, float p_depth) {
+  vec3 p_view;
+  p_view.z = -projection[3][2] / (2.0 * p_depth - 1.0 + projection[2][2]);
+  p_view.x = screen_ray.x * -p_view.z;
+  p_view.y = screen_ray.y * -p_view.z;
+
+  return p_view;
+}
+
+float random(vec2 pixel) { // Indexed by image pixel, tiles continue the pattern of their neighbours.
+  return texture(noise_texture, pixel / textureSize(noise_texture, 0)).r;
+}
+
+// Cosine of the highest horizon found marching from p along r_texture_inc.
+float horizon_cos(vec3 p_view, vec3 v_view, vec2 r_texture_inc, int march_steps, float jitter, float low_cos) {
+  float h_cos = low_cos;
+
+  for (int j = 0; j < march_steps; ++j) {
+    vec2 s_texture = pos + r_texture_inc * (float(j) + 1.0 - jitter); // Jittered, up to the radius.
+    vec2 s_texture_snap = (round(s_texture / pixel_size) + 0.5) * pixel_size; // Snap to pixels centers.
+
+    vec2 s_texture_clamp = clamp(s_texture_snap, pixel_size * 0.5, 1.0 - pixel_size * 0.5); // Clamp to the viewport edge.
+    float s_depth = texture(normalDepthTexture, s_texture_clamp * uv_scale).a;
+    if (s_depth == 0.0) { // Discard sample if we do not have depth information.
+      continue;
+    }
+
+    vec2 s_screen_ray = (s_texture_snap * 2.0 - 1.0) * tan_half_fov;
+    s_screen_ray.x *= aspect_ratio;
+    s_screen_ray += ray_center;
+    vec3 d_view = unproject(s_screen_ray, s_depth) - p_view;
+
+    float d_view_len2 = dot(d_view, d_view);
+    if (d_view_len2 < 1e-8) { // Snapped to p.
+      continue;
+    }
+
+    float s_cos = dot(d_view, v_view) * inversesqrt(d_view_len2);
+
+    float falloff = clamp(1.0 - d_view_len2 / (radius * radius), 0.0, 1.0);
+    h_cos = max(h_cos, mix(low_cos, s_cos, falloff));
+  }
+
+  return h_cos;
+}
+
+void main (void) {
+  vec4 p_g_buffer = texture(normalDepthTexture, pos * uv_scale);
+
+  vec3 n_view = p_g_buffer.rgb;
+
+  float p_depth = p_g_buffer.a;
+
+  if (p_depth == 0.0) {
+    frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  vec3 p_view = unproject(screen_ray, p_depth);
+  vec3 v_view = normalize(-p_view);
+
+  // No horizon is found under a one pixel radius. At most one step per pixel.
+  float r_pixels = radius * projection[1][1] * 0.5 / (-p_view.z * pixel_size.y);
+  if (r_pixels < 1.0) {
+    frag_color = vec4(1.0, 1.0, 1.0, 1.0);
+    return;
+  }
+  int march_steps = min(steps, int(r_pixels));
+
+  vec4 p_clip = projection * vec4(p_view, 1.0);
+  vec2 p_texture = (p_clip.xy / p_clip.w) * 0.5 + 0.5;
+
+  float noise = random(pos / pixel_size + vec2(pixel_offset));
+  float jitter = fract(noise + 0.61803398875); // Decorrelated from the slice rotation.
+
+  float visibility = 0.0;
+
+  for (int i = 0; i < slices; ++i) {
+    float phi = (float(i) + noise) * (PI / float(slices));
+    vec3 d_view = vec3(cos(phi), sin(phi), 0.0); // Slice direction.
+
+    vec4 q_clip = projection * vec4(p_view + d_view * radius, 1.0); // Project the radius from view to texture space.
+    vec2 r_texture_inc = ((q_clip.xy / q_clip.w) * 0.5 + 0.5 - p_texture) / float(march_steps);
+
+    // Normal projected onto the slice plane and its angle to the view vector.
+    vec3 ortho_view = d_view - dot(d_view, v_view) * v_view;
+    vec3 axis_view = normalize(cross(ortho_view, v_view));
+    vec3 n_proj = n_view - axis_view * dot(n_view, axis_view);
+    float n_proj_len = length(n_proj);
+
+    float n_cos = clamp(dot(n_proj, v_view) / n_proj_len, 0.0, 1.0);
+    float n_a = sign(dot(ortho_view, n_proj)) * acos(n_cos);
+
+    float h_cos_0 = horizon_cos(p_view, v_view, -r_texture_inc, march_steps, jitter, cos(n_a - HALF_PI));
+    float h_cos_1 = horizon_cos(p_view, v_view, r_texture_inc, march_steps, jitter, cos(n_a + HALF_PI));
+
+    // Horizon angles, clamped to the hemisphere around the normal.
+    float h_0 = n_a + max(-acos(h_cos_0) - n_a, -HALF_PI);
+    float h_1 = n_a + min(acos(h_cos_1) - n_a, HALF_PI);
+
+    // Cosine weighted visibility of the arc between the horizons.
+    float sin_n = sin(n_a);
+    float arc_0 = n_cos + 2.0 * h_0 * sin_n - cos(2.0 * h_0 - n_a);
+    float arc_1 = n_cos + 2.0 * h_1 * sin_n - cos(2.0 * h_1 - n_a);
+    visibility += n_proj_len * 0.25 * (arc_0 + arc_1);
+  }
+
+  visibility /= float(slices);
+
+  float ao = clamp(1.0 - (1.0 - visibility) * strength, 0.0, 1.0);
+  frag_color = vec4(ao, ao, ao, 1.0);
+}
@@ -1,6 +1,7 @@
 #version 330
 
 const float PI = 3.14159265359;
+const float GOLDEN_RATIO_CONJUGATE = 0.61803398875;
 
 smooth in vec2 pos;
 smooth in vec2 screen_ray;
@@ -13,8 +14,11 @@ uniform mat4 projection;
 
 uniform float aspect_ratio;
 uniform float tan_half_fov;
+uniform vec2 ray_center;
 
 uniform vec2 pixel_size;
+uniform ivec2 pixel_offset; // Viewport origin in the whole image, non zero for tiles.
+uniform vec2 uv_scale; // Viewport size over texture size.
 
 // Parameters
 uniform int directions;
@@ -41,12 +45,12 @@ vec3 unproject (vec2 screen_ray, float p_depth) {
   return p_view;
 }
 
-float random(vec2 st) {
-  return texture(noise_texture, st / (pixel_size * textureSize(noise_texture, 0))).r;
+float random(vec2 pixel) { // Indexed by image pixel, tiles continue the pattern of their neighbours.
+  return texture(noise_texture, pixel / textureSize(noise_texture, 0)).r;
 }
 
 void main (void) {
-  vec4 p_g_buffer = texture(normalDepthTexture, pos);
+  vec4 p_g_buffer = texture(normalDepthTexture, pos * uv_scale);
 
   vec3 n_view = p_g_buffer.rgb;
 
@@ -59,9 +63,19 @@ void main (void) {
 
   vec3 p_view = unproject(screen_ray, p_depth);
 
+  // Radius projected to pixels. Under a pixel every sample snaps to p, and
+  // there is no point in marching more steps than pixels.
+  float r_pixels = radius * projection[1][1] * 0.5 / (-p_view.z * pixel_size.y);
+  if (r_pixels < 1.0) {
+    frag_color = vec4(1.0, 1.0, 1.0, 1.0);
+    return;
+  }
+  int march_steps = min(steps, int(r_pixels));
+
   float sum = 0.0;
 
-  float start = random(pos) * (PI * 0.5); // Random starting angle.
+  float noise = random(pos / pixel_size + vec2(pixel_offset));
+  float start = noise * (PI * 0.5); // Random starting angle.
   float end = start + (PI * 0.5);
   float step = (PI * 0.5) / float(directions);
   for (float d_a = start; d_a < end; d_a += step) { // Iterate over a single quadrant.
@@ -72,7 +86,7 @@ void main (void) {
       vec4 q_clip = projection * vec4(q_view, 1.0); // Project shpere end point from veiw to texture sapce.
       vec2 q_texture = (q_clip.xy / q_clip.w) * 0.5 + 0.5;
 
-      vec2 r_texture_inc = (q_texture - pos) / steps;
+      vec2 r_texture_inc = (q_texture - pos) / march_steps;
 
       vec3 t_view = normalize(cross(n_view, cross(r_view, vec3(0.0, 0.0, 1.0))));
 
@@ -82,18 +96,22 @@ void main (void) {
       float ao_pre = 0.0;
       float wao = 0.0;
 
+      float jitter = fract(noise + GOLDEN_RATIO_CONJUGATE); // Decorrelated from the start angle.
       vec2 s_texture = pos; // Sample point.
-      for (int j = 0; j < steps; ++j) { // Marching on the heighfield.
-        s_texture += r_texture_inc * (0.1 + random(pos + j) * 0.9); // Random step size. Between 0.1 and 1.0.
+      for (int j = 0; j < march_steps; ++j) { // Marching on the heighfield.
+        s_texture += r_texture_inc * (0.1 + jitter * 0.9); // Random step size. Between 0.1 and 1.0.
+        jitter = fract(jitter + GOLDEN_RATIO_CONJUGATE);
         vec2 s_texture_snap = (round(s_texture / pixel_size) + 0.5) * pixel_size; // Snap to pixels centers.
 
-        float s_depth = texture(normalDepthTexture, s_texture_snap.xy).a;
+        vec2 s_texture_clamp = clamp(s_texture_snap, pixel_size * 0.5, 1.0 - pixel_size * 0.5); // Clamp to the viewport edge.
+        float s_depth = texture(normalDepthTexture, s_texture_clamp * uv_scale).a;
         if (s_depth == 0.0) { // Discard sample if we do not have depth information.
           continue;
         }
 
         vec2 s_screen_ray = (s_texture_snap * 2.0 - 1.0) * tan_half_fov;
         s_screen_ray.x *= aspect_ratio;
+        s_screen_ray += ray_center;
         vec3 s_view = unproject(s_screen_ray, s_depth);
 
         vec3 d_view = s_view - p_view;
@@ -0,0 +1,148 @@
+#version 330
+
+// Same estimator as hbao.frag without transcendentals in the loops:
+// - The starting direction and the step jitter come from direction_texture,
+//   precomputed per noise texel on the CPU, and the directions are obtained by
+//   rotating it incrementally. The four quadrants are 90 degree swaps.
+// - Horizons are compared by their sines, d.z / |d|, which are monotonic in
+//   the horizon angle, so no atan is needed. The biased tangent sine is
+//   sin(t + bias) = sin(t) cos(bias) + cos(t) sin(bias).
+// - Lengths use inversesqrt and the radius test is done on squared lengths.
+// - The step jitter is an additive golden ratio sequence instead of one noise
+//   lookup per step, and samples are fetched with texelFetch.
+
+smooth in vec2 pos;
+smooth in vec2 screen_ray;
+
+uniform sampler2D normalDepthTexture;
+
+uniform sampler2D direction_texture; // cos and sin of the starting angle, step jitter.
+
+uniform mat4 projection;
+
+uniform float aspect_ratio;
+uniform float tan_half_fov;
+uniform vec2 ray_center;
+
+uniform vec2 pixel_size;
+uniform ivec2 pixel_offset; // Viewport origin in the whole image, non zero for tiles.
+uniform ivec2 viewport_size;
+
+uniform vec2 step_rotation; // cos and sin of the angle between directions.
+uniform vec2 sin_cos_bias; // sin and cos of t_bias.
+
+// Parameters
+uniform int directions;
+uniform int steps;
+uniform float radius;
+uniform float strength;
+
+out vec4 frag_color;
+
+const float GOLDEN_RATIO_CONJUGATE = 0.61803398875;
+
+float view_z(float p_depth) {
+  return -projection[3][2] / (2.0 * p_depth - 1.0 + projection[2][2]);
+}
+
+void main (void) {
+  ivec2 pixel = ivec2(gl_FragCoord.xy);
+  vec4 p_g_buffer = texelFetch(normalDepthTexture, pixel, 0);
+
+  vec3 n_view = p_g_buffer.rgb;
+
+  float p_depth = p_g_buffer.a;
+
+  if (p_depth == 0.0) {
+    frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  float p_z = view_z(p_depth);
+  vec3 p_view = vec3(screen_ray * -p_z, p_z);
+
+  // Projected radius in pixels, same clamping as hbao.frag.
+  float r_pixels = radius * projection[1][1] * 0.5 / (-p_z * pixel_size.y);
+  if (r_pixels < 1.0) {
+    frag_color = vec4(1.0, 1.0, 1.0, 1.0);
+    return;
+  }
+  int march_steps = min(steps, int(r_pixels));
+
+  // Screen ray of a pixel center: ray = pixel * ray_scale + ray_offset.
+  vec2 ray_offset = vec2(tan_half_fov * aspect_ratio, tan_half_fov);
+  vec2 ray_scale = 2.0 * pixel_size * ray_offset;
+  ray_offset = 0.5 * ray_scale - ray_offset + ray_center;
+
+  // The sphere end points only differ in x and y, so their w is the one of p.
+  vec4 p_clip = projection * vec4(p_view, 1.0);
+  float inv_w = 1.0 / p_clip.w;
+  vec2 p_pixel = ((p_clip.xy * inv_w) * 0.5 + 0.5) / pixel_size - pos / pixel_size;
+  mat2 r_to_pixel = mat2(projection) * (radius * 0.5 * inv_w);
+  float inv_steps = 1.0 / float(march_steps);
+
+  float radius2 = radius * radius;
+  float inv_radius2 = 1.0 / radius2;
+
+  vec3 d_jitter = texelFetch(direction_texture, (pixel + pixel_offset) % textureSize(direction_texture, 0), 0).rgb;
+  vec2 dir = d_jitter.xy;
+
+  float sum = 0.0;
+
+  for (int k = 0; k < directions; ++k) { // Iterate over a single quadrant.
+    for (int i = 0; i < 4; ++i) { // Uniform directions distribution (4 quadrants).
+      vec2 r_xy = i == 0 ? dir : i == 1 ? vec2(-dir.y, dir.x) : i == 2 ? -dir : vec2(dir.y, -dir.x);
+
+      vec2 r_pixel_inc = (p_pixel + r_to_pixel * r_xy / pixel_size) * inv_steps;
+
+      // t = cross(n, cross(r, z)), expanded.
+      vec3 t_view = vec3(n_view.z * r_xy, -dot(n_view.xy, r_xy));
+      float t_inv_len = inversesqrt(dot(t_view, t_view));
+      float t_sin = t_view.z * t_inv_len;
+      float t_cos = abs(n_view.z) * t_inv_len;
+
+      float h_sin_pre = t_sin * sin_cos_bias.y + t_cos * sin_cos_bias.x;
+      float ao_pre = 0.0;
+      float wao = 0.0;
+
+      float jitter = d_jitter.z;
+      vec2 s_pixel = vec2(pixel) + 0.5; // Sample point.
+      for (int j = 0; j < march_steps; ++j) { // Marching on the heighfield.
+        s_pixel += r_pixel_inc * (0.1 + jitter * 0.9); // Random step size. Between 0.1 and 1.0.
+        jitter = fract(jitter + GOLDEN_RATIO_CONJUGATE);
+
+        ivec2 s_snap = clamp(ivec2(round(s_pixel)), ivec2(0), viewport_size - 1); // Snap to pixels, clamp to the viewport edge.
+        float s_depth = texelFetch(normalDepthTexture, s_snap, 0).a;
+        if (s_depth == 0.0) { // Discard sample if we do not have depth information.
+          continue;
+        }
+
+        float s_z = view_z(s_depth);
+        vec3 s_view = vec3((vec2(s_snap) * ray_scale + ray_offset) * -s_z, s_z);
+
+        vec3 d_view = s_view - p_view;
+        float d_view_len2 = dot(d_view, d_view);
+        float d_inv_len = inversesqrt(d_view_len2);
+
+        float h_sin = d_view.z * d_inv_len; // Horizon sine.
+
+        if (h_sin > h_sin_pre && d_view_len2 <= radius2) {
+          float ao = h_sin - t_sin; // Per-sample attenuation.
+
+          wao += (ao - ao_pre) * (1.0 - d_view_len2 * inv_radius2);
+
+          h_sin_pre = h_sin;
+          ao_pre = ao;
+        }
+      }
+
+      sum += wao;
+    }
+
+    dir = vec2(dir.x * step_rotation.x - dir.y * step_rotation.y,
+               dir.x * step_rotation.y + dir.y * step_rotation.x);
+  }
+
+  float ao = 1.0 - (sum * strength / float(4 * directions));
+  frag_color = vec4(ao, ao, ao, 1.0);
+}
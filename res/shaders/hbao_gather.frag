@@ -0,0 +1,151 @@
+#version 330
+#extension GL_ARB_texture_gather : require
+
+// HBAO marching on the single channel view space z of linear_z.frag. Every
+// step gathers the 2x2 quad of texels around the sample point in one fetch
+// and takes the highest horizon of the four as the step sample, so the march
+// covers the radius with half the steps of hbao.frag and a quarter of the
+// bytes per fetched texel.
+
+const float PI = 3.14159265359;
+const float GOLDEN_RATIO_CONJUGATE = 0.61803398875;
+
+const vec2 GATHER_OFFSETS[4] = vec2[](vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0), vec2(0.0, 0.0)); // textureGather order.
+
+smooth in vec2 pos;
+smooth in vec2 screen_ray;
+
+uniform sampler2D normalDepthTexture;
+uniform sampler2D linear_z_texture;
+
+uniform sampler2D noise_texture;
+
+uniform mat4 projection;
+
+uniform float aspect_ratio;
+uniform float tan_half_fov;
+uniform vec2 ray_center;
+
+uniform vec2 pixel_size;
+uniform ivec2 pixel_offset; // Viewport origin in the whole image, non zero for tiles.
+uniform vec2 uv_scale; // Viewport size over texture size.
+
+// Parameters
+uniform int directions;
+uniform int steps;
+uniform float radius;
+uniform float t_bias;
+uniform float strength;
+
+out vec4 frag_color;
+
+const mat2 UNIFORM_DIRECTIONS[4] = mat2[](
+  mat2(cos(0),              sin(0),              -sin(0),              cos(0)),
+  mat2(cos(PI * 0.5),       sin(PI * 0.5),       -sin(PI * 0.5),       cos(PI * 0.5)),
+  mat2(cos(PI),             sin(PI),             -sin(PI),             cos(PI)),
+  mat2(cos(PI * 3.0 / 2.0), sin(PI * 3.0 / 2.0), -sin(PI * 3.0 / 2.0), cos(PI * 3.0 / 2.0))
+);
+
+float random(vec2 pixel) { // Indexed by image pixel, tiles continue the pattern of their neighbours.
+  return texture(noise_texture, pixel / textureSize(noise_texture, 0)).r;
+}
+
+void main (void) {
+  vec4 p_g_buffer = texture(normalDepthTexture, pos * uv_scale);
+
+  vec3 n_view = p_g_buffer.rgb;
+
+  float p_z = texelFetch(linear_z_texture, ivec2(gl_FragCoord.xy), 0).r;
+
+  if (p_z == 0.0) {
+    frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  vec3 p_view = vec3(screen_ray * -p_z, p_z);
+
+  float r_pixels = radius * projection[1][1] * 0.5 / (-p_z * pixel_size.y);
+  if (r_pixels < 1.0) {
+    frag_color = vec4(1.0, 1.0, 1.0, 1.0);
+    return;
+  }
+  int gathers = (min(steps, int(r_pixels)) + 1) / 2;
+
+  vec2 viewport = 1.0 / pixel_size;
+  vec2 z_texel_size = 1.0 / vec2(textureSize(linear_z_texture, 0));
+
+  float sum = 0.0;
+
+  float noise = random(pos / pixel_size + vec2(pixel_offset));
+  float start = noise * (PI * 0.5); // Random starting angle.
+  float end = start + (PI * 0.5);
+  float step = (PI * 0.5) / float(directions);
+  for (float d_a = start; d_a < end; d_a += step) { // Iterate over a single quadrant.
+    for (int i = 0; i < 4; ++i) { // Uniform directions distribution (4 quadrants).
+      vec3 r_view = vec3(UNIFORM_DIRECTIONS[i] * vec2(cos(d_a) , sin(d_a)), 0.0); // Radius vector, unit length.
+
+      vec4 q_clip = projection * vec4(p_view + r_view * radius, 1.0); // Sphere end point in clip space.
+      vec2 q_texture = (q_clip.xy / q_clip.w) * 0.5 + 0.5;
+
+      vec2 r_texture_inc = (q_texture - pos) / float(gathers);
+
+      vec3 t_view = normalize(cross(n_view, cross(r_view, vec3(0.0, 0.0, 1.0))));
+
+      float t_a = atan(t_view.z, length(t_view.xy)) + t_bias; // Tangent angle. Tangent angle bias.
+
+      float h_a_pre = t_a;
+      float ao_pre = 0.0;
+      float wao = 0.0;
+
+      float jitter = fract(noise + GOLDEN_RATIO_CONJUGATE); // Decorrelated from the start angle.
+      vec2 s_texture = pos; // Sample point.
+      for (int j = 0; j < gathers; ++j) { // Marching on the heighfield.
+        s_texture += r_texture_inc * (0.1 + jitter * 0.9); // Random step size. Between 0.1 and 1.0.
+        jitter = fract(jitter + GOLDEN_RATIO_CONJUGATE);
+
+        // Lower left texel of the bilinear footprint, kept inside the viewport.
+        vec2 base = floor(clamp(s_texture * viewport, vec2(1.0), viewport - 1.0) - 0.5);
+        vec4 s_z = textureGather(linear_z_texture, (base + 1.0) * z_texel_size);
+
+        float h_a = -PI; // Highest horizon of the quad.
+        vec3 h_view = vec3(0.0);
+        for (int k = 0; k < 4; ++k) {
+          if (s_z[k] == 0.0) { // Discard sample if we do not have depth information.
+            continue;
+          }
+
+          vec2 s_screen_ray = ((base + GATHER_OFFSETS[k] + 0.5) * pixel_size * 2.0 - 1.0) * tan_half_fov;
+          s_screen_ray.x *= aspect_ratio;
+          s_screen_ray += ray_center;
+          vec3 d_view = vec3(s_screen_ray * -s_z[k], s_z[k]) - p_view;
+
+          float d_xy_len = length(d_view.xy);
+          if (d_xy_len < 1e-6 || dot(d_view, d_view) > radius * radius) { // p itself, or outside the sphere.
+            continue;
+          }
+
+          float s_h_a = atan(d_view.z / d_xy_len);
+          if (s_h_a > h_a) {
+            h_a = s_h_a;
+            h_view = d_view;
+          }
+        }
+
+        if (h_a > h_a_pre) {
+          float ao = normalize(h_view).z - t_view.z; // Per-sample attenuation.
+
+          float r_norm = length(h_view) / radius;
+          wao += (ao - ao_pre) * (1.0 - r_norm * r_norm);
+
+          h_a_pre = h_a;
+          ao_pre = ao;
+        }
+      }
+
+      sum += wao;
+    }
+  }
+
+  float ao = 1.0 - (sum * strength / float(4 * directions));
+  frag_color = vec4(ao, ao, ao, 1.0);
+}
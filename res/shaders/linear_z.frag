@@ -0,0 +1,16 @@
+#version 330
+
+// View space z of the G buffer in a single channel, 0.0 where there is no
+// geometry, for the techniques that gather depth quads.
+
+uniform sampler2D normalDepthTexture;
+
+uniform mat4 projection;
+
+out vec4 frag_color;
+
+void main (void) {
+  float depth = texelFetch(normalDepthTexture, ivec2(gl_FragCoord.xy), 0).a;
+  float z = depth == 0.0 ? 0.0 : -projection[3][2] / (2.0 * depth - 1.0 + projection[2][2]);
+  frag_color = vec4(z, 0.0, 0.0, 1.0);
+}
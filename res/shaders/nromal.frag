@@ -5,11 +5,12 @@ smooth in vec2 pos;
 out vec4 frag_color;
 
 uniform sampler2D normalDepthTexture;
+uniform vec2 uv_scale;
 
 void main (void) {
-  if (texture(normalDepthTexture, pos).b < 0) {
+  if (texture(normalDepthTexture, pos * uv_scale).b < 0) {
      frag_color = vec4(1.0, 1.0, 1.0, 1.0);
   } else {
-    frag_color = vec4(0.5 + texture(normalDepthTexture, pos).rgb, 1.0);
+    frag_color = vec4(0.5 + texture(normalDepthTexture, pos * uv_scale).rgb, 1.0);
   }
 }
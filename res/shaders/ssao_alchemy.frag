@@ -0,0 +1,93 @@
+#version 330
+
+// Alchemy SSAO (McGuire et al. 2011). Samples on a screen space spiral within
+// the projected radius; each one occludes by the cosine between the normal and
+// the vector to it over its distance.
+
+const float PI = 3.14159265359;
+const float TURNS = 7.0; // Spiral turns.
+const float BETA = 0.002; // Depth dependent bias.
+const float EPSILON = 0.0001;
+
+smooth in vec2 pos;
+smooth in vec2 screen_ray;
+
+uniform sampler2D normalDepthTexture;
+
+uniform sampler2D noise_texture;
+
+uniform mat4 projection;
+
+uniform float aspect_ratio;
+uniform float tan_half_fov;
+uniform vec2 ray_center;
+
+uniform vec2 pixel_size;
+uniform ivec2 pixel_offset; // Viewport origin in the whole image, non zero for tiles.
+uniform vec2 uv_scale; // Viewport size over texture size.
+
+// Parameters
+uniform int samples;
+uniform float radius;
+uniform float strength;
+
+out vec4 frag_color;
+
+float view_z(float p_depth) {
+  return -projection[3][2] / (2.0 * p_depth - 1.0 + projection[2][2]);
+}
+
+float random(vec2 pixel) { // Indexed by image pixel, tiles continue the pattern of their neighbours.
+  return texture(noise_texture, pixel / textureSize(noise_texture, 0)).r;
+}
+
+void main (void) {
+  vec4 p_g_buffer = texture(normalDepthTexture, pos * uv_scale);
+
+  vec3 n_view = p_g_buffer.rgb;
+
+  float p_depth = p_g_buffer.a;
+
+  if (p_depth == 0.0) {
+    frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  float p_z = view_z(p_depth);
+  vec3 p_view = vec3(screen_ray * -p_z, p_z);
+
+  vec2 r_texture = vec2(projection[0][0], projection[1][1]) * (0.5 * radius / -p_z); // Projected radius.
+
+  float rotation = random(pos / pixel_size + vec2(pixel_offset)) * 2.0 * PI;
+
+  float sum = 0.0;
+
+  for (int i = 0; i < samples; ++i) {
+    float alpha = (float(i) + 0.5) / float(samples);
+    float angle = alpha * (TURNS * 2.0 * PI) + rotation;
+
+    vec2 s_texture = pos + vec2(cos(angle), sin(angle)) * r_texture * alpha;
+    vec2 s_texture_snap = (floor(s_texture / pixel_size) + 0.5) * pixel_size; // Snap to pixels centers.
+    vec2 s_texture_clamp = clamp(s_texture_snap, pixel_size * 0.5, 1.0 - pixel_size * 0.5); // Clamp to the viewport edge.
+
+    float s_depth = texture(normalDepthTexture, s_texture_clamp * uv_scale).a;
+    if (s_depth == 0.0) { // Discard sample if we do not have depth information.
+      continue;
+    }
+
+    vec2 s_screen_ray = (s_texture_snap * 2.0 - 1.0) * tan_half_fov;
+    s_screen_ray.x *= aspect_ratio;
+    s_screen_ray += ray_center;
+    float s_z = view_z(s_depth);
+    vec3 v_view = vec3(s_screen_ray * -s_z, s_z) - p_view;
+
+    float v_view_len2 = dot(v_view, v_view);
+    float falloff = v_view_len2 < radius * radius ? 1.0 : 0.0; // Outside the sphere.
+
+    sum += falloff * max(0.0, dot(v_view, n_view) + p_z * BETA) / (v_view_len2 + EPSILON);
+  }
+
+  // The radius keeps the estimate independent of the scene scale.
+  float ao = max(0.0, 1.0 - 2.0 * strength * radius * sum / float(samples));
+  frag_color = vec4(ao, ao, ao, 1.0);
+}
@@ -0,0 +1,86 @@
+#version 330
+
+// Crytek style SSAO (Mittring 2007). Points are sampled in a sphere around p
+// and a point is occluded when the G buffer surface is in front of it. The
+// sphere ignores the normal, so a flat surface occludes half of the samples;
+// only the occlusion above one half darkens the pixel.
+
+const float PI = 3.14159265359;
+const float GOLDEN_ANGLE = 2.39996322973;
+
+smooth in vec2 pos;
+smooth in vec2 screen_ray;
+
+uniform sampler2D normalDepthTexture;
+
+uniform sampler2D noise_texture;
+
+uniform mat4 projection;
+
+uniform vec2 pixel_size;
+uniform ivec2 pixel_offset; // Viewport origin in the whole image, non zero for tiles.
+uniform vec2 uv_scale; // Viewport size over texture size.
+
+// Parameters
+uniform int samples;
+uniform float radius;
+uniform float strength;
+
+out vec4 frag_color;
+
+float view_z(float p_depth) {
+  return -projection[3][2] / (2.0 * p_depth - 1.0 + projection[2][2]);
+}
+
+float random(vec2 pixel) { // Indexed by image pixel, tiles continue the pattern of their neighbours.
+  return texture(noise_texture, pixel / textureSize(noise_texture, 0)).r;
+}
+
+void main (void) {
+  float p_depth = texture(normalDepthTexture, pos * uv_scale).a;
+
+  if (p_depth == 0.0) {
+    frag_color = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  float p_z = view_z(p_depth);
+  vec3 p_view = vec3(screen_ray * -p_z, p_z);
+
+  float noise = random(pos / pixel_size + vec2(pixel_offset));
+  float rotation = noise * 2.0 * PI;
+
+  float occlusion = 0.0;
+  float weight = 0.0;
+
+  for (int i = 0; i < samples; ++i) {
+    // Spherical Fibonacci point, pushed inside the sphere towards p.
+    float t = (float(i) + 0.5) / float(samples);
+    float cos_theta = 1.0 - 2.0 * t;
+    float sin_theta = sqrt(1.0 - cos_theta * cos_theta);
+    float phi = float(i) * GOLDEN_ANGLE + rotation;
+    float scale = fract(t * 7.0 + noise); // Decorrelated from the direction.
+    vec3 s_view = p_view + vec3(cos(phi) * sin_theta, sin(phi) * sin_theta, cos_theta) * radius * mix(0.1, 1.0, scale * scale);
+
+    vec4 s_clip = projection * vec4(s_view, 1.0);
+    vec2 s_texture = (s_clip.xy / s_clip.w) * 0.5 + 0.5;
+    s_texture = clamp(s_texture, pixel_size * 0.5, 1.0 - pixel_size * 0.5); // Clamp to the viewport edge.
+
+    float g_depth = texture(normalDepthTexture, s_texture * uv_scale).a;
+    if (g_depth == 0.0) { // Background never occludes.
+      weight += 1.0;
+      continue;
+    }
+
+    float g_z = view_z(g_depth);
+    float range = clamp(radius / abs(p_z - g_z), 0.0, 1.0); // Range check, distant occluders fade out.
+
+    occlusion += g_z > s_view.z ? range : 0.0;
+    weight += 1.0;
+  }
+
+  occlusion /= max(weight, 1.0);
+
+  float ao = clamp(1.0 - strength * max(2.0 * occlusion - 1.0, 0.0), 0.0, 1.0);
+  frag_color = vec4(ao, ao, ao, 1.0);
+}
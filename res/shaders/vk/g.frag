@@ -0,0 +1,12 @@
+#version 450
+
+layout (location = 0) smooth in vec3 pos_view;
+layout (location = 1) smooth in float depth_view;
+
+layout (location = 0) out vec4 frag_color;
+
+void main (void) {
+  // Clip y is not flipped, so framebuffer y grows with view y as in GL.
+  vec3 normal_view = normalize(cross(dFdx(pos_view), dFdy(pos_view)));
+  frag_color = vec4(normal_view, depth_view);
+}
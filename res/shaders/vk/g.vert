@@ -0,0 +1,25 @@
+#version 450
+
+// g.vert for the Vulkan backend. The projection is the GL one: the G buffer
+// depth is computed as in GL and only the clip z is remapped to the [0, w]
+// range of Vulkan, so the AO shaders read the same values as the GL path.
+
+layout (location = 0) in vec3 vert;
+layout (location = 2) in mat4 instance_model;
+
+layout (push_constant) uniform Matrices {
+  mat4 projection;
+  mat4 view_model;
+};
+
+layout (location = 0) smooth out vec3 pos_view;
+layout (location = 1) smooth out float depth_view;
+
+void main(void) {
+  vec4 p_view = view_model * instance_model * vec4(vert, 1.0);
+  pos_view = p_view.xyz;
+  gl_Position = projection * p_view;
+
+  depth_view = (gl_Position.z / gl_Position.w) * 0.5 + 0.5;
+  gl_Position.z = (gl_Position.z + gl_Position.w) * 0.5;
+}
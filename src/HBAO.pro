@@ -25,17 +25,52 @@ LIBS += -lGLEW
 SOURCES += \
     triangle_mesh.cc \
     mesh_io.cc \
+    mesh_processing.cc \
+    task_scheduler.cc \
     main.cc \
     main_window.cc \
     glwidget.cc \
-    camera.cc
+    camera.cc \
+    camera_path.cc \
+    frame_stats.cc \
+    pass_cache.cc \
+    render_target_pool.cc \
+    layered_target.cc \
+    render_graph.cc \
+    gpu_timer.cc \
+    ao_technique.cc \
+    resolution_controller.cc \
+    scene.cc \
+    mesh_pages.cc \
+    page_streamer.cc \
+    frame_pacer.cc \
+    memory_stats.cc \
+    render_thread.cc
 
 HEADERS  += \
     triangle_mesh.h \
     mesh_io.h \
+    mesh_processing.h \
+    task_scheduler.h \
     main_window.h \
     glwidget.h \
-    camera.h
+    camera.h \
+    camera_path.h \
+    frame_stats.h \
+    pass_cache.h \
+    render_target_pool.h \
+    layered_target.h \
+    render_graph.h \
+    gpu_timer.h \
+    ao_technique.h \
+    resolution_controller.h \
+    scene.h \
+    mesh_pages.h \
+    page_streamer.h \
+    frame_pacer.h \
+    memory_stats.h \
+    render_thread.h \
+    snapshot_mailbox.h
 
 FORMS    += \
     main_window.ui
@@ -43,12 +78,48 @@ FORMS    += \
 DISTFILES += \
     ../res/shaders/g.frag \
     ../res/shaders/g.vert \
+    ../res/shaders/g_layered.vert \
+    ../res/shaders/g_layered.geom \
     ../res/shaders/blur.vert \
     ../res/shaders/blur.frag \
+    ../res/shaders/blur_layered.comp \
     ../res/shaders/hbao.vert \
     ../res/shaders/hbao.frag \
+    ../res/shaders/hbao.comp \
+    ../res/shaders/hbao_fast.frag \
+    ../res/shaders/hbao_gather.frag \
+    ../res/shaders/linear_z.frag \
+    ../res/shaders/gtao.frag \
+    ../res/shaders/ssao_crytek.frag \
+    ../res/shaders/ssao_alchemy.frag \
+    ../res/shaders/ao_classify.frag \
     ../res/shaders/depth.vert \
     ../res/shaders/depth.frag \
     ../res/shaders/normal.vert \
     ../res/shaders/normal.frag
 
+# Optional headless Vulkan backend: qmake CONFIG+=vulkan_backend. Needs the
+# Vulkan loader, and glslangValidator to build the SPIR-V of res/shaders/vk
+# next to its sources.
+vulkan_backend {
+    DEFINES += HBAO_VULKAN
+    LIBS += -lvulkan
+
+    SOURCES += vulkan_backend.cc
+    HEADERS += vulkan_backend.h
+
+    VULKAN_SHADERS = \
+        ../res/shaders/vk/g.vert \
+        ../res/shaders/vk/g.frag \
+        ../res/shaders/vk/hbao.comp \
+        ../res/shaders/vk/blur.comp
+
+    spirv.input = VULKAN_SHADERS
+    spirv.output = ${QMAKE_FILE_IN}.spv
+    spirv.commands = glslangValidator -V ${QMAKE_FILE_IN} -o ${QMAKE_FILE_OUT}
+    spirv.CONFIG += no_link target_predeps
+    QMAKE_EXTRA_COMPILERS += spirv
+
+    DISTFILES += $$VULKAN_SHADERS
+}
+
@@ -0,0 +1,212 @@
+// Author: Marc Comino 2020
+
+#include <ao_technique.h>
+
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace data_visualization {
+
+namespace {
+
+GLint Location(GLuint program, const char *name) {
+  return glGetUniformLocation(program, name);
+}
+
+class Hbao : public AoTechnique {
+ public:
+  std::string Name() const override { return "hbao"; }
+  std::string Label() const override { return "HBAO"; }
+
+  AoShaders Shaders() const override {
+    return {"hbao.vert", "hbao.frag", "", "hbao.comp"};
+  }
+
+  std::vector<AoParameterSpec> Parameters() const override {
+    return {{AoParameter::kDirections, "Directions"},
+            {AoParameter::kSteps, "Steps"},
+            {AoParameter::kRadius, "Radius"},
+            {AoParameter::kBias, "Tangent bias"},
+            {AoParameter::kStrength, "Strength"}};
+  }
+};
+
+class HbaoFast : public Hbao {
+ public:
+  std::string Name() const override { return "hbao_fast"; }
+  std::string Label() const override { return "HBAO (fast math)"; }
+
+  AoShaders Shaders() const override {
+    return {"hbao.vert", "hbao_fast.frag", "", ""};
+  }
+
+  AoResources Resources() const override {
+    AoResources resources;
+    resources.noise = AoNoise::kDirectionTexture;
+    return resources;
+  }
+
+  void SetUniforms(GLuint program, const AoFrame &frame,
+                   const AoParameters &parameters) const override {
+    AoTechnique::SetUniforms(program, frame, parameters);
+
+    const double kStepAngle = (M_PI / 2.0) / std::max(parameters.directions, 1);
+    glUniform2f(Location(program, "step_rotation"),
+                static_cast<GLfloat>(cos(kStepAngle)),
+                static_cast<GLfloat>(sin(kStepAngle)));
+    glUniform2f(Location(program, "sin_cos_bias"), sinf(parameters.t_bias),
+                cosf(parameters.t_bias));
+  }
+};
+
+class HbaoCompute : public Hbao {
+ public:
+  std::string Name() const override { return "hbao_compute"; }
+  std::string Label() const override { return "HBAO (compute)"; }
+
+  AoShaders Shaders() const override {
+    return {"", "", "hbao.comp", "hbao.comp"};
+  }
+
+  AoResources Resources() const override {
+    AoResources resources;
+    resources.compute = true;
+    return resources;
+  }
+};
+
+class HbaoGather : public Hbao {
+ public:
+  std::string Name() const override { return "hbao_gather"; }
+  std::string Label() const override { return "HBAO (depth gather)"; }
+
+  AoShaders Shaders() const override {
+    return {"hbao.vert", "hbao_gather.frag", "", ""};
+  }
+
+  AoResources Resources() const override {
+    AoResources resources;
+    resources.linear_z = true;
+    resources.texture_gather = true;
+    return resources;
+  }
+};
+
+class Gtao : public AoTechnique {
+ public:
+  std::string Name() const override { return "gtao"; }
+  std::string Label() const override { return "GTAO"; }
+
+  AoShaders Shaders() const override {
+    return {"hbao.vert", "gtao.frag", "", ""};
+  }
+
+  std::vector<AoParameterSpec> Parameters() const override {
+    return {{AoParameter::kDirections, "Slices"},
+            {AoParameter::kSteps, "Steps"},
+            {AoParameter::kRadius, "Radius"},
+            {AoParameter::kStrength, "Strength"}};
+  }
+
+  void SetUniforms(GLuint program, const AoFrame &frame,
+                   const AoParameters &parameters) const override {
+    AoTechnique::SetUniforms(program, frame, parameters);
+    glUniform1i(Location(program, "slices"), parameters.directions);
+  }
+
+  int Samples(const AoParameters &parameters) const override {
+    return 2 * parameters.directions * parameters.steps;
+  }
+};
+
+/**
+ * @brief Ssao Point sampling SSAO. Takes as many samples as HBAO with the
+ * same directions and steps, 4 * directions * steps.
+ */
+class Ssao : public AoTechnique {
+ public:
+  Ssao(const std::string &name, const std::string &label,
+       const std::string &fragment)
+      : name_(name), label_(label), fragment_(fragment) {}
+
+  std::string Name() const override { return name_; }
+  std::string Label() const override { return label_; }
+
+  AoShaders Shaders() const override { return {"hbao.vert", fragment_, "", ""}; }
+
+  std::vector<AoParameterSpec> Parameters() const override {
+    return {{AoParameter::kDirections, "Directions"},
+            {AoParameter::kSteps, "Samples per direction"},
+            {AoParameter::kRadius, "Radius"},
+            {AoParameter::kStrength, "Strength"}};
+  }
+
+  void SetUniforms(GLuint program, const AoFrame &frame,
+                   const AoParameters &parameters) const override {
+    AoTechnique::SetUniforms(program, frame, parameters);
+    glUniform1i(Location(program, "samples"),
+                4 * parameters.directions * parameters.steps);
+  }
+
+ private:
+  std::string name_;
+  std::string label_;
+  std::string fragment_;
+};
+
+}  // namespace
+
+void AoTechnique::SetUniforms(GLuint program, const AoFrame &frame,
+                              const AoParameters &parameters) const {
+  glUniformMatrix4fv(Location(program, "projection"), 1, GL_FALSE,
+                     frame.projection.data());
+  glUniform1f(Location(program, "aspect_ratio"), frame.aspect_ratio);
+  glUniform1f(Location(program, "tan_half_fov"), frame.tan_half_fov);
+  glUniform2f(Location(program, "ray_center"), frame.ray_center[0],
+              frame.ray_center[1]);
+  glUniform2f(Location(program, "pixel_size"), frame.pixel_size[0],
+              frame.pixel_size[1]);
+  glUniform2i(Location(program, "pixel_offset"), frame.pixel_offset[0],
+              frame.pixel_offset[1]);
+  glUniform2f(Location(program, "uv_scale"), frame.uv_scale[0],
+              frame.uv_scale[1]);
+  glUniform2i(Location(program, "viewport_size"), frame.viewport_width,
+              frame.viewport_height);
+
+  glUniform1i(Location(program, "directions"), parameters.directions);
+  glUniform1i(Location(program, "steps"), parameters.steps);
+  glUniform1f(Location(program, "radius"), parameters.radius);
+  glUniform1f(Location(program, "t_bias"), parameters.t_bias);
+  glUniform1f(Location(program, "strength"), parameters.strength);
+}
+
+void AoTechniqueRegistry::Register(std::unique_ptr<AoTechnique> technique) {
+  assert(Find(technique->Name()) == -1);
+  techniques_.push_back(std::move(technique));
+}
+
+int AoTechniqueRegistry::Find(const std::string &name) const {
+  for (size_t i = 0; i < techniques_.size(); ++i)
+    if (techniques_[i]->Name() == name) return static_cast<int>(i);
+  return -1;
+}
+
+void RegisterBuiltInAoTechniques(AoTechniqueRegistry *registry) {
+  registry->Register(std::unique_ptr<AoTechnique>(new Hbao()));
+  registry->Register(std::unique_ptr<AoTechnique>(new HbaoFast()));
+  registry->Register(std::unique_ptr<AoTechnique>(new HbaoCompute()));
+  registry->Register(std::unique_ptr<AoTechnique>(new HbaoGather()));
+  registry->Register(std::unique_ptr<AoTechnique>(new Gtao()));
+  registry->Register(std::unique_ptr<AoTechnique>(
+      new Ssao("ssao_crytek", "SSAO (Crytek)", "ssao_crytek.frag")));
+  registry->Register(std::unique_ptr<AoTechnique>(
+      new Ssao("ssao_alchemy", "SSAO (Alchemy)", "ssao_alchemy.frag")));
+}
+
+}  //  namespace data_visualization
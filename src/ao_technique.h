@@ -0,0 +1,193 @@
+// Author: Marc Comino 2020
+
+#ifndef AO_TECHNIQUE_H_
+#define AO_TECHNIQUE_H_
+
+#include <GL/glew.h>
+
+#include <eigen3/Eigen/Geometry>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace data_visualization {
+
+/**
+ * @brief AoParameter Parameters shown in the Render group. A technique lists
+ * the ones it uses, with its own label for each.
+ */
+enum class AoParameter { kDirections, kSteps, kRadius, kBias, kStrength };
+
+/**
+ * @brief AoParameterSpec A parameter used by a technique and its UI label.
+ */
+struct AoParameterSpec {
+  AoParameter parameter;
+  std::string label;
+};
+
+/**
+ * @brief AoParameters Values of the Render group parameters.
+ */
+struct AoParameters {
+  int directions;
+  int steps;
+  float radius;
+  float t_bias;  // Radians.
+  float strength;
+};
+
+/**
+ * @brief AoFrame Per frame values shared by every technique.
+ */
+struct AoFrame {
+  Eigen::Matrix4f projection;
+  float aspect_ratio;
+  float tan_half_fov;
+
+  /**
+   * @brief ray_center View ray through the viewport center at unit distance.
+   * Zero unless the projection is off-axis, as for the tiles of a tiled
+   * render.
+   */
+  float ray_center[2];
+
+  float pixel_size[2];
+
+  /**
+   * @brief pixel_offset Origin of the viewport in the whole image, in pixels.
+   * The noise is indexed by image pixel, so that it does not change at the
+   * seams of a tiled render.
+   */
+  int pixel_offset[2];
+
+  float uv_scale[2];
+  int viewport_width;
+  int viewport_height;
+};
+
+/**
+ * @brief AoNoise Texture bound to unit 1.
+ */
+enum class AoNoise {
+  kNone,
+  kNoiseTexture,      // "noise_texture", one random value per texel.
+  kDirectionTexture,  // "direction_texture", cos, sin and jitter per texel.
+};
+
+/**
+ * @brief AoResources What a technique needs besides the G buffer, which is
+ * always bound to unit 0 as "normalDepthTexture".
+ */
+struct AoResources {
+  AoNoise noise = AoNoise::kNoiseTexture;
+
+  /**
+   * @brief compute Whether the technique is a compute shader writing the AO
+   * to image unit 0, "ao_image", in 16x16 workgroups.
+   */
+  bool compute = false;
+
+  /**
+   * @brief linear_z Whether the technique samples "linear_z_texture", the view
+   * space z of the G buffer in a single channel, bound to unit 2.
+   */
+  bool linear_z = false;
+
+  /**
+   * @brief texture_gather Whether the shaders need textureGather, from
+   * OpenGL 4.0 or ARB_texture_gather. Without it the technique is skipped.
+   */
+  bool texture_gather = false;
+};
+
+/**
+ * @brief AoShaders Shader files of a technique, relative to the shader
+ * directory. Either a vertex and fragment pair or a compute shader.
+ */
+struct AoShaders {
+  std::string vertex;
+  std::string fragment;
+  std::string compute;
+
+  /**
+   * @brief fused_blur Optional compute shader that renders the AO and one
+   * blur iteration in a single dispatch of 32x32 pixel tiles, writing to
+   * "ao_image". It is compiled with FUSED_BLUR defined.
+   */
+  std::string fused_blur;
+};
+
+/**
+ * @brief AoTechnique An ambient occlusion algorithm rendered by the AO pass.
+ */
+class AoTechnique {
+ public:
+  virtual ~AoTechnique() {}
+
+  /**
+   * @brief Name Short identifier, used as the name of the AO pass.
+   */
+  virtual std::string Name() const = 0;
+
+  /**
+   * @brief Label Name shown in the UI.
+   */
+  virtual std::string Label() const = 0;
+
+  virtual AoShaders Shaders() const = 0;
+
+  virtual std::vector<AoParameterSpec> Parameters() const = 0;
+
+  virtual AoResources Resources() const { return AoResources(); }
+
+  /**
+   * @brief Samples Depth samples taken per pixel, for the adaptive sampling
+   * statistics. The default is the 4 * directions * steps of HBAO.
+   */
+  virtual int Samples(const AoParameters &parameters) const {
+    return 4 * parameters.directions * parameters.steps;
+  }
+
+  /**
+   * @brief SetUniforms Sets the uniforms of the bound program. The default
+   * sets the common ones, missing uniforms are ignored by GL.
+   * @param program The technique program.
+   * @param frame Per frame values.
+   * @param parameters Render group values.
+   */
+  virtual void SetUniforms(GLuint program, const AoFrame &frame,
+                           const AoParameters &parameters) const;
+};
+
+/**
+ * @brief AoTechniqueRegistry The techniques selectable in the UI, in order.
+ */
+class AoTechniqueRegistry {
+ public:
+  void Register(std::unique_ptr<AoTechnique> technique);
+
+  size_t Size() const { return techniques_.size(); }
+
+  const AoTechnique &Get(size_t i) const { return *techniques_[i]; }
+
+  /**
+   * @brief Find Index of a technique.
+   * @param name Technique name.
+   * @return The index, or -1 if it is not registered.
+   */
+  int Find(const std::string &name) const;
+
+ private:
+  std::vector<std::unique_ptr<AoTechnique>> techniques_;
+};
+
+/**
+ * @brief RegisterBuiltInAoTechniques Registers HBAO and its fast, compute and
+ * depth gather variants, GTAO, and Crytek and Alchemy style SSAO.
+ */
+void RegisterBuiltInAoTechniques(AoTechniqueRegistry *registry);
+
+}  //  namespace data_visualization
+
+#endif  //  AO_TECHNIQUE_H_
@@ -197,4 +197,24 @@ void Camera::StopPanning(double x, double y) {
 
 void Camera::SetCameraStep(double step) { this->step_ = step; }
 
+CameraState Camera::GetState() const {
+  CameraState state;
+  state.distance = distance_;
+  state.rotation_x = rotation_x_;
+  state.rotation_y = rotation_y_;
+  state.pan_x = pan_x_;
+  state.pan_y = pan_y_;
+  state.viewport_width = viewport_width_;
+  state.viewport_height = viewport_height_;
+  return state;
+}
+
+void Camera::SetState(const CameraState &state) {
+  distance_ = state.distance;
+  rotation_x_ = state.rotation_x;
+  rotation_y_ = state.rotation_y;
+  pan_x_ = state.pan_x;
+  pan_y_ = state.pan_y;
+}
+
 }  //  namespace data_visualization
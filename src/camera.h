@@ -15,6 +15,20 @@ const double MaxRotationX = M_PI / 2;
 
 const double AngleIncrement = 0.01;
 
+/**
+ * @brief CameraState Snapshot of the user controlled camera parameters. It is
+ * what gets recorded and replayed by a CameraPath.
+ */
+struct CameraState {
+  double distance;
+  double rotation_x;
+  double rotation_y;
+  double pan_x;
+  double pan_y;
+  int viewport_width;
+  int viewport_height;
+};
+
 class Camera {
  private:
   /**
@@ -302,6 +316,19 @@ class Camera {
    * @param step New camera step.
    */
   void SetCameraStep(double step);
+
+  /**
+   * @brief GetState Returns the current rotation, zoom, pan and viewport.
+   * @return A snapshot of the camera.
+   */
+  CameraState GetState() const;
+
+  /**
+   * @brief SetState Restores the rotation, zoom and pan of a snapshot. The
+   * viewport is owned by the widget and is left untouched.
+   * @param state Snapshot to restore.
+   */
+  void SetState(const CameraState &state);
 };
 
 }  //  namespace data_visualization
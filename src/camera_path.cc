@@ -0,0 +1,122 @@
+// Author: Marc Comino 2020
+
+#include <camera_path.h>
+
+#include <assert.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace data_visualization {
+
+namespace {
+
+const char kHeader[] = "camera_path";
+const int kVersion = 1;
+
+/**
+ * @brief kMinKeyframeBytes Shortest text of a keyframe: eight values of at
+ * least one digit and a separator each.
+ */
+const std::streamoff kMinKeyframeBytes = 16;
+
+double Lerp(double a, double b, double t) { return a + (b - a) * t; }
+
+}  //  namespace
+
+void CameraPath::Clear() { keyframes_.clear(); }
+
+void CameraPath::AddKeyframe(double time, const CameraState &state) {
+  if (!keyframes_.empty() && time < keyframes_.back().time)
+    time = keyframes_.back().time;
+
+  keyframes_.push_back({time, state});
+}
+
+bool CameraPath::Empty() const { return keyframes_.empty(); }
+
+double CameraPath::Duration() const {
+  return keyframes_.empty() ? 0.0 : keyframes_.back().time;
+}
+
+CameraState CameraPath::Sample(double time) const {
+  assert(!keyframes_.empty());
+
+  if (time <= keyframes_.front().time) return keyframes_.front().state;
+  if (time >= keyframes_.back().time) return keyframes_.back().state;
+
+  auto next = std::upper_bound(
+      keyframes_.begin(), keyframes_.end(), time,
+      [](double t, const Keyframe &keyframe) { return t < keyframe.time; });
+  auto prev = next - 1;
+
+  const double kSpan = next->time - prev->time;
+  const double kT = kSpan > 0.0 ? (time - prev->time) / kSpan : 0.0;
+
+  CameraState state = prev->state;
+  state.distance = Lerp(prev->state.distance, next->state.distance, kT);
+  state.rotation_x = Lerp(prev->state.rotation_x, next->state.rotation_x, kT);
+  state.rotation_y = Lerp(prev->state.rotation_y, next->state.rotation_y, kT);
+  state.pan_x = Lerp(prev->state.pan_x, next->state.pan_x, kT);
+  state.pan_y = Lerp(prev->state.pan_y, next->state.pan_y, kT);
+
+  return state;
+}
+
+bool CameraPath::Save(const std::string &filename) const {
+  std::ofstream fout(filename.c_str());
+  if (!fout.is_open() || !fout.good()) return false;
+
+  fout.precision(17);
+  fout << kHeader << " " << kVersion << " " << keyframes_.size() << std::endl;
+  for (const Keyframe &keyframe : keyframes_) {
+    const CameraState &s = keyframe.state;
+    fout << keyframe.time << " " << s.distance << " " << s.rotation_x << " "
+         << s.rotation_y << " " << s.pan_x << " " << s.pan_y << " "
+         << s.viewport_width << " " << s.viewport_height << std::endl;
+  }
+
+  return fout.good();
+}
+
+bool CameraPath::Load(const std::string &filename) {
+  std::ifstream fin(filename.c_str());
+  if (!fin.is_open() || !fin.good()) return false;
+
+  std::string header;
+  int version = 0;
+  size_t count = 0;
+  fin >> header >> version >> count;
+  if (fin.fail() || header != kHeader || version != kVersion) {
+    std::cerr << "Error " + filename + " is not a camera path." << std::endl;
+    return false;
+  }
+
+  // The count comes from the file, it must fit in the rest of it before the
+  // keyframes are allocated.
+  const std::streamoff kPosition = fin.tellg();
+  fin.seekg(0, std::ios_base::end);
+  const std::streamoff kRemaining = fin.tellg() - kPosition;
+  fin.seekg(kPosition);
+  if (kRemaining < 0 || count > static_cast<size_t>(kRemaining / kMinKeyframeBytes)) {
+    std::cerr << "Error " + filename + " is truncated." << std::endl;
+    return false;
+  }
+
+  std::vector<Keyframe> keyframes(count);
+  for (Keyframe &keyframe : keyframes) {
+    CameraState &s = keyframe.state;
+    fin >> keyframe.time >> s.distance >> s.rotation_x >> s.rotation_y >>
+        s.pan_x >> s.pan_y >> s.viewport_width >> s.viewport_height;
+  }
+
+  if (fin.fail()) return false;
+
+  keyframes_.swap(keyframes);
+  return true;
+}
+
+}  //  namespace data_visualization
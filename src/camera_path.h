@@ -0,0 +1,72 @@
+// Author: Marc Comino 2020
+
+#ifndef CAMERA_PATH_H_
+#define CAMERA_PATH_H_
+
+#include <string>
+#include <vector>
+
+#include "./camera.h"
+
+namespace data_visualization {
+
+class CameraPath {
+ public:
+  /**
+   * @brief Clear Removes all the keyframes.
+   */
+  void Clear();
+
+  /**
+   * @brief AddKeyframe Appends a camera snapshot. Keyframes must be added in
+   * increasing time order.
+   * @param time Time of the snapshot in seconds since the path start.
+   * @param state Camera snapshot.
+   */
+  void AddKeyframe(double time, const CameraState &state);
+
+  /**
+   * @brief Empty Whether the path has no keyframes.
+   */
+  bool Empty() const;
+
+  /**
+   * @brief Duration Time of the last keyframe in seconds.
+   */
+  double Duration() const;
+
+  /**
+   * @brief Sample Linearly interpolates the path at the given time. Times out
+   * of range are clamped to the first and last keyframes. The path must not
+   * be empty.
+   * @param time Time in seconds since the path start.
+   * @return The interpolated camera snapshot.
+   */
+  CameraState Sample(double time) const;
+
+  /**
+   * @brief Save Stores the path as text at the path filename.
+   * @param filename Destination file.
+   * @return Whether it was able to store the file.
+   */
+  bool Save(const std::string &filename) const;
+
+  /**
+   * @brief Load Reads a path previously stored with Save.
+   * @param filename Source file.
+   * @return Whether it was able to read the file.
+   */
+  bool Load(const std::string &filename);
+
+ private:
+  struct Keyframe {
+    double time;
+    CameraState state;
+  };
+
+  std::vector<Keyframe> keyframes_;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  CAMERA_PATH_H_
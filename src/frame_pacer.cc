@@ -0,0 +1,60 @@
+// Author: Marc Comino 2020
+
+#include <frame_pacer.h>
+
+#include <chrono>
+
+namespace data_visualization {
+
+namespace {
+
+/**
+ * @brief kFenceTimeout Nanoseconds waited for a fence before giving up on it,
+ * so that a lost context does not hang the render thread.
+ */
+const GLuint64 kFenceTimeout = 1000000000;
+
+}  //  namespace
+
+FramePacer::FramePacer(size_t frames_in_flight)
+    : frames_in_flight_(frames_in_flight) {}
+
+void FramePacer::EndFrame() {
+  fences_.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  ++frames_;
+
+  while (fences_.size() > frames_in_flight_) {
+    GLsync fence = fences_.front();
+    fences_.pop_front();
+
+    const auto kStart = std::chrono::steady_clock::now();
+    const GLenum kResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout);
+    glDeleteSync(fence);
+
+    if (kResult != GL_ALREADY_SIGNALED) {
+      ++waits_;
+      wait_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+    }
+  }
+}
+
+void FramePacer::Release() {
+  for (GLsync fence : fences_) glDeleteSync(fence);
+  fences_.clear();
+}
+
+void FramePacer::Print(std::ostream *out) const {
+  *out << "Frame pacing" << std::endl;
+  *out << "\tFrames in flight = " << frames_in_flight_ << std::endl;
+  *out << "\tFrames = " << frames_ << ", waited on " << waits_ << std::endl;
+  *out << "\tWait = " << (frames_ > 0 ? wait_ms_ / frames_ : 0.0)
+       << " ms per frame" << std::endl;
+}
+
+void FramePacer::Clear() {
+  frames_ = 0;
+  waits_ = 0;
+  wait_ms_ = 0.0;
+}
+
+}  //  namespace data_visualization
@@ -0,0 +1,60 @@
+// Author: Marc Comino 2020
+
+#ifndef FRAME_PACER_H_
+#define FRAME_PACER_H_
+
+#include <GL/glew.h>
+
+#include <deque>
+#include <ostream>
+
+namespace data_visualization {
+
+/**
+ * @brief FramePacer Bounds the number of frames the CPU submits ahead of the
+ * GPU. A fence follows every frame, and once there are more frames in flight
+ * than allowed the CPU waits for the oldest one.
+ */
+class FramePacer {
+ public:
+  /**
+   * @brief FramePacer Constructor of the class.
+   * @param frames_in_flight Frames the GPU may be behind at most.
+   */
+  explicit FramePacer(size_t frames_in_flight = 2);
+
+  /**
+   * @brief EndFrame Fences the submitted frame and waits while there are too
+   * many frames in flight. Requires a current GL context.
+   */
+  void EndFrame();
+
+  /**
+   * @brief Release Deletes the pending fences without waiting. Requires a
+   * current GL context.
+   */
+  void Release();
+
+  /**
+   * @brief Print Writes the time spent waiting for the GPU.
+   * @param out Output stream.
+   */
+  void Print(std::ostream *out) const;
+
+  /**
+   * @brief Clear Forgets the accumulated waits.
+   */
+  void Clear();
+
+ private:
+  size_t frames_in_flight_;
+  std::deque<GLsync> fences_;
+
+  size_t frames_ = 0;
+  size_t waits_ = 0;
+  double wait_ms_ = 0.0;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  FRAME_PACER_H_
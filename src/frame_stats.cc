@@ -0,0 +1,96 @@
+// Author: Marc Comino 2020
+
+#include <frame_stats.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace data_visualization {
+
+namespace {
+
+const int kHistogramBins = 16;
+const int kHistogramWidth = 40;
+
+}  //  namespace
+
+void FrameStats::Clear() { frames_.clear(); }
+
+void FrameStats::AddFrame(double ms) { frames_.push_back(ms); }
+
+size_t FrameStats::Frames() const { return frames_.size(); }
+
+double FrameStats::Mean() const {
+  if (frames_.empty()) return 0.0;
+  return std::accumulate(frames_.begin(), frames_.end(), 0.0) /
+         static_cast<double>(frames_.size());
+}
+
+double FrameStats::Percentile(double p) const {
+  if (frames_.empty()) return 0.0;
+
+  std::vector<double> sorted(frames_);
+  std::sort(sorted.begin(), sorted.end());
+
+  size_t idx = static_cast<size_t>(
+      std::round(p / 100.0 * static_cast<double>(sorted.size() - 1)));
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+size_t FrameStats::Stutters() const {
+  const double kThreshold = Percentile(50.0) * kStutterFactor;
+  return static_cast<size_t>(
+      std::count_if(frames_.begin(), frames_.end(),
+                    [kThreshold](double ms) { return ms > kThreshold; }));
+}
+
+void FrameStats::Print(const std::string &title, std::ostream *out) const {
+  *out << title << std::endl;
+  if (frames_.empty()) {
+    *out << "\tNo frames" << std::endl;
+    return;
+  }
+
+  const double kMin = *std::min_element(frames_.begin(), frames_.end());
+  const double kMax = *std::max_element(frames_.begin(), frames_.end());
+
+  const std::ios_base::fmtflags kFlags = out->flags();
+  const std::streamsize kPrecision = out->precision();
+
+  *out << std::fixed << std::setprecision(3);
+  *out << "\tFrames = " << frames_.size() << std::endl;
+  *out << "\tMean = " << Mean() << " ms" << std::endl;
+  *out << "\tMin = " << kMin << " ms" << std::endl;
+  *out << "\tP50 = " << Percentile(50.0) << " ms" << std::endl;
+  *out << "\tP95 = " << Percentile(95.0) << " ms" << std::endl;
+  *out << "\tP99 = " << Percentile(99.0) << " ms" << std::endl;
+  *out << "\tMax = " << kMax << " ms" << std::endl;
+  *out << "\tStutters (> " << kStutterFactor << "x median) = " << Stutters()
+       << std::endl;
+
+  std::vector<size_t> bins(kHistogramBins, 0);
+  const double kBinWidth = std::max((kMax - kMin) / kHistogramBins, 1e-6);
+  for (double ms : frames_) {
+    int bin = static_cast<int>((ms - kMin) / kBinWidth);
+    ++bins[static_cast<size_t>(std::min(bin, kHistogramBins - 1))];
+  }
+
+  const size_t kPeak = *std::max_element(bins.begin(), bins.end());
+  for (int i = 0; i < kHistogramBins; ++i) {
+    size_t count = bins[static_cast<size_t>(i)];
+    size_t bar = count * kHistogramWidth / kPeak;
+    *out << "\t[" << std::setw(9) << kMin + kBinWidth * i << ", "
+         << std::setw(9) << kMin + kBinWidth * (i + 1) << ") "
+         << std::setw(6) << count << " " << std::string(bar, '#')
+         << std::endl;
+  }
+
+  out->flags(kFlags);
+  out->precision(kPrecision);
+}
+
+}  //  namespace data_visualization
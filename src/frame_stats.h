@@ -0,0 +1,67 @@
+// Author: Marc Comino 2020
+
+#ifndef FRAME_STATS_H_
+#define FRAME_STATS_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace data_visualization {
+
+/**
+ * @brief kStutterFactor A frame is a stutter when it takes longer than this
+ * factor times the median frame.
+ */
+const double kStutterFactor = 2.0;
+
+class FrameStats {
+ public:
+  /**
+   * @brief Clear Removes all the recorded frames.
+   */
+  void Clear();
+
+  /**
+   * @brief AddFrame Records the duration of a frame.
+   * @param ms Frame duration in milliseconds.
+   */
+  void AddFrame(double ms);
+
+  /**
+   * @brief Frames Number of recorded frames.
+   */
+  size_t Frames() const;
+
+  /**
+   * @brief Mean Mean frame duration in milliseconds.
+   */
+  double Mean() const;
+
+  /**
+   * @brief Percentile Frame duration at the given percentile.
+   * @param p Percentile in [0, 100].
+   * @return Duration in milliseconds.
+   */
+  double Percentile(double p) const;
+
+  /**
+   * @brief Stutters Number of frames longer than kStutterFactor times the
+   * median.
+   */
+  size_t Stutters() const;
+
+  /**
+   * @brief Print Writes a summary and a histogram of the frame durations.
+   * @param title Name of the measured quantity.
+   * @param out Output stream.
+   */
+  void Print(const std::string &title, std::ostream *out) const;
+
+ private:
+  std::vector<double> frames_;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  FRAME_STATS_H_
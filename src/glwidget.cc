@@ -1,12 +1,20 @@
 #include <glwidget.h>
 
+#include <QPaintEvent>
+#include <QResizeEvent>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <limits>
+#include <vector>
 
 #include "./mesh_io.h"
+#include "./scene.h"
 #include "./triangle_mesh.h"
 
 namespace {
@@ -21,8 +29,20 @@ const char g_frag_file[] = "../../res/shaders/g.frag";
 const char blur_vert_file[] = "../../res/shaders/blur.vert";
 const char blur_frag_file[] = "../../res/shaders/blur.frag";
 
-const char hbao_vert_file[] = "../../res/shaders/hbao.vert";
-const char hbao_frag_file[] = "../../res/shaders/hbao.frag";
+const char g_layered_vert_file[] = "../../res/shaders/g_layered.vert";
+const char g_layered_geom_file[] = "../../res/shaders/g_layered.geom";
+const char hbao_layered_comp_file[] = "../../res/shaders/hbao.comp";
+const char blur_layered_comp_file[] = "../../res/shaders/blur_layered.comp";
+
+const char ao_shader_dir[] = "../../res/shaders/";
+
+const char noise_file[] = "../../res/textures/noise.png";
+
+const char classify_vert_file[] = "../../res/shaders/blur.vert";
+const char classify_frag_file[] = "../../res/shaders/ao_classify.frag";
+
+const char linear_z_vert_file[] = "../../res/shaders/blur.vert";
+const char linear_z_frag_file[] = "../../res/shaders/linear_z.frag";
 
 const char depth_vert_file[] = "../../res/shaders/depth.vert";
 const char depth_frag_file[] = "../../res/shaders/depth.frag";
@@ -30,6 +50,129 @@ const char depth_frag_file[] = "../../res/shaders/depth.frag";
 const char normal_vert_file[] = "../../res/shaders/normal.vert";
 const char normal_frag_file[] = "../../res/shaders/nromal.frag";
 
+const double kBenchmarkTimestep = 1.0 / 60.0;
+const int kBenchmarkWarmupFrames = 10;
+
+const int kResizeSettleMs = 250;
+
+/**
+ * @brief kUiTimerMs Interval of the GUI thread timer that measures its
+ * responsiveness.
+ */
+const int kUiTimerMs = 10;
+
+/**
+ * @brief kStreamingBudget GPU memory of the page pool of out of core meshes.
+ */
+const size_t kStreamingBudget = 256 * 1024 * 1024;
+
+const float kBenchmarkRadii[] = {0.1f, 0.2f, 0.4f, 0.8f, 1.6f};
+const int kRadiusBenchmarkFrames = 60;
+
+const GLuint kComputeTile = 16;
+
+/**
+ * @brief kFusedBlurTile Output tile side of the fused AO and blur shaders.
+ */
+const GLuint kFusedBlurTile = 32;
+
+const int kComparisonFrames = 60;
+
+/**
+ * @brief kViewSeparation Distance between neighbouring views of a multi-view
+ * frame, in view space units.
+ */
+const float kViewSeparation = 0.1f;
+
+#ifdef HBAO_VULKAN
+/**
+ * @brief vulkan_shader_dir SPIR-V of the Vulkan backend, built by qmake.
+ */
+const char vulkan_shader_dir[] = "../../res/shaders/vk/";
+
+/**
+ * @brief kVulkanComparisonFrames Frames of the current view rendered by the
+ * Vulkan comparison when there is no camera path.
+ */
+const int kVulkanComparisonFrames = 300;
+
+/**
+ * @brief LoadNoiseValues Reads the noise texture as values in [0, 1] for the
+ * Vulkan backend.
+ */
+bool LoadNoiseValues(const std::string &path, std::vector<float> *values, int *side) {
+  QImage image;
+  if (!image.load(path.c_str()) || image.width() != image.height()) return false;
+
+  *side = image.width();
+  values->resize(static_cast<size_t>(*side) * *side);
+  for (int y = 0; y < *side; ++y)
+    for (int x = 0; x < *side; ++x)
+      (*values)[y * *side + x] = qGray(image.pixel(x, y)) / 255.0f;
+  return true;
+}
+#endif
+
+/**
+ * @brief kReferenceQuality Factor applied to the directions and steps of the
+ * HBAO used as reference by the technique benchmark.
+ */
+const int kReferenceQuality = 4;
+
+/**
+ * @brief kStencilGeometry Stencil bit set by the G pass where there is
+ * geometry. The AO is only shaded there.
+ */
+const GLint kStencilGeometry = 0x1;
+
+/**
+ * @brief kStencilRefine Stencil bit of the tiles refined by the adaptive AO.
+ */
+const GLint kStencilRefine = 0x2;
+
+/**
+ * @brief kAdaptiveTile Side in pixels of the tiles classified by the adaptive
+ * AO.
+ */
+const int kAdaptiveTile = 8;
+
+/**
+ * @brief kAdaptiveVariance Coarse AO variance above which a tile is refined.
+ */
+const float kAdaptiveVariance = 0.002f;
+
+/**
+ * @brief kRenderTile Output tile side of the tiled render.
+ */
+const int kRenderTile = 1024;
+
+/**
+ * @brief kMaxGuardBand Bounds the tile overdraw of very large AO radii.
+ */
+const int kMaxGuardBand = 512;
+
+/**
+ * @brief kBlurRadius Kernel radius of blur.frag.
+ */
+const int kBlurRadius = 4;
+
+/**
+ * @brief kAdaptiveDepth Relative view depth range above which a tile is
+ * refined.
+ */
+const float kAdaptiveDepth = 0.05f;
+
+/**
+ * @brief CoarseAoParameters The cheap parameters of the adaptive AO first
+ * pass: one direction per quadrant and half the steps.
+ */
+data_visualization::AoParameters CoarseAoParameters(
+    data_visualization::AoParameters parameters) {
+  parameters.directions = 1;
+  parameters.steps = std::max(1, parameters.steps / 2);
+  return parameters;
+}
+
 const int kVertexAttributeIdx = 0;
 const int kNormalAttributeIdx = 1;
 
@@ -75,6 +218,36 @@ bool LoadProgram(const std::string &vertex, const std::string &fragment, QOpenGL
   return res;
 }
 
+bool LoadProgram(const std::string &vertex, const std::string &geometry, const std::string &fragment,
+                 QOpenGLShaderProgram &program) {
+  std::string geometry_shader;
+  if (!ReadFile(geometry, &geometry_shader)) return false;
+
+  program.addShaderFromSourceCode(QOpenGLShader::Geometry, geometry_shader.c_str());
+  std::cout << program.log().toUtf8().constData();
+  return LoadProgram(vertex, fragment, program) && program.isLinked();
+}
+
+/**
+ * @brief LoadComputeProgram Compiles and links a compute shader.
+ * @param defines Lines inserted after the #version line, to select variants
+ * of the shader.
+ */
+bool LoadComputeProgram(const std::string &compute, QOpenGLShaderProgram &program,
+                        const std::string &defines = "") {
+  std::string compute_shader;
+  bool res = ReadFile(compute, &compute_shader);
+
+  if (res) {
+    if (!defines.empty()) compute_shader.insert(compute_shader.find('\n') + 1, defines);
+    program.addShaderFromSourceCode(QOpenGLShader::Compute, compute_shader.c_str());
+    std::cout << program.log().toUtf8().constData();
+    res = program.link();
+  }
+
+  return res;
+}
+
 bool load_noise_image(const std::string &path) {
   QImage image;
   bool res = image.load(path.c_str());
@@ -85,47 +258,191 @@ bool load_noise_image(const std::string &path) {
   return res;
 }
 
+/**
+ * @brief load_direction_image Precomputes, per noise texel, the cosine and sine
+ * of the HBAO starting angle and a step jitter taken from a decorrelated
+ * texel of the same noise.
+ */
+bool load_direction_image(const std::string &path) {
+  QImage image;
+  bool res = image.load(path.c_str());
+  if (res) {
+    const int kWidth = image.width();
+    const int kHeight = image.height();
+
+    std::vector<GLfloat> texels;
+    texels.reserve(3 * kWidth * kHeight);
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) {
+        const double kAngle = image.pixelColor(x, y).redF() * (M_PI / 2.0);
+        const double kJitter = image.pixelColor((x + kWidth / 2) % kWidth, (y + kHeight / 2) % kHeight).redF();
+        texels.push_back(static_cast<GLfloat>(cos(kAngle)));
+        texels.push_back(static_cast<GLfloat>(sin(kAngle)));
+        texels.push_back(static_cast<GLfloat>(kJitter));
+      }
+    }
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, kWidth, kHeight, 0, GL_RGB, GL_FLOAT, texels.data());
+  }
+  return res;
+}
+
+/**
+ * @brief TextureBytes GPU memory of the first level of a 2D texture.
+ */
+size_t TextureBytes(GLuint texture, size_t texel_bytes) {
+  GLint width = 0, height = 0;
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return static_cast<size_t>(width) * static_cast<size_t>(height) * texel_bytes;
+}
+
+/**
+ * @brief MeshBytes CPU memory of the arrays of a mesh.
+ */
+size_t MeshBytes(const data_representation::TriangleMesh &mesh) {
+  return (mesh.vertices_.capacity() + mesh.normals_.capacity()) * sizeof(float) +
+         mesh.faces_.capacity() * sizeof(int);
+}
+
+/**
+ * @brief ReadAo Reads back the AO of the viewport from the red channel.
+ */
+std::vector<GLfloat> ReadAo(GLuint fbo, GLsizei width, GLsizei height) {
+  std::vector<GLfloat> ao(static_cast<size_t>(width) * height);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, ao.data());
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  return ao;
+}
+
+/**
+ * @brief CopyStencil Copies the stencil of the viewport between two targets of
+ * the same size bucket.
+ */
+void CopyStencil(GLuint src_fbo, GLuint dst_fbo, GLint width, GLint height) {
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, src_fbo);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst_fbo);
+  glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+}
+
+/**
+ * @brief SynchronousRendering Stops the render thread for the scope of a GL
+ * operation of the GUI thread, such as loading a model or a benchmark, and
+ * restarts it afterwards. The GL context can only be current on one thread.
+ */
+class SynchronousRendering {
+ public:
+  explicit SynchronousRendering(GLWidget *widget)
+      : widget_(widget), threaded_(widget->threaded_rendering()) {
+    if (threaded_) widget_->SetThreadedRendering(false);
+  }
+
+  ~SynchronousRendering() {
+    if (threaded_) widget_->SetThreadedRendering(true);
+  }
+
+  SynchronousRendering(const SynchronousRendering &) = delete;
+  SynchronousRendering &operator=(const SynchronousRendering &) = delete;
+
+ private:
+  GLWidget *widget_;
+  bool threaded_;
+};
+
 }  // namespace
 
 GLWidget::GLWidget(QWidget *parent)
     : QGLWidget(parent), initialized_(false), width_(0.0), height_(0.0) {
   setFocusPolicy(Qt::StrongFocus);
+  data_visualization::RegisterBuiltInAoTechniques(&ao_techniques_);
+  input_timer_.start();
+
+  resize_timer_.setSingleShot(true);
+  resize_timer_.setInterval(kResizeSettleMs);
+  connect(&resize_timer_, &QTimer::timeout, this,
+          &GLWidget::SettleRenderTargets);
+
+  gui_state_.ao_program = ao_program_;
+  gui_state_.ao_technique = ao_technique_;
+  gui_state_.adaptive_ao = adaptive_ao_;
+  gui_state_.blur = blur_;
+  gui_state_.directions = hbao_directions;
+  gui_state_.steps = hbao_steps;
+  gui_state_.radius = hbao_radius;
+  gui_state_.t_bias = hbao_t_bias;
+  gui_state_.strength = hbao_strength;
+
+  ui_timer_.setInterval(kUiTimerMs);
+  connect(&ui_timer_, &QTimer::timeout, this, &GLWidget::MeasureResponsiveness);
+  ui_clock_.start();
+  ui_timer_.start();
 }
 
 GLWidget::~GLWidget() {
+  SetThreadedRendering(false);
+
   delete g_program_;
   delete blur_program_;
-  delete hbao_program_;
+  for (QOpenGLShaderProgram *program : ao_programs_) delete program;
+  for (QOpenGLShaderProgram *program : fused_programs_) delete program;
+  delete classify_program_;
+  delete linear_z_program_;
   delete depth_program_;
   delete normal_program_;
+  delete g_layered_program_;
+  delete hbao_layered_program_;
+  delete blur_layered_program_;
 
   if (initialized_) {
     glDeleteVertexArrays(1, &vao_);
     glDeleteBuffers(1, &vbo_);
     glDeleteBuffers(1, &vno_);
     glDeleteBuffers(1, &ebo_);
+    glDeleteBuffers(1, &instance_buffer_);
+    glDeleteBuffers(1, &indirect_buffer_);
+    streamer_.Release();
 
     glDeleteVertexArrays(1, &quad_vao_);
     glDeleteBuffers(1, &quad_vbo_);
 
-    glDeleteFramebuffers(1, &g_fbo_);
-    glDeleteRenderbuffers(1, &g_rbo_);
-    glDeleteTextures(1, &g_normal_depth_texture_);
-
-    glDeleteFramebuffers(COLOR_FBOS, c_fbo_);
-    glDeleteTextures(COLOR_FBOS, c_textures_);
+    target_pool_.Clear();
+    ReleaseMultiViewTargets();
+    gpu_timer_.Release();
 
     glDeleteTextures(1, &noise_texture_);
+    glDeleteTextures(1, &direction_texture_);
 
-    delete[] c_textures_;
+    glDeleteQueries(1, &adaptive_query_);
   }
 }
 
 bool GLWidget::LoadModel(const QString &filename) {
+  SynchronousRendering synchronous(this);
+
   std::string file = filename.toUtf8().constData();
   size_t pos = file.find_last_of(".");
   std::string type = file.substr(pos + 1);
 
+  if (type.compare("pages") == 0) {
+    if (!streamer_.Open(file, kStreamingBudget)) return false;
+
+    scene_.Clear();
+    draw_commands_.clear();
+    ++scene_version_;
+    const data_representation::PagedMesh &kMesh = streamer_.mesh();
+    camera_.UpdateModel(kMesh.min_, kMesh.max_);
+
+    size_t vertices = 0;
+    for (const data_representation::PageInfo &kPage : kMesh.pages()) vertices += kPage.vertices;
+    emit SetFaces(QString(std::to_string(kMesh.triangles()).c_str()));
+    emit SetVertices(QString(std::to_string(vertices).c_str()));
+    UpdateMemoryStats();
+    return true;
+  }
+
   std::unique_ptr<data_representation::TriangleMesh> mesh =
       std::make_unique<data_representation::TriangleMesh>();
 
@@ -134,42 +451,1534 @@ bool GLWidget::LoadModel(const QString &filename) {
     res = data_representation::ReadFromPly(file, mesh.get());
   }
 
+  if (res && welding_) data_representation::WeldVertices(mesh.get(), weld_options_).Print(&std::cout);
+
   if (res) {
-    mesh_.reset(mesh.release());
-    camera_.UpdateModel(mesh_->min_, mesh_->max_);
+    // Accounted until the mesh is freed, so that the CPU peak shows the
+    // mesh and its copy in the arena living together.
+    memory_stats_.Set("Loaded mesh", MeshBytes(*mesh), 0);
 
-    // TODO(students): Create / Initialize buffers.
-    glGenVertexArrays(1, &vao_);
-    glBindVertexArray(vao_);
+    streamer_.Release();
+    scene_.Clear();
+    scene_.AddInstance(scene_.AddMesh(*mesh), Eigen::Matrix4f::Identity());
+    UploadScene();
 
-    glGenBuffers(1, &vbo_);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, mesh_->vertices_.size() * sizeof(float), &mesh_->vertices_[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    glEnableVertexAttribArray(0);
+    mesh.reset();
+    memory_stats_.Set("Loaded mesh", 0, 0);
+    return true;
+  }
 
-    glGenBuffers(1, &vno_);
-    glBindBuffer(GL_ARRAY_BUFFER, vno_);
-    glBufferData(GL_ARRAY_BUFFER, mesh_->normals_.size() * sizeof(float), &mesh_->normals_[0], GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    glEnableVertexAttribArray(1);
+  return false;
+}
 
+bool GLWidget::LoadScene(const QString &filename) {
+  SynchronousRendering synchronous(this);
+
+  data_representation::Scene scene;
+  if (!data_representation::ReadFromScene(filename.toUtf8().constData(), &scene,
+                                          welding_ ? &weld_options_ : nullptr))
+    return false;
+
+  streamer_.Release();
+  scene_ = std::move(scene);
+  UploadScene();
+  return true;
+}
+
+void GLWidget::UploadScene() {
+  ++scene_version_;
+  camera_.UpdateModel(scene_.min_, scene_.max_);
+
+  std::vector<float> transforms;
+  scene_.BuildDraws(&draw_commands_, &transforms);
+
+  // Buffers are created once and refilled on every load.
+  if (vao_ == 0) {
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &vno_);
     glGenBuffers(1, &ebo_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh_->faces_.size() * sizeof(unsigned int), &mesh_->faces_[0], GL_STATIC_DRAW);
+    glGenBuffers(1, &instance_buffer_);
+    glGenBuffers(1, &indirect_buffer_);
+  }
+
+  glBindVertexArray(vao_);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glBufferData(GL_ARRAY_BUFFER, scene_.vertices().size() * sizeof(float), scene_.vertices().data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glEnableVertexAttribArray(0);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vno_);
+  glBufferData(GL_ARRAY_BUFFER, scene_.normals().size() * sizeof(float), scene_.normals().data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glEnableVertexAttribArray(1);
+
+  // One mat4 per instance, in four vec4 attributes.
+  glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(float), transforms.data(), GL_STATIC_DRAW);
+  for (GLuint column = 0; column < 4; ++column) {
+    glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float),
+                          reinterpret_cast<void *>(column * 4 * sizeof(float)));
+    glVertexAttribDivisor(2 + column, 1);
+    glEnableVertexAttribArray(2 + column);
+  }
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, scene_.indices().size() * sizeof(uint32_t), scene_.indices().data(), GL_STATIC_DRAW);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+  glBindVertexArray(0);
+
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER, draw_commands_.size() * sizeof(data_representation::DrawCommand),
+               draw_commands_.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+  scene_gpu_bytes_ = (scene_.vertices().size() + scene_.normals().size() + transforms.size()) * sizeof(float) +
+                     scene_.indices().size() * sizeof(uint32_t) +
+                     draw_commands_.size() * sizeof(data_representation::DrawCommand);
+  if (release_cpu_geometry_) scene_.ReleaseGeometry();
+
+  emit SetFaces(QString(std::to_string(scene_.Triangles()).c_str()));
+  emit SetVertices(QString(std::to_string(scene_.Vertices()).c_str()));
+  UpdateMemoryStats();
+}
+
+void GLWidget::UpdateMemoryStats() {
+  memory_stats_.Set("Scene", scene_.CpuBytes() + draw_commands_.capacity() * sizeof(data_representation::DrawCommand),
+                    scene_gpu_bytes_);
+
+  size_t page_table_bytes = 0;
+  if (streamer_.open())
+    page_table_bytes = streamer_.mesh().pages().capacity() * sizeof(data_representation::PageInfo);
+  memory_stats_.Set("Page pool", page_table_bytes, streamer_.open() ? streamer_.stats().capacity_bytes : 0);
+
+  const size_t kGBuffer = data_visualization::RenderTargetPool::TargetBytes(g_target_);
+  const size_t kAoTargets = data_visualization::RenderTargetPool::TargetBytes(ao_target_) +
+                            data_visualization::RenderTargetPool::TargetBytes(blur_target_);
+  memory_stats_.Set("G buffer", 0, kGBuffer);
+  memory_stats_.Set("AO and blur targets", 0, kAoTargets);
+  memory_stats_.Set("Transient targets", 0, target_pool_.GpuBytes() - kGBuffer - kAoTargets);
+  memory_stats_.Set("Multi-view targets", 0,
+                    g_layers_.GpuBytes() + ao_layers_.GpuBytes() + blur_layers_.GpuBytes());
+  memory_stats_.Set("Noise textures", 0, noise_bytes_);
+  accounted_targets_ = target_pool_.Targets();
+
+  const QString kLabels[2] = {
+      QString::fromStdString(data_visualization::MemoryStats::Format(memory_stats_.CpuBytes())),
+      QString::fromStdString(data_visualization::MemoryStats::Format(memory_stats_.GpuBytes()))};
+  if (kLabels[0] != memory_labels_[0]) emit SetCpuMemory(kLabels[0]);
+  if (kLabels[1] != memory_labels_[1]) emit SetGpuMemory(kLabels[1]);
+  memory_labels_[0] = kLabels[0];
+  memory_labels_[1] = kLabels[1];
+}
+
+void GLWidget::SetReleaseCpuGeometry(bool enabled) {
+  SynchronousRendering synchronous(this);
+  release_cpu_geometry_ = enabled;
+  if (enabled && !scene_.instances().empty()) {
+    scene_.ReleaseGeometry();
+    UpdateMemoryStats();
+  }
+}
+
+bool GLWidget::SetMultiView(int views) {
+  if (views > 1 && !multiview_supported_) return false;
+  SynchronousRendering synchronous(this);
+
+  views_ = std::min(std::max(views, 1), kMaxViews);
+  if (views_ == 1 && initialized_) {
+    makeCurrent();
+    ReleaseMultiViewTargets();
+    UpdateMemoryStats();
+  }
+  InvalidatePasses();
+  updateGL();
+  return true;
+}
+
+void GLWidget::ReleaseMultiViewTargets() {
+  g_layers_.Release();
+  ao_layers_.Release();
+  blur_layers_.Release();
+}
+
+void GLWidget::ReportMemory() {
+  SynchronousRendering synchronous(this);
+  UpdateMemoryStats();
+  memory_stats_.Print(&std::cout);
+  memory_stats_.ResetPeaks();
+
+  std::cout << "Render target pool" << std::endl;
+  std::cout << "\tTargets = " << target_pool_.Targets() << std::endl;
+  std::cout << "\tGPU memory = " << target_pool_.GpuBytes() / (1024.0 * 1024.0)
+            << " MB" << std::endl;
+}
+
+bool GLWidget::HasGeometry() const {
+  return !scene_.instances().empty() || streamer_.open();
+}
+
+void GLWidget::DrawScene() {
+  glBindVertexArray(vao_);
+
+  if (multi_draw_supported_) {
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr,
+                                static_cast<GLsizei>(draw_commands_.size()), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  } else {
+    // Without base instances the instance attributes are rebased per draw.
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    for (const data_representation::DrawCommand &kCommand : draw_commands_) {
+      const size_t kOffset = kCommand.base_instance * 16 * sizeof(float);
+      for (GLuint column = 0; column < 4; ++column)
+        glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float),
+                              reinterpret_cast<void *>(kOffset + column * 4 * sizeof(float)));
+
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(kCommand.count), GL_UNSIGNED_INT,
+                                        reinterpret_cast<void *>(kCommand.first_index * sizeof(uint32_t)),
+                                        static_cast<GLsizei>(kCommand.instance_count),
+                                        static_cast<GLint>(kCommand.base_vertex));
+    }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  glBindVertexArray(0);
+}
+
+void GLWidget::StartRecording() {
+  camera_path_.Clear();
+  recording_ = true;
+  record_timer_.start();
+  RecordKeyframe();
+}
+
+void GLWidget::StopRecording() {
+  RecordKeyframe();
+  recording_ = false;
+}
+
+bool GLWidget::SaveCameraPath(const QString &filename) const {
+  return camera_path_.Save(filename.toUtf8().constData());
+}
+
+bool GLWidget::LoadCameraPath(const QString &filename) {
+  return camera_path_.Load(filename.toUtf8().constData());
+}
+
+bool GLWidget::RunBenchmark() {
+  if (!initialized_ || camera_path_.Empty()) return false;
+  SynchronousRendering synchronous(this);
+
+  const data_visualization::CameraState kCurrent = camera_.GetState();
+  const data_visualization::CameraState kRecorded = camera_path_.Sample(0.0);
+  if (kRecorded.viewport_width != kCurrent.viewport_width ||
+      kRecorded.viewport_height != kCurrent.viewport_height) {
+    std::cout << "Warning: camera path recorded at " << kRecorded.viewport_width
+              << "x" << kRecorded.viewport_height << ", replaying at "
+              << kCurrent.viewport_width << "x" << kCurrent.viewport_height
+              << std::endl;
+  }
+
+  const int kFrames =
+      static_cast<int>(camera_path_.Duration() / kBenchmarkTimestep) + 1;
+
+  data_visualization::FrameStats stats;
+
+  makeCurrent();
+  for (int i = -kBenchmarkWarmupFrames; i < kFrames; ++i) {
+    camera_.SetState(camera_path_.Sample(std::max(i, 0) * kBenchmarkTimestep));
+    InvalidatePasses();
+
+    glFinish();
+    auto start = std::chrono::steady_clock::now();
+    paintGL();
+    glFinish();
+    auto end = std::chrono::steady_clock::now();
+
+    if (i >= 0)
+      stats.AddFrame(
+          std::chrono::duration<double, std::milli>(end - start).count());
+
+    swapBuffers();
+  }
+
+  camera_.SetState(kCurrent);
+
+  stats.Print("Benchmark", &std::cout);
+  emit SetFramerate(QString::number(1000.0 / stats.Mean(), 'f', 1));
+
+  updateGL();
+  return true;
+}
+
+void GLWidget::SetFrameCoalescing(bool enabled) { coalesce_frames_ = enabled; }
+
+void GLWidget::SetDynamicResolution(bool enabled) {
+  SynchronousRendering synchronous(this);
+  dynamic_resolution_ = enabled;
+  resolution_.Reset();
+
+  if (initialized_) {
+    makeCurrent();
+    ApplyRenderScale();
+    InvalidatePasses();
+  }
+  update();
+}
+
+void GLWidget::SetFrameBudget(double ms) {
+  SynchronousRendering synchronous(this);
+  resolution_.SetBudget(ms);
+}
+
+void GLWidget::SetThreadedRendering(bool enabled) {
+  if (!initialized_ || enabled == threaded_rendering()) return;
+
+  if (enabled) {
+    render_camera_ = camera_;
+
+    doneCurrent();
+    render_thread_ = std::make_unique<gui::RenderThread>(this, [this]() { RenderThreadFrame(); });
+    context()->moveToThread(render_thread_.get());
+    render_thread_->start();
+
+    frame_dirty_ = false;
+    PublishState();
+  } else {
+    // Joining the thread gives the context back to the GUI thread.
+    render_thread_->Stop();
+    render_thread_.reset();
+
+    // The last snapshots may not have been rendered.
+    makeCurrent();
+    frame_pacer_.Release();
+    ApplyState(gui_state_);
+    if (gui_state_.window_width != static_cast<int>(window_width_) ||
+        gui_state_.window_height != static_cast<int>(window_height_))
+      ResizeViewport(gui_state_.window_width, gui_state_.window_height);
+
+    // The thread may have stopped before settling the last resize.
+    settle_pending_.store(false, std::memory_order_relaxed);
+    SettleRenderTargets();
+  }
+}
+
+void GLWidget::ReportInputLatency() {
+  const char *label = "Input latency (synchronous)";
+  if (threaded_rendering())
+    label = "Input latency (render thread)";
+  else if (coalesce_frames_)
+    label = "Input latency (coalesced)";
+
+  SynchronousRendering synchronous(this);
+  latency_stats_.Print(label, &std::cout);
+  latency_stats_.Clear();
+
+  ui_stats_.Print("GUI thread timer interval", &std::cout);
+  ui_stats_.Clear();
+
+  frame_pacer_.Print(&std::cout);
+  frame_pacer_.Clear();
+}
+
+void GLWidget::RequestFrame(const QInputEvent *event) {
+  // Event timestamps come from the window system in milliseconds with an
+  // unknown epoch. The smallest offset seen so far is the one of an event
+  // that was not queued, so it maps them to input_timer_ and the time spent
+  // waiting in the event queue is accounted too.
+  const qint64 kNow = input_timer_.nsecsElapsed();
+  const qint64 kTimestamp = static_cast<qint64>(event->timestamp()) * 1000000;
+  input_clock_offset_ = std::min(input_clock_offset_, kNow - kTimestamp);
+
+  // The render thread tells when the dirty events have been displayed.
+  if (frame_dirty_ && threaded_rendering() &&
+      presented_event_time_.load(std::memory_order_acquire) >= dirty_event_time_)
+    frame_dirty_ = false;
+
+  if (!frame_dirty_) {
+    frame_dirty_ = true;
+    dirty_event_time_ = kTimestamp + input_clock_offset_;
+  }
+
+  if (threaded_rendering()) {
+    gui_state_.event_time = dirty_event_time_;
+    PublishState();
+    gui_state_.event_time = 0;
+  } else if (coalesce_frames_) {
+    update();
+  } else {
+    updateGL();
+  }
+}
+
+void GLWidget::PublishState() {
+  if (!threaded_rendering()) {
+    ApplyState(gui_state_);
+    update();
+    return;
+  }
+
+  gui_state_.camera = camera_;
+  state_mailbox_.Publish(gui_state_);
+  render_thread_->Wake();
+}
+
+void GLWidget::ApplyState(const RenderState &state) {
+  ao_program_ = state.ao_program;
+  ao_technique_ = state.ao_technique;
+  adaptive_ao_ = state.adaptive_ao;
+  blur_ = state.blur;
+  hbao_directions = state.directions;
+  hbao_steps = state.steps;
+  hbao_radius = state.radius;
+  hbao_t_bias = state.t_bias;
+  hbao_strength = state.strength;
+}
+
+void GLWidget::RenderThreadFrame() {
+  RenderState state;
+  if (state_mailbox_.Take(&state)) {
+    ApplyState(state);
+    render_camera_ = state.camera;
+
+    if (state.window_width != static_cast<int>(window_width_) ||
+        state.window_height != static_cast<int>(window_height_))
+      ResizeViewport(state.window_width, state.window_height);
+
+    if (state.event_time > presented_event_time_.load(std::memory_order_relaxed))
+      render_event_time_ = state.event_time;
+  }
+
+  if (settle_pending_.exchange(false, std::memory_order_relaxed)) {
+    AllocateRenderTargets();
+    target_pool_.Trim();
+    UpdateMemoryStats();
+    InvalidatePasses();
+  }
+
+  paintGL();
+  swapBuffers();
+  frame_pacer_.EndFrame();
+
+  if (render_event_time_ != 0) {
+    latency_stats_.AddFrame((input_timer_.nsecsElapsed() - render_event_time_) /
+                            1000000.0);
+    presented_event_time_.store(render_event_time_, std::memory_order_release);
+    render_event_time_ = 0;
+  }
+}
+
+void GLWidget::RequestRedraw() {
+  if (threaded_rendering())
+    render_thread_->Wake();
+  else
+    update();
+}
 
-    glBindVertexArray(0);
-    // END.
+void GLWidget::MeasureResponsiveness() {
+  ui_stats_.AddFrame(ui_clock_.nsecsElapsed() / 1000000.0);
+  ui_clock_.restart();
+}
+
+void GLWidget::glDraw() {
+  QGLWidget::glDraw();
+
+  if (frame_dirty_) {
+    latency_stats_.AddFrame((input_timer_.nsecsElapsed() - dirty_event_time_) /
+                            1000000.0);
+    frame_dirty_ = false;
+  }
+}
+
+bool GLWidget::RunRadiusBenchmark() {
+  if (!initialized_ || !HasGeometry()) return false;
+  SynchronousRendering synchronous(this);
+
+  const int kTechniques[] = {ao_techniques_.Find("hbao"),
+                             ao_techniques_.Find("hbao_compute")};
+
+  const float kRadius = hbao_radius;
+  const size_t kTechnique = ao_technique_;
+  const unsigned int kProgram = ao_program_;
+  ao_program_ = 0;
+
+  std::cout << "HBAO radius benchmark (" << width_ << "x" << height_
+            << ", directions = " << hbao_directions
+            << ", steps = " << hbao_steps << ")" << std::endl;
+  std::cout << "\tradius\tfragment ms\tcompute ms" << std::endl;
+
+  makeCurrent();
+  for (float radius : kBenchmarkRadii) {
+    hbao_radius = radius;
+    std::cout << "\t" << radius;
+
+    for (int technique : kTechniques) {
+      if (technique < 0 || ao_programs_[technique] == nullptr) {
+        std::cout << "\t-";
+        continue;
+      }
+      ao_technique_ = static_cast<size_t>(technique);
+
+      std::cout << "\t" << TimeAoPass(kRadiusBenchmarkFrames);
+    }
+    std::cout << std::endl;
+  }
+
+  hbao_radius = kRadius;
+  ao_technique_ = kTechnique;
+  ao_program_ = kProgram;
+  gpu_timer_.Clear();
+
+  updateGL();
+  return true;
+}
+
+bool GLWidget::RunHbaoComparison() {
+  if (!initialized_ || !HasGeometry()) return false;
+  SynchronousRendering synchronous(this);
+
+  const int kTechniques[] = {ao_techniques_.Find("hbao"),
+                             ao_techniques_.Find("hbao_fast")};
+  assert(kTechniques[0] >= 0 && kTechniques[1] >= 0);
+
+  const size_t kTechnique = ao_technique_;
+  const unsigned int kProgram = ao_program_;
+  ao_program_ = 0;
+
+  makeCurrent();
+  double ms[2];
+  std::vector<GLfloat> ao[2];
+  for (int i = 0; i < 2; ++i) {
+    ao_technique_ = static_cast<size_t>(kTechniques[i]);
+    ms[i] = TimeAoPass(kComparisonFrames);
+    ao[i] = ReadAo(ao_target_->fbo, static_cast<GLsizei>(width_), static_cast<GLsizei>(height_));
+  }
+
+  double max_error = 0.0;
+  double sum_error = 0.0;
+  for (size_t i = 0; i < ao[0].size(); ++i) {
+    const double kError = std::abs(static_cast<double>(ao[1][i]) - ao[0][i]);
+    max_error = std::max(max_error, kError);
+    sum_error += kError;
+  }
+
+  std::cout << "HBAO reference vs fast (" << width_ << "x" << height_
+            << ", directions = " << hbao_directions
+            << ", steps = " << hbao_steps << ")" << std::endl;
+  std::cout << "\tReference = " << ms[0] << " ms" << std::endl;
+  std::cout << "\tFast = " << ms[1] << " ms";
+  if (ms[1] > 0.0) std::cout << " (" << ms[0] / ms[1] << "x)";
+  std::cout << std::endl;
+  std::cout << "\tMax AO error = " << max_error << std::endl;
+  std::cout << "\tMean AO error = " << sum_error / std::max<size_t>(ao[0].size(), 1) << std::endl;
+
+  ao_technique_ = kTechnique;
+  ao_program_ = kProgram;
+  gpu_timer_.Clear();
+
+  updateGL();
+  return true;
+}
 
-    emit SetFaces(QString(std::to_string(mesh_->faces_.size() / 3).c_str()));
-    emit SetVertices(
-        QString(std::to_string(mesh_->vertices_.size() / 3).c_str()));
+bool GLWidget::RunTechniqueBenchmark() {
+  if (!initialized_ || !HasGeometry()) return false;
+  SynchronousRendering synchronous(this);
+
+  const size_t kTechnique = ao_technique_;
+  const unsigned int kProgram = ao_program_;
+  ao_program_ = 0;
+
+  makeCurrent();
+
+  // Reference: HBAO with kReferenceQuality times the directions and steps.
+  const GLint kDirections = hbao_directions;
+  const GLint kSteps = hbao_steps;
+  hbao_directions *= kReferenceQuality;
+  hbao_steps *= kReferenceQuality;
+  ao_technique_ = static_cast<size_t>(std::max(ao_techniques_.Find("hbao"), 0));
+  const double kReferenceMs = TimeAoPass(kComparisonFrames);
+  const std::vector<GLfloat> kReference =
+      ReadAo(ao_target_->fbo, static_cast<GLsizei>(width_), static_cast<GLsizei>(height_));
+  hbao_directions = kDirections;
+  hbao_steps = kSteps;
+
+  std::cout << "AO technique benchmark (" << width_ << "x" << height_
+            << ", directions = " << hbao_directions
+            << ", steps = " << hbao_steps << ")" << std::endl;
+  std::cout << "\tReference: " << ao_techniques_.Get(ao_technique_).Label()
+            << " x" << kReferenceQuality << " = " << kReferenceMs << " ms"
+            << std::endl;
+  std::cout << "\ttechnique\tms\tmean error" << std::endl;
+
+  for (size_t i = 0; i < ao_techniques_.Size(); ++i) {
+    std::cout << "\t" << ao_techniques_.Get(i).Label();
+    if (ao_programs_[i] == nullptr) {
+      std::cout << "\t-\t-" << std::endl;
+      continue;
+    }
+
+    ao_technique_ = i;
+    const double kMs = TimeAoPass(kComparisonFrames);
+    const std::vector<GLfloat> kAo =
+        ReadAo(ao_target_->fbo, static_cast<GLsizei>(width_), static_cast<GLsizei>(height_));
+
+    double sum_error = 0.0;
+    for (size_t j = 0; j < kAo.size(); ++j)
+      sum_error += std::abs(static_cast<double>(kAo[j]) - kReference[j]);
+
+    std::cout << "\t" << kMs << "\t" << sum_error / std::max<size_t>(kAo.size(), 1)
+              << std::endl;
+  }
+
+  ao_technique_ = kTechnique;
+  ao_program_ = kProgram;
+  gpu_timer_.Clear();
+
+  updateGL();
+  return true;
+}
+
+void GLWidget::RenderTimedFrames(int frames) {
+  for (int i = 0; i < frames; ++i) {
+    if (i == kBenchmarkWarmupFrames) {
+      gpu_timer_.Flush();
+      gpu_timer_.Clear();
+    }
+    InvalidatePasses();
+    paintGL();
+  }
+  gpu_timer_.Flush();
+}
+
+double GLWidget::TimeAoPass(int frames) {
+  // The AO has to land in ao_target_, where the benchmarks read it.
+  const bool kFusedBlur = fused_blur_;
+  fused_blur_ = false;
+  RenderTimedFrames(frames);
+  fused_blur_ = kFusedBlur;
+
+  const std::string kName = ao_techniques_.Get(ActiveAoTechnique()).Name();
+  return gpu_timer_.MeanPassMs(kName) + gpu_timer_.MeanPassMs(kName + "_coarse") +
+         gpu_timer_.MeanPassMs("ao_classify") + gpu_timer_.MeanPassMs("linear_z");
+}
+
+bool GLWidget::RunFusedBlurComparison() {
+  if (!initialized_ || !HasGeometry()) return false;
+  SynchronousRendering synchronous(this);
+
+  const size_t kTechnique = ActiveAoTechnique();
+  if (fused_programs_[kTechnique] == nullptr) {
+    std::cout << ao_techniques_.Get(kTechnique).Label() << " has no fused blur" << std::endl;
     return true;
   }
 
+  const bool kFusedBlur = fused_blur_;
+  const bool kAdaptive = adaptive_ao_;
+  const unsigned int kBlur = blur_;
+  const unsigned int kProgram = ao_program_;
+  adaptive_ao_ = false;
+  blur_ = 1;
+  ao_program_ = 0;
+
+  makeCurrent();
+  const std::string kName = ao_techniques_.Get(kTechnique).Name();
+  double ms[2];
+  std::vector<GLfloat> blurred[2];
+  for (int i = 0; i < 2; ++i) {
+    fused_blur_ = i == 1;
+    RenderTimedFrames(kComparisonFrames);
+    ms[i] = gpu_timer_.MeanPassMs(kName) + gpu_timer_.MeanPassMs("blur") +
+            gpu_timer_.MeanPassMs(kName + "_blur");
+    blurred[i] = ReadAo(blur_target_->fbo, static_cast<GLsizei>(width_), static_cast<GLsizei>(height_));
+  }
+
+  double max_error = 0.0;
+  for (size_t i = 0; i < blurred[0].size(); ++i)
+    max_error = std::max(max_error, std::abs(static_cast<double>(blurred[1][i]) - blurred[0][i]));
+
+  std::cout << "Separate vs fused " << ao_techniques_.Get(kTechnique).Label()
+            << " and blur (" << width_ << "x" << height_ << ")" << std::endl;
+  std::cout << "\tSeparate = " << ms[0] << " ms" << std::endl;
+  std::cout << "\tFused = " << ms[1] << " ms";
+  if (ms[1] > 0.0) std::cout << " (" << ms[0] / ms[1] << "x)";
+  std::cout << std::endl;
+  std::cout << "\tMax error = " << max_error << std::endl;
+
+  fused_blur_ = kFusedBlur;
+  adaptive_ao_ = kAdaptive;
+  blur_ = kBlur;
+  ao_program_ = kProgram;
+  gpu_timer_.Clear();
+
+  updateGL();
+  return true;
+}
+
+bool GLWidget::RunVulkanComparison() {
+#ifdef HBAO_VULKAN
+  // The backend draws the scene_ arena, paged meshes are not supported.
+  if (!initialized_ || scene_.instances().empty()) return false;
+  SynchronousRendering synchronous(this);
+
+  // The Vulkan backend only implements the compute HBAO, comparing it with
+  // the fragment one would not be like for like.
+  const int kCompute = ao_techniques_.Find("hbao_compute");
+  if (kCompute < 0 || ao_programs_[kCompute] == nullptr) {
+    std::cerr << "The Vulkan comparison needs the OpenGL compute HBAO" << std::endl;
+    return false;
+  }
+
+  if (vulkan_ == nullptr) {
+    std::vector<float> noise;
+    int noise_side = 0;
+    if (!LoadNoiseValues(noise_file, &noise, &noise_side)) return false;
+
+    vulkan_ = std::make_unique<data_visualization::VulkanRenderer>();
+    if (!vulkan_->Initialize(vulkan_shader_dir, noise, noise_side)) {
+      vulkan_.reset();
+      return false;
+    }
+    vulkan_scene_version_ = 0;
+  }
+
+  if (vulkan_scene_version_ != scene_version_) {
+    if (scene_.geometry_released()) {
+      std::cerr << "The CPU geometry was released, load the model again" << std::endl;
+      return false;
+    }
+    if (!vulkan_->LoadScene(scene_)) return false;
+    vulkan_scene_version_ = scene_version_;
+  }
+  if (!vulkan_->Resize(static_cast<int>(width_), static_cast<int>(height_))) return false;
+
+  // Both paths render the same cameras, with the compute HBAO and the
+  // separate blur passes.
+  const data_visualization::CameraState kCurrent = camera_.GetState();
+  const int kFrames = camera_path_.Empty()
+                          ? kVulkanComparisonFrames
+                          : static_cast<int>(camera_path_.Duration() / kBenchmarkTimestep) + 1;
+
+  std::vector<data_visualization::VulkanFrame> frames(kFrames);
+  for (int i = 0; i < kFrames; ++i) {
+    if (!camera_path_.Empty()) camera_.SetState(camera_path_.Sample(i * kBenchmarkTimestep));
+    frames[i].projection = camera_.SetProjection();
+    frames[i].view_model = camera_.SetView() * camera_.SetModel();
+  }
+
+  const size_t kTechnique = ao_technique_;
+  const bool kFusedBlur = fused_blur_;
+  const bool kAdaptive = adaptive_ao_;
+  const unsigned int kProgram = ao_program_;
+  ao_technique_ = static_cast<size_t>(kCompute);
+  fused_blur_ = false;
+  adaptive_ao_ = false;
+  ao_program_ = 0;
+
+  // Throughput: frames are submitted back to back and only the end of the
+  // last one is waited for.
+  makeCurrent();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = -kBenchmarkWarmupFrames; i < kFrames; ++i) {
+    if (i == 0) {
+      glFinish();
+      start = std::chrono::steady_clock::now();
+    }
+    if (!camera_path_.Empty())
+      camera_.SetState(camera_path_.Sample(std::max(i, 0) * kBenchmarkTimestep));
+    InvalidatePasses();
+    paintGL();
+  }
+  glFinish();
+  const double kGlMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  const data_visualization::AoParameters kParameters = CurrentAoParameters();
+  const std::vector<data_visualization::VulkanFrame> kWarmup(kBenchmarkWarmupFrames, frames[0]);
+  data_visualization::VulkanStats stats[2];
+  bool res = true;
+  for (int i = 0; i < 2 && res; ++i) {
+    res = vulkan_->Render(kWarmup, kParameters, blur_, i == 1, &stats[i]) &&
+          vulkan_->Render(frames, kParameters, blur_, i == 1, &stats[i]);
+  }
+
+  if (res) {
+    const double kGlFps = 1000.0 * kFrames / kGlMs;
+    std::cout << "GL vs Vulkan (" << width_ << "x" << height_ << ", " << kFrames
+              << " frames)" << std::endl;
+    std::cout << "\tDevice = " << vulkan_->device_name() << std::endl;
+    std::cout << "\tGL = " << kGlFps << " fps" << std::endl;
+    std::cout << "\tVulkan, one queue = " << stats[0].FramesPerSecond() << " fps" << std::endl;
+    std::cout << "\tVulkan, async compute = " << stats[1].FramesPerSecond() << " fps ("
+              << (stats[1].dedicated_queue ? "dedicated compute queue" : "shared queue")
+              << ")" << std::endl;
+    if (stats[0].FramesPerSecond() > 0.0)
+      std::cout << "\tAsync speedup = " << stats[1].FramesPerSecond() / stats[0].FramesPerSecond()
+                << "x" << std::endl;
+  }
+
+  camera_.SetState(kCurrent);
+  ao_technique_ = kTechnique;
+  fused_blur_ = kFusedBlur;
+  adaptive_ao_ = kAdaptive;
+  ao_program_ = kProgram;
+  gpu_timer_.Clear();
+
+  updateGL();
+  return res;
+#else
+  std::cout << "Built without the Vulkan backend" << std::endl;
   return false;
+#endif
+}
+
+bool GLWidget::RunMultiViewComparison() {
+  if (!initialized_ || !HasGeometry() || !multiview_supported_) return false;
+  SynchronousRendering synchronous(this);
+
+  const int kViews = views_;
+  const size_t kTechnique = ao_technique_;
+  const bool kFusedBlur = fused_blur_;
+  const bool kAdaptive = adaptive_ao_;
+  const unsigned int kProgram = ao_program_;
+  const int kCompute = ao_techniques_.Find("hbao_compute");
+  if (kCompute >= 0 && ao_programs_[kCompute] != nullptr) ao_technique_ = static_cast<size_t>(kCompute);
+  fused_blur_ = false;
+  adaptive_ao_ = false;
+  ao_program_ = 0;
+
+  // Same work on both sides: N regular frames of the current view against
+  // one layered frame of N views.
+  const int kMultiViews = std::max(kViews, 2);
+  makeCurrent();
+  double ms[2];
+  for (int i = 0; i < 2; ++i) {
+    views_ = i == 0 ? 1 : kMultiViews;
+    const int kFrames = i == 0 ? kComparisonFrames * kMultiViews : kComparisonFrames;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = -kBenchmarkWarmupFrames; frame < kFrames; ++frame) {
+      if (frame == 0) {
+        glFinish();
+        start = std::chrono::steady_clock::now();
+      }
+      InvalidatePasses();
+      paintGL();
+    }
+    glFinish();
+    ms[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() /
+            kComparisonFrames;
+  }
+
+  std::cout << "Separate vs layered multi-view (" << kMultiViews << " views, " << width_ << "x"
+            << height_ << ")" << std::endl;
+  std::cout << "\tSeparate = " << ms[0] << " ms, " << ms[0] / kMultiViews << " ms per view" << std::endl;
+  std::cout << "\tLayered = " << ms[1] << " ms, " << ms[1] / kMultiViews << " ms per view";
+  if (ms[1] > 0.0) std::cout << " (" << ms[0] / ms[1] << "x)";
+  std::cout << std::endl;
+
+  views_ = kViews;
+  if (views_ == 1) ReleaseMultiViewTargets();
+  ao_technique_ = kTechnique;
+  fused_blur_ = kFusedBlur;
+  adaptive_ao_ = kAdaptive;
+  ao_program_ = kProgram;
+  gpu_timer_.Clear();
+
+  updateGL();
+  return true;
+}
+
+bool GLWidget::RunAdaptiveComparison() {
+  if (!initialized_ || !HasGeometry()) return false;
+  SynchronousRendering synchronous(this);
+
+  const bool kAdaptive = adaptive_ao_;
+  const unsigned int kProgram = ao_program_;
+  ao_program_ = 0;
+
+  makeCurrent();
+  double ms[2];
+  std::vector<GLfloat> ao[2];
+  for (int i = 0; i < 2; ++i) {
+    adaptive_ao_ = i == 1;
+    ms[i] = TimeAoPass(kComparisonFrames);
+    ao[i] = ReadAo(ao_target_->fbo, static_cast<GLsizei>(width_), static_cast<GLsizei>(height_));
+  }
+  CollectAdaptiveStats(true);
+
+  double max_error = 0.0;
+  double sum_error = 0.0;
+  for (size_t i = 0; i < ao[0].size(); ++i) {
+    const double kError = std::abs(static_cast<double>(ao[1][i]) - ao[0][i]);
+    max_error = std::max(max_error, kError);
+    sum_error += kError;
+  }
+
+  std::cout << "Full vs adaptive " << ao_techniques_.Get(ActiveAoTechnique()).Label()
+            << " (" << width_ << "x" << height_ << ")" << std::endl;
+  std::cout << "\tFull = " << ms[0] << " ms, " << adaptive_full_samples_
+            << " samples per pixel" << std::endl;
+  std::cout << "\tAdaptive = " << ms[1] << " ms, " << adaptive_samples_
+            << " samples per pixel, " << adaptive_refined_ * 100.0
+            << " % refined" << std::endl;
+  std::cout << "\tMax AO error = " << max_error << std::endl;
+  std::cout << "\tMean AO error = " << sum_error / std::max<size_t>(ao[0].size(), 1) << std::endl;
+
+  adaptive_ao_ = kAdaptive;
+  ao_program_ = kProgram;
+  gpu_timer_.Clear();
+
+  updateGL();
+  return true;
+}
+
+bool GLWidget::LoadAoPrograms() {
+  for (QOpenGLShaderProgram *program : ao_programs_) delete program;
+  ao_programs_.assign(ao_techniques_.Size(), nullptr);
+  for (QOpenGLShaderProgram *program : fused_programs_) delete program;
+  fused_programs_.assign(ao_techniques_.Size(), nullptr);
+
+  const std::string kDir = ao_shader_dir;
+  bool res = true;
+  for (size_t i = 0; i < ao_techniques_.Size(); ++i) {
+    const data_visualization::AoTechnique &technique = ao_techniques_.Get(i);
+    const data_visualization::AoShaders kShaders = technique.Shaders();
+
+    QOpenGLShaderProgram *program = new QOpenGLShaderProgram();
+    const data_visualization::AoResources kResources = technique.Resources();
+    bool loaded;
+    if (kResources.compute) {
+      loaded = compute_supported_ && LoadComputeProgram(kDir + kShaders.compute, *program);
+      if (!loaded)
+        std::cout << technique.Label() << " not available, using "
+                  << ao_techniques_.Get(0).Label() << std::endl;
+    } else if (kResources.texture_gather && !gather_supported_) {
+      loaded = false;
+      std::cout << technique.Label() << " not available, using "
+                << ao_techniques_.Get(0).Label() << std::endl;
+    } else {
+      loaded = LoadProgram(kDir + kShaders.vertex, kDir + kShaders.fragment, *program);
+      res &= loaded;
+    }
+
+    if (loaded) {
+      ao_programs_[i] = program;
+    } else {
+      delete program;
+    }
+
+    if (compute_supported_ && !kShaders.fused_blur.empty()) {
+      program = new QOpenGLShaderProgram();
+      if (LoadComputeProgram(kDir + kShaders.fused_blur, *program, "#define FUSED_BLUR\n")) {
+        fused_programs_[i] = program;
+      } else {
+        delete program;
+      }
+    }
+  }
+
+  return res && ao_programs_[0] != nullptr;
+}
+
+void GLWidget::LoadMultiViewPrograms() {
+  delete g_layered_program_;
+  delete hbao_layered_program_;
+  delete blur_layered_program_;
+  g_layered_program_ = nullptr;
+  hbao_layered_program_ = nullptr;
+  blur_layered_program_ = nullptr;
+  multiview_supported_ = false;
+
+  // The HBAO and the blur of the layers are compute dispatches.
+  if (!compute_supported_) return;
+
+  g_layered_program_ = new QOpenGLShaderProgram();
+  hbao_layered_program_ = new QOpenGLShaderProgram();
+  blur_layered_program_ = new QOpenGLShaderProgram();
+  multiview_supported_ =
+      LoadProgram(g_layered_vert_file, g_layered_geom_file, g_frag_file, *g_layered_program_) &&
+      LoadComputeProgram(hbao_layered_comp_file, *hbao_layered_program_, "#define LAYERED\n") &&
+      LoadComputeProgram(blur_layered_comp_file, *blur_layered_program_);
+
+  if (!multiview_supported_) {
+    std::cout << "Multi-view rendering not available" << std::endl;
+    views_ = 1;
+  }
+}
+
+data_visualization::AoParameters GLWidget::CurrentAoParameters() const {
+  const int kReduction = dynamic_resolution_ ? resolution_.ao_reduction() : 0;
+  return {hbao_directions, std::max(1, hbao_steps >> kReduction), hbao_radius,
+          hbao_t_bias, hbao_strength};
+}
+
+void GLWidget::ClassifyAoTiles(const Eigen::Matrix4f &projection, GLuint coarse_fbo,
+                               GLuint coarse_texture, GLuint g_fbo, GLuint g_texture,
+                               GLuint ao_fbo) {
+  const GLint kWidth = static_cast<GLint>(width_);
+  const GLint kHeight = static_cast<GLint>(height_);
+
+  // Start from the coarse AO everywhere, the refinement overwrites the
+  // complex tiles.
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, coarse_fbo);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, ao_fbo);
+  glBlitFramebuffer(0, 0, kWidth, kHeight, 0, 0, kWidth, kHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+  // The geometry mask, which also clears the refine bit of the last frame.
+  CopyStencil(g_fbo, ao_fbo, kWidth, kHeight);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, ao_fbo);
+  glDisable(GL_DEPTH_TEST);
+
+  glEnable(GL_STENCIL_TEST);
+  glStencilFunc(GL_EQUAL, kStencilGeometry | kStencilRefine, kStencilGeometry);
+  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+  glStencilMask(kStencilRefine);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+  classify_program_->bind();
+  glUniformMatrix4fv(classify_program_->uniformLocation("projection"), 1, GL_FALSE, projection.data());
+  glUniform2i(classify_program_->uniformLocation("viewport_size"), kWidth, kHeight);
+  glUniform1i(classify_program_->uniformLocation("tile_size"), kAdaptiveTile);
+  glUniform1f(classify_program_->uniformLocation("variance_threshold"), kAdaptiveVariance);
+  glUniform1f(classify_program_->uniformLocation("depth_threshold"), kAdaptiveDepth);
+
+  glActiveTexture(GL_TEXTURE0 + 0);
+  glBindTexture(GL_TEXTURE_2D, g_texture);
+  glUniform1i(classify_program_->uniformLocation("normalDepthTexture"), 0);
+  glActiveTexture(GL_TEXTURE0 + 1);
+  glBindTexture(GL_TEXTURE_2D, coarse_texture);
+  glUniform1i(classify_program_->uniformLocation("coarse_texture"), 1);
+
+  DrawQuad();
+
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glStencilMask(0xFF);
+  glDisable(GL_STENCIL_TEST);
+}
+
+void GLWidget::CollectAdaptiveStats(bool wait) {
+  if (!adaptive_query_pending_) return;
+
+  if (!wait) {
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(adaptive_query_, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) return;
+  }
+
+  GLuint64 refined = 0;
+  glGetQueryObjectui64v(adaptive_query_, GL_QUERY_RESULT, &refined);
+  adaptive_refined_ = refined / std::max(width_ * height_, 1.0);
+  adaptive_samples_ = adaptive_query_samples_[0] + adaptive_refined_ * adaptive_query_samples_[1];
+  adaptive_full_samples_ = adaptive_query_samples_[1];
+  adaptive_query_pending_ = false;
+}
+
+void GLWidget::CountSkippedAoPixels() {
+  skipped_background_ = 0.0;
+  skipped_sub_pixel_ = 0.0;
+  if (!initialized_ || !HasGeometry() || g_target_ == nullptr) return;
+
+  const GLsizei kWidth = static_cast<GLsizei>(width_);
+  const GLsizei kHeight = static_cast<GLsizei>(height_);
+  const size_t kPixels = static_cast<size_t>(kWidth) * kHeight;
+  if (kPixels == 0) return;
+
+  makeCurrent();
+  std::vector<GLfloat> g_buffer(kPixels * 4);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, g_target_->fbo);
+  glReadPixels(0, 0, kWidth, kHeight, GL_RGBA, GL_FLOAT, g_buffer.data());
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+  // Same projected radius as the AO shaders, r_pixels = kRadiusPixels / -z.
+  const Eigen::Matrix4f kProjection = camera_.SetProjection();
+  const float kRadiusPixels = hbao_radius * kProjection(1, 1) * 0.5f * kHeight;
+
+  size_t background = 0;
+  size_t sub_pixel = 0;
+  for (size_t i = 0; i < kPixels; ++i) {
+    const float kDepth = g_buffer[i * 4 + 3];
+    if (kDepth == 0.0f) {
+      ++background;
+      continue;
+    }
+
+    const float kZ = -kProjection(2, 3) / (2.0f * kDepth - 1.0f + kProjection(2, 2));
+    if (kRadiusPixels < -kZ) ++sub_pixel;
+  }
+
+  skipped_background_ = static_cast<double>(background) / kPixels;
+  skipped_sub_pixel_ = static_cast<double>(sub_pixel) / kPixels;
+}
+
+size_t GLWidget::ActiveAoTechnique() const {
+  const bool kLoaded = ao_technique_ < ao_programs_.size() && ao_programs_[ao_technique_] != nullptr;
+  return kLoaded ? ao_technique_ : 0;
+}
+
+data_visualization::AoFrame GLWidget::CurrentAoFrame(const Eigen::Matrix4f &projection) const {
+  data_visualization::AoFrame frame;
+  frame.projection = projection;
+  frame.aspect_ratio = aspect_ratio;
+  frame.tan_half_fov = tan_half_fov;
+  frame.ray_center[0] = 0.0f;
+  frame.ray_center[1] = 0.0f;
+  frame.pixel_size[0] = pixel_size[0];
+  frame.pixel_size[1] = pixel_size[1];
+  frame.pixel_offset[0] = 0;
+  frame.pixel_offset[1] = 0;
+  frame.uv_scale[0] = uv_scale_[0];
+  frame.uv_scale[1] = uv_scale_[1];
+  frame.viewport_width = static_cast<int>(width_);
+  frame.viewport_height = static_cast<int>(height_);
+  return frame;
+}
+
+void GLWidget::DrawGBuffer(const Eigen::Matrix4f &projection, const Eigen::Matrix4f &view,
+                           const Eigen::Matrix4f &model) {
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glStencilMask(0xFF);
+  glClearStencil(0);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  glEnable(GL_DEPTH_TEST);
+
+  // Geometry mask, the AO passes skip the background with it.
+  glEnable(GL_STENCIL_TEST);
+  glStencilFunc(GL_ALWAYS, kStencilGeometry, 0xFF);
+  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+
+  g_program_->bind();
+  glUniformMatrix4fv(g_program_->uniformLocation("projection"), 1, GL_FALSE, projection.data());
+  glUniformMatrix4fv(g_program_->uniformLocation("view"), 1, GL_FALSE, view.data());
+  glUniformMatrix4fv(g_program_->uniformLocation("model"), 1, GL_FALSE, model.data());
+
+  // Draw scene
+  if (streamer_.open())
+    streamer_.Draw();
+  else
+    DrawScene();
+
+  glDisable(GL_STENCIL_TEST);
+}
+
+void GLWidget::RenderMultiView(const Eigen::Matrix4f &projection, const Eigen::Matrix4f &view,
+                               const Eigen::Matrix4f &model) {
+  const GLsizei kWidth = static_cast<GLsizei>(width_);
+  const GLsizei kHeight = static_cast<GLsizei>(height_);
+  const GLsizei kViews = static_cast<GLsizei>(views_);
+  const GLuint kGroupsX = (static_cast<GLuint>(kWidth) + kComputeTile - 1) / kComputeTile;
+  const GLuint kGroupsY = (static_cast<GLuint>(kHeight) + kComputeTile - 1) / kComputeTile;
+
+  const size_t kLayerBytes = g_layers_.GpuBytes() + ao_layers_.GpuBytes() + blur_layers_.GpuBytes();
+  const bool kAllocated = g_layers_.Allocate(kWidth, kHeight, kViews, GL_RGBA32F, true) &&
+                          ao_layers_.Allocate(kWidth, kHeight, kViews, GL_RGBA16F, false) &&
+                          blur_layers_.Allocate(kWidth, kHeight, kViews, GL_RGBA16F, false);
+  if (g_layers_.GpuBytes() + ao_layers_.GpuBytes() + blur_layers_.GpuBytes() != kLayerBytes)
+    UpdateMemoryStats();
+  if (!kAllocated) {
+    std::cerr << "Multi-view targets incomplete" << std::endl;
+    return;
+  }
+
+  // The views are spread along the camera x axis, centered on the camera.
+  std::vector<GLfloat> views(16 * static_cast<size_t>(kViews));
+  for (GLsizei v = 0; v < kViews; ++v) {
+    const float kOffset = (v - (kViews - 1) * 0.5f) * kViewSeparation;
+    const Eigen::Matrix4f kView = Eigen::Affine3f(Eigen::Translation3f(-kOffset, 0.0f, 0.0f)).matrix() * view;
+    std::copy(kView.data(), kView.data() + 16, views.begin() + 16 * v);
+  }
+
+  gpu_timer_.BeginFrame();
+
+  // G pass, a single draw for every view. Pages are selected with the central
+  // view.
+  gpu_timer_.BeginPass("g_layered");
+  if (streamer_.open()) streamer_.Update(projection * view * model);
+  glBindFramebuffer(GL_FRAMEBUFFER, g_layers_.fbo());
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  glEnable(GL_DEPTH_TEST);
+
+  g_layered_program_->bind();
+  glUniformMatrix4fv(g_layered_program_->uniformLocation("projection"), 1, GL_FALSE, projection.data());
+  glUniformMatrix4fv(g_layered_program_->uniformLocation("views"), kViews, GL_FALSE, views.data());
+  glUniform1i(g_layered_program_->uniformLocation("view_count"), kViews);
+  glUniformMatrix4fv(g_layered_program_->uniformLocation("model"), 1, GL_FALSE, model.data());
+
+  if (streamer_.open())
+    streamer_.Draw();
+  else
+    DrawScene();
+  gpu_timer_.EndPass();
+
+  // HBAO of every layer in one dispatch, with the uniforms of the compute
+  // technique.
+  gpu_timer_.BeginPass("hbao_layered");
+  const int kCompute = ao_techniques_.Find("hbao_compute");
+  hbao_layered_program_->bind();
+  ao_techniques_.Get(static_cast<size_t>(kCompute))
+      .SetUniforms(hbao_layered_program_->programId(), CurrentAoFrame(projection), CurrentAoParameters());
+
+  glActiveTexture(GL_TEXTURE0 + 0);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, g_layers_.texture());
+  glUniform1i(hbao_layered_program_->uniformLocation("normalDepthTexture"), 0);
+  glActiveTexture(GL_TEXTURE0 + 1);
+  glBindTexture(GL_TEXTURE_2D, noise_texture_);
+  glUniform1i(hbao_layered_program_->uniformLocation("noise_texture"), 1);
+
+  glBindImageTexture(0, ao_layers_.texture(), 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+  glUniform1i(hbao_layered_program_->uniformLocation("ao_image"), 0);
+  glDispatchCompute(kGroupsX, kGroupsY, static_cast<GLuint>(kViews));
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+  gpu_timer_.EndPass();
+
+  // Blur, ping-ponging between the AO and blur arrays. Every iteration is a
+  // horizontal and a vertical pass, so the result lands back in ao_layers_.
+  if (blur_ > 0) {
+    gpu_timer_.BeginPass("blur_layered");
+    blur_layered_program_->bind();
+    glUniform2i(blur_layered_program_->uniformLocation("viewport_size"), kWidth, kHeight);
+    glUniform1i(blur_layered_program_->uniformLocation("ao_texture"), 0);
+    glUniform1i(blur_layered_program_->uniformLocation("blurred_image"), 0);
+    glActiveTexture(GL_TEXTURE0 + 0);
+    for (unsigned int i = 0; i < 2 * blur_; ++i) {
+      const bool kHorizontal = i % 2 == 0;
+      const data_visualization::LayeredTarget &kInput = kHorizontal ? ao_layers_ : blur_layers_;
+      const data_visualization::LayeredTarget &kOutput = kHorizontal ? blur_layers_ : ao_layers_;
+
+      glUniform2i(blur_layered_program_->uniformLocation("direction"), kHorizontal ? 1 : 0, kHorizontal ? 0 : 1);
+      glBindTexture(GL_TEXTURE_2D_ARRAY, kInput.texture());
+      glBindImageTexture(0, kOutput.texture(), 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+      glDispatchCompute(kGroupsX, kGroupsY, static_cast<GLuint>(kViews));
+      glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    }
+    gpu_timer_.EndPass();
+  }
+
+  // Present, the views side by side, each one fitted to its column of the
+  // window keeping its aspect ratio.
+  gpu_timer_.BeginPass("present");
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glViewport(0, 0, static_cast<GLsizei>(window_width_), static_cast<GLsizei>(window_height_));
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  const float kColumn = window_width_ / kViews;
+  const float kRows = kColumn * height_ / width_;
+  const GLint kY0 = static_cast<GLint>((window_height_ - kRows) * 0.5f);
+  for (GLsizei v = 0; v < kViews; ++v) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, ao_layers_.layer_fbo(v));
+    glBlitFramebuffer(0, 0, kWidth, kHeight, static_cast<GLint>(v * kColumn), kY0,
+                      static_cast<GLint>((v + 1) * kColumn), kY0 + static_cast<GLint>(kRows),
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  gpu_timer_.EndPass();
+
+  gpu_timer_.EndFrame();
+
+  if (streamer_.pending() > 0) RequestRedraw();
+}
+
+void GLWidget::RenderAo(size_t technique, const data_visualization::AoFrame &frame,
+                        const data_visualization::AoParameters &parameters,
+                        GLuint g_texture, GLuint linear_z_texture, GLuint ao_texture,
+                        bool fused_blur) {
+  const data_visualization::AoTechnique &kTechnique = ao_techniques_.Get(technique);
+  const data_visualization::AoResources kResources = kTechnique.Resources();
+  QOpenGLShaderProgram *program = fused_blur ? fused_programs_[technique] : ao_programs_[technique];
+
+  program->bind();
+  kTechnique.SetUniforms(program->programId(), frame, parameters);
+
+  glActiveTexture(GL_TEXTURE0 + 0);
+  glBindTexture(GL_TEXTURE_2D, g_texture);
+  glUniform1i(program->uniformLocation("normalDepthTexture"), 0);
+
+  if (kResources.noise == data_visualization::AoNoise::kNoiseTexture) {
+    glActiveTexture(GL_TEXTURE0 + 1);
+    glBindTexture(GL_TEXTURE_2D, noise_texture_);
+    glUniform1i(program->uniformLocation("noise_texture"), 1);
+  } else if (kResources.noise == data_visualization::AoNoise::kDirectionTexture) {
+    glActiveTexture(GL_TEXTURE0 + 1);
+    glBindTexture(GL_TEXTURE_2D, direction_texture_);
+    glUniform1i(program->uniformLocation("direction_texture"), 1);
+  }
+
+  if (kResources.linear_z) {
+    glActiveTexture(GL_TEXTURE0 + 2);
+    glBindTexture(GL_TEXTURE_2D, linear_z_texture);
+    glUniform1i(program->uniformLocation("linear_z_texture"), 2);
+  }
+
+  if (kResources.compute || fused_blur) {
+    glBindImageTexture(0, ao_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glUniform1i(program->uniformLocation("ao_image"), 0);
+
+    const GLuint kTile = fused_blur ? kFusedBlurTile : kComputeTile;
+    const GLuint kGroupsX = (static_cast<GLuint>(frame.viewport_width) + kTile - 1) / kTile;
+    const GLuint kGroupsY = (static_cast<GLuint>(frame.viewport_height) + kTile - 1) / kTile;
+    glDispatchCompute(kGroupsX, kGroupsY, 1);
+
+    // The AO is sampled by the blur and blitted by the present pass.
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+  } else {
+    DrawQuad();
+  }
+}
+
+void GLWidget::ReportPassTimings() {
+  SynchronousRendering synchronous(this);
+
+  gpu_timer_.Print(&std::cout);
+  std::cout << "Render graph" << std::endl;
+  std::cout << "\tPasses = " << graph_stats_.passes << std::endl;
+  std::cout << "\tCulled = " << graph_stats_.culled << std::endl;
+  std::cout << "\tTransient resources = " << graph_stats_.transient_resources
+            << std::endl;
+  std::cout << "\tTransient targets = " << graph_stats_.transient_targets
+            << std::endl;
+  CountSkippedAoPixels();
+  std::cout << "Skipped AO pixels" << std::endl;
+  std::cout << "\tBackground = " << skipped_background_ * 100.0 << " %"
+            << std::endl;
+  std::cout << "\tSub-pixel radius = " << skipped_sub_pixel_ * 100.0 << " %"
+            << std::endl;
+  if (streamer_.open()) streamer_.Print(&std::cout);
+  if (adaptive_ao_) {
+    std::cout << "Adaptive AO" << std::endl;
+    std::cout << "\tRefined = " << adaptive_refined_ * 100.0 << " %" << std::endl;
+    std::cout << "\tSamples per pixel = " << adaptive_samples_ << " (full "
+              << adaptive_full_samples_ << ")" << std::endl;
+  }
+  if (dynamic_resolution_) {
+    std::cout << "Dynamic resolution" << std::endl;
+    std::cout << "\tRender scale = " << resolution_.scale() << " (" << width_ << "x" << height_
+              << ")" << std::endl;
+    std::cout << "\tAO steps = " << CurrentAoParameters().steps << std::endl;
+  }
+}
+
+bool GLWidget::RenderTiled(const QString &filename, int width, int height) {
+  if (!initialized_ || !HasGeometry() || width <= 0 || height <= 0) return false;
+  SynchronousRendering synchronous(this);
+
+  std::ofstream out(filename.toUtf8().constData(), std::ios_base::out | std::ios_base::binary);
+  if (!out.is_open()) return false;
+  out << "P5\n" << width << " " << height << "\n255\n";
+
+  makeCurrent();
+
+  const Eigen::Matrix4f kView = camera_.SetView();
+  const Eigen::Matrix4f kModel = camera_.SetModel();
+  const Eigen::Matrix4f kProjection = camera_.SetProjection();
+  const float kNear = kProjection(2, 3) / (kProjection(2, 2) - 1.0f);
+
+  // Extent of the whole image at unit distance.
+  const float kHalfY = 1.0f / kProjection(1, 1);
+  const float kHalfX = kHalfY * static_cast<float>(width) / static_cast<float>(height);
+
+  const size_t kTechnique = ActiveAoTechnique();
+  const data_visualization::AoTechnique &kAoTechnique = ao_techniques_.Get(kTechnique);
+  const data_visualization::AoParameters kParameters = {hbao_directions, hbao_steps, hbao_radius,
+                                                        hbao_t_bias, hbao_strength};
+
+  // Guard band: the AO radius projected at the nearest point of the model,
+  // plus the reach of the blur.
+  const Eigen::Vector3f kMin = streamer_.open() ? streamer_.mesh().min_ : scene_.min_;
+  const Eigen::Vector3f kMax = streamer_.open() ? streamer_.mesh().max_ : scene_.max_;
+  float nearest = std::numeric_limits<float>::max();
+  for (int i = 0; i < 8; ++i) {
+    const Eigen::Vector4f kCorner((i & 1) ? kMax[0] : kMin[0], (i & 2) ? kMax[1] : kMin[1],
+                                  (i & 4) ? kMax[2] : kMin[2], 1.0f);
+    nearest = std::min(nearest, -(kView * kModel * kCorner)[2]);
+  }
+  nearest = std::max(nearest, kNear);
+  const float kRadiusPixels = hbao_radius * kProjection(1, 1) * 0.5f * height / nearest;
+  int guard = static_cast<int>(std::ceil(kRadiusPixels)) + kBlurRadius * static_cast<int>(blur_);
+  if (guard > kMaxGuardBand) {
+    std::cerr << "Guard band clamped from " << guard << " to " << kMaxGuardBand
+              << " pixels, the AO near the tile edges is approximate" << std::endl;
+    guard = kMaxGuardBand;
+  }
+
+  // Targets for the largest tile.
+  const GLsizei kTargetSide = kRenderTile + 2 * guard;
+  const bool kLinearZUsed = kAoTechnique.Resources().linear_z;
+  data_visualization::RenderTarget *g_target = target_pool_.Acquire(kTargetSide, kTargetSide, GL_RGBA32F, true);
+  data_visualization::RenderTarget *ao_target = target_pool_.Acquire(kTargetSide, kTargetSide, GL_RGBA16F, true);
+  data_visualization::RenderTarget *linear_z_target =
+      kLinearZUsed ? target_pool_.Acquire(kTargetSide, kTargetSide, GL_R32F, false) : nullptr;
+  data_visualization::RenderTarget *blur_targets[2] = {nullptr, nullptr};
+  if (blur_ > 0) {
+    blur_targets[0] = target_pool_.Acquire(kTargetSide, kTargetSide, GL_RGBA16F, false);
+    blur_targets[1] = target_pool_.Acquire(kTargetSide, kTargetSide, GL_RGBA16F, false);
+  }
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+  // Rows of tiles from the top, the PGM rows go downwards.
+  std::vector<unsigned char> band;
+  std::vector<unsigned char> tile;
+  const int kBands = (height + kRenderTile - 1) / kRenderTile;
+  for (int b = kBands - 1; b >= 0; --b) {
+    const int kY0 = b * kRenderTile;
+    const int kY1 = std::min(height, kY0 + kRenderTile);
+    band.assign(static_cast<size_t>(width) * (kY1 - kY0), 0);
+
+    for (int x0 = 0; x0 < width; x0 += kRenderTile) {
+      const int kX1 = std::min(width, x0 + kRenderTile);
+
+      // Rendered region. There is nothing to sample beyond the image edges.
+      const int kRX0 = std::max(0, x0 - guard);
+      const int kRY0 = std::max(0, kY0 - guard);
+      const int kRX1 = std::min(width, kX1 + guard);
+      const int kRY1 = std::min(height, kY1 + guard);
+      const int kRW = kRX1 - kRX0;
+      const int kRH = kRY1 - kRY0;
+
+      // Off-axis frustum of the region, at unit distance.
+      const float kLeft = (2.0f * kRX0 / width - 1.0f) * kHalfX;
+      const float kRight = (2.0f * kRX1 / width - 1.0f) * kHalfX;
+      const float kBottom = (2.0f * kRY0 / height - 1.0f) * kHalfY;
+      const float kTop = (2.0f * kRY1 / height - 1.0f) * kHalfY;
+
+      Eigen::Matrix4f projection = kProjection;
+      projection(0, 0) = 2.0f / (kRight - kLeft);
+      projection(0, 2) = (kRight + kLeft) / (kRight - kLeft);
+      projection(1, 1) = 2.0f / (kTop - kBottom);
+      projection(1, 2) = (kTop + kBottom) / (kTop - kBottom);
+
+      data_visualization::AoFrame frame;
+      frame.projection = projection;
+      frame.tan_half_fov = (kTop - kBottom) * 0.5f;
+      frame.aspect_ratio = (kRight - kLeft) / (kTop - kBottom);
+      frame.ray_center[0] = (kRight + kLeft) * 0.5f;
+      frame.ray_center[1] = (kTop + kBottom) * 0.5f;
+      frame.pixel_size[0] = 1.0f / kRW;
+      frame.pixel_size[1] = 1.0f / kRH;
+      frame.pixel_offset[0] = kRX0;
+      frame.pixel_offset[1] = kRY0;
+      frame.uv_scale[0] = static_cast<float>(kRW) / g_target->width;
+      frame.uv_scale[1] = static_cast<float>(kRH) / g_target->height;
+      frame.viewport_width = kRW;
+      frame.viewport_height = kRH;
+
+      if (streamer_.open()) {
+        const Eigen::Matrix4f kModelViewProjection = projection * kView * kModel;
+        do {
+          streamer_.Update(kModelViewProjection);
+        } while (streamer_.pending() > 0);
+      }
+
+      glViewport(0, 0, kRW, kRH);
+
+      glBindFramebuffer(GL_FRAMEBUFFER, g_target->fbo);
+      DrawGBuffer(projection, kView, kModel);
+      glDisable(GL_DEPTH_TEST);
+
+      if (kLinearZUsed) {
+        glBindFramebuffer(GL_FRAMEBUFFER, linear_z_target->fbo);
+        linear_z_program_->bind();
+        glUniformMatrix4fv(linear_z_program_->uniformLocation("projection"), 1, GL_FALSE, projection.data());
+        glActiveTexture(GL_TEXTURE0 + 0);
+        glBindTexture(GL_TEXTURE_2D, g_target->texture);
+        glUniform1i(linear_z_program_->uniformLocation("normalDepthTexture"), 0);
+        DrawQuad();
+      }
+
+      const bool kMasked = !kAoTechnique.Resources().compute;
+      if (kMasked) {
+        CopyStencil(g_target->fbo, ao_target->fbo, kRW, kRH);
+        glBindFramebuffer(GL_FRAMEBUFFER, ao_target->fbo);
+
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // Background AO.
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_EQUAL, kStencilGeometry, kStencilGeometry);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+      }
+
+      RenderAo(kTechnique, frame, kParameters, g_target->texture,
+               kLinearZUsed ? linear_z_target->texture : 0, ao_target->texture, false);
+
+      if (kMasked) glDisable(GL_STENCIL_TEST);
+
+      data_visualization::RenderTarget *result = ao_target;
+      for (unsigned int i = 0; i < blur_ * 2; ++i) {
+        data_visualization::RenderTarget *output = blur_targets[i % 2];
+        glBindFramebuffer(GL_FRAMEBUFFER, output->fbo);
+
+        blur_program_->bind();
+        glActiveTexture(GL_TEXTURE0 + 0);
+        glBindTexture(GL_TEXTURE_2D, result->texture);
+        glUniform1i(blur_program_->uniformLocation("normalDepthTexture"), 0);
+        glUniform2f(blur_program_->uniformLocation("uv_scale"), frame.uv_scale[0], frame.uv_scale[1]);
+        glUniform1i(blur_program_->uniformLocation("h"), i % 2 == 0);
+
+        DrawQuad();
+        result = output;
+      }
+
+      // The tile without its guard band, flipped into the band rows.
+      const int kTileW = kX1 - x0;
+      const int kTileH = kY1 - kY0;
+      tile.resize(static_cast<size_t>(kTileW) * kTileH);
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, result->fbo);
+      glReadPixels(x0 - kRX0, kY0 - kRY0, kTileW, kTileH, GL_RED, GL_UNSIGNED_BYTE, tile.data());
+
+      for (int row = 0; row < kTileH; ++row)
+        std::copy_n(&tile[static_cast<size_t>(kTileH - 1 - row) * kTileW], kTileW,
+                    &band[static_cast<size_t>(row) * width + x0]);
+    }
+
+    out.write(reinterpret_cast<const char *>(band.data()), static_cast<std::streamsize>(band.size()));
+    std::cout << "Tiled render: " << kBands - b << " / " << kBands << " rows" << std::endl;
+  }
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  std::cout << "Tiled render" << std::endl;
+  std::cout << "\tSize = " << width << "x" << height << std::endl;
+  std::cout << "\tTile = " << kRenderTile << " + " << guard << " guard band" << std::endl;
+  std::cout << "\tTarget side = " << g_target->width << std::endl;
+
+  target_pool_.Release(g_target);
+  target_pool_.Release(ao_target);
+  target_pool_.Release(linear_z_target);
+  target_pool_.Release(blur_targets[0]);
+  target_pool_.Release(blur_targets[1]);
+  target_pool_.Trim();
+
+  // Paging for the tiles changed the resident pages of the view.
+  RequestRedraw();
+
+  return static_cast<bool>(out);
+}
+
+void GLWidget::DrawQuad() const {
+  glBindVertexArray(quad_vao_);
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  glBindVertexArray(0);
+}
+
+void GLWidget::InvalidatePasses() {
+  g_pass_.Invalidate();
+  ao_pass_.Invalidate();
+  blur_pass_.Invalidate();
+}
+
+void GLWidget::RecordKeyframe() {
+  if (recording_)
+    camera_path_.AddKeyframe(record_timer_.elapsed() / 1000.0,
+                             camera_.GetState());
 }
 
 void GLWidget::initializeGL() {
@@ -184,12 +1993,20 @@ void GLWidget::initializeGL() {
   bool res = LoadProgram(g_vert_file, g_frag_file, *g_program_);
   blur_program_ = new QOpenGLShaderProgram();
   res &= LoadProgram(blur_vert_file, blur_frag_file, *blur_program_);
-  hbao_program_ = new QOpenGLShaderProgram();
-  res &= LoadProgram(hbao_vert_file, hbao_frag_file, *hbao_program_);
   depth_program_ = new QOpenGLShaderProgram();
   res &= LoadProgram(depth_vert_file, depth_frag_file, *depth_program_);
   normal_program_ = new QOpenGLShaderProgram();
   res &= LoadProgram(normal_vert_file, normal_frag_file, *normal_program_);
+  classify_program_ = new QOpenGLShaderProgram();
+  res &= LoadProgram(classify_vert_file, classify_frag_file, *classify_program_);
+  linear_z_program_ = new QOpenGLShaderProgram();
+  res &= LoadProgram(linear_z_vert_file, linear_z_frag_file, *linear_z_program_);
+
+  compute_supported_ = GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+  gather_supported_ = GLEW_VERSION_4_0 || GLEW_ARB_texture_gather;
+  multi_draw_supported_ = GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+  res &= LoadAoPrograms();
+  LoadMultiViewPrograms();
 
   if (!res) exit(0);
 
@@ -211,84 +2028,134 @@ void GLWidget::initializeGL() {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  load_noise_image("../../res/textures/noise.png"); // http://momentsingraphics.de/BlueNoise.html
+  load_noise_image(noise_file); // http://momentsingraphics.de/BlueNoise.html
+
+  glGenTextures(1, &direction_texture_);
+  glBindTexture(GL_TEXTURE_2D, direction_texture_);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  load_direction_image(noise_file);
+
+  noise_bytes_ = TextureBytes(noise_texture_, 2) + TextureBytes(direction_texture_, 6);
+
+  glGenQueries(1, &adaptive_query_);
 
   if (!LoadModel("../../res/models/ao_1.ply")) {
     std::cerr << "Model not found" << std::endl;
     exit(1);
   }
 
-  assert(COLOR_FBOS >= 0);
-  unsigned int size = static_cast<unsigned int>(COLOR_FBOS);
-  c_fbo_ = new GLuint[size];
-  c_textures_ = new GLuint[size];
-
   initialized_ = true;
 }
 
 void GLWidget::resizeGL(int w, int h) {
   if (h == 0) h = 1;
-  width_ = w;
-  height_ = h;
+  gui_state_.window_width = w;
+  gui_state_.window_height = h;
 
   camera_.SetViewport(0, 0, w, h);
   camera_.SetProjection(kFieldOfView, kZNear, kZFar);
 
-  aspect_ratio = w / h;
-  tan_half_fov = static_cast<GLfloat>(tan((kFieldOfView / 2.0) * (M_PI / 180.0)));
+  // While the new size fits in the current targets, render to a viewport
+  // subrect of them and only reallocate once the resizing settles.
+  ResizeViewport(w, h);
+  resize_timer_.start();
+}
+
+void GLWidget::resizeEvent(QResizeEvent *event) {
+  if (!threaded_rendering()) {
+    QGLWidget::resizeEvent(event);
+    return;
+  }
+
+  const int kWidth = event->size().width();
+  const int kHeight = std::max(1, event->size().height());
+  gui_state_.window_width = kWidth;
+  gui_state_.window_height = kHeight;
 
-  pixel_size.x = 1.0f / w;
-  pixel_size.y = 1.0f / h;
+  camera_.SetViewport(0, 0, kWidth, kHeight);
+  camera_.SetProjection(kFieldOfView, kZNear, kZFar);
+  PublishState();
+  resize_timer_.start();
+}
+
+void GLWidget::paintEvent(QPaintEvent *event) {
+  if (!threaded_rendering()) QGLWidget::paintEvent(event);
+}
 
-  if (resized_) {
-    glDeleteFramebuffers(1, &g_fbo_);
-    glDeleteRenderbuffers(1, &g_rbo_);
-    glDeleteTextures(1, &g_normal_depth_texture_);
+void GLWidget::ResizeViewport(int w, int h) {
+  window_width_ = w;
+  window_height_ = h;
 
-    glDeleteFramebuffers(COLOR_FBOS, c_fbo_);
-    glDeleteTextures(COLOR_FBOS, c_textures_);
+  aspect_ratio = static_cast<GLfloat>(w) / static_cast<GLfloat>(h);
+  tan_half_fov = static_cast<GLfloat>(tan((kFieldOfView / 2.0) * (M_PI / 180.0)));
+
+  ApplyRenderScale();
+  InvalidatePasses();
+}
+
+void GLWidget::ApplyRenderScale() {
+  const double kScale = dynamic_resolution_ ? resolution_.scale() : 1.0;
+  width_ = std::max(1.0f, std::round(window_width_ * static_cast<float>(kScale)));
+  height_ = std::max(1.0f, std::round(window_height_ * static_cast<float>(kScale)));
+
+  pixel_size.x = 1.0f / width_;
+  pixel_size.y = 1.0f / height_;
+
+  // Scaling down keeps the window sized targets, so that changing the scale
+  // never allocates.
+  if (g_target_ != nullptr && width_ <= g_target_->width && height_ <= g_target_->height) {
+    uv_scale_.x = width_ / g_target_->width;
+    uv_scale_.y = height_ / g_target_->height;
+  } else {
+    AllocateRenderTargets();
   }
+}
+
+void GLWidget::AllocateRenderTargets() {
+  const GLsizei kWidth = static_cast<GLsizei>(width_);
+  const GLsizei kHeight = static_cast<GLsizei>(height_);
+
+  target_pool_.Release(g_target_);
+  target_pool_.Release(ao_target_);
+  target_pool_.Release(blur_target_);
 
   // G buffer
-  glGenFramebuffers(1, &g_fbo_);
-  glBindFramebuffer(GL_FRAMEBUFFER, g_fbo_);
+  g_target_ = target_pool_.Acquire(kWidth, kHeight, GL_RGBA32F, true);
 
-  glGenTextures(1, &g_normal_depth_texture_);
-  glBindTexture(GL_TEXTURE_2D, g_normal_depth_texture_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_normal_depth_texture_, 0);
+  // AO buffer, kept between frames so that it can be reused by the blur. Its
+  // stencil holds the geometry mask and the tiles refined by the adaptive AO.
+  ao_target_ = target_pool_.Acquire(kWidth, kHeight, GL_RGBA16F, true);
 
-  glGenRenderbuffers(1, &g_rbo_);
-  glBindRenderbuffer(GL_RENDERBUFFER, g_rbo_);
-  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
-  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, g_rbo_);
+  // Blur output, also kept between frames. The intermediate blur passes use
+  // transient targets of the render graph.
+  blur_target_ = target_pool_.Acquire(kWidth, kHeight, GL_RGBA16F, false);
 
-  // Color buffers, used for post processing
-  glGenFramebuffers(COLOR_FBOS, c_fbo_);
+  uv_scale_.x = width_ / g_target_->width;
+  uv_scale_.y = height_ / g_target_->height;
+  UpdateMemoryStats();
+}
 
-  glGenTextures(COLOR_FBOS, c_textures_);
-  for (GLsizei i = 0; i < COLOR_FBOS; ++i) {
-    glBindFramebuffer(GL_FRAMEBUFFER, c_fbo_[i]);
-    glBindTexture(GL_TEXTURE_2D, c_textures_[i]);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, c_textures_[i], 0);
-  }
+void GLWidget::SettleRenderTargets() {
+  if (!initialized_) return;
 
-  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-    std::cout << "Framebuffer is not complete!" << glGetError() << std::endl;
+  // The targets belong to the render thread, it settles them before its next
+  // frame.
+  if (threaded_rendering()) {
+    settle_pending_.store(true, std::memory_order_relaxed);
+    render_thread_->Wake();
+    return;
   }
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  makeCurrent();
+  AllocateRenderTargets();
+  target_pool_.Trim();
+  UpdateMemoryStats();
 
-  resized_ = true;
+  InvalidatePasses();
+  update();
 }
 
 void GLWidget::mousePressEvent(QMouseEvent *event) {
@@ -298,14 +2165,16 @@ void GLWidget::mousePressEvent(QMouseEvent *event) {
   if (event->button() == Qt::RightButton) {
     camera_.StartZooming(event->x(), event->y());
   }
-  updateGL();
+  RecordKeyframe();
+  RequestFrame(event);
 }
 
 void GLWidget::mouseMoveEvent(QMouseEvent *event) {
   camera_.SetRotationX(event->y());
   camera_.SetRotationY(event->x());
   camera_.SafeZoom(event->y());
-  updateGL();
+  RecordKeyframe();
+  RequestFrame(event);
 }
 
 void GLWidget::mouseReleaseEvent(QMouseEvent *event) {
@@ -315,7 +2184,8 @@ void GLWidget::mouseReleaseEvent(QMouseEvent *event) {
   if (event->button() == Qt::RightButton) {
     camera_.StopZooming(event->x(), event->y());
   }
-  updateGL();
+  RecordKeyframe();
+  RequestFrame(event);
 }
 
 void GLWidget::keyPressEvent(QKeyEvent *event) {
@@ -332,33 +2202,46 @@ void GLWidget::keyPressEvent(QKeyEvent *event) {
   if (event->key() == Qt::Key_D) camera_.Rotate(1);
 
   if (event->key() == Qt::Key_R) {
+    SynchronousRendering synchronous(this);
+    makeCurrent();
     delete g_program_;
     g_program_ = new QOpenGLShaderProgram();
     LoadProgram(g_vert_file, g_frag_file, *g_program_);
     delete blur_program_;
     blur_program_ = new QOpenGLShaderProgram();
     LoadProgram(blur_vert_file, blur_frag_file, *blur_program_);
-    delete hbao_program_;
-    hbao_program_ = new QOpenGLShaderProgram();
-    LoadProgram(hbao_vert_file, hbao_frag_file, *hbao_program_);
     delete depth_program_;
     depth_program_ = new QOpenGLShaderProgram();
     LoadProgram(depth_vert_file, depth_frag_file, *depth_program_);
     delete normal_program_;
     normal_program_ = new QOpenGLShaderProgram();
     LoadProgram(normal_vert_file, normal_frag_file, *normal_program_);
+    delete classify_program_;
+    classify_program_ = new QOpenGLShaderProgram();
+    LoadProgram(classify_vert_file, classify_frag_file, *classify_program_);
+    delete linear_z_program_;
+    linear_z_program_ = new QOpenGLShaderProgram();
+    LoadProgram(linear_z_vert_file, linear_z_frag_file, *linear_z_program_);
+    LoadAoPrograms();
+    LoadMultiViewPrograms();
+
+    InvalidatePasses();
   }
 
-  updateGL();
+  RecordKeyframe();
+  RequestFrame(event);
 }
 
 void GLWidget::paintGL() {
   if (initialized_) {
-    camera_.SetViewport();
+    // The camera viewport is the window, the passes render at the internal
+    // resolution.
+    glViewport(0, 0, static_cast<GLsizei>(width_), static_cast<GLsizei>(height_));
 
-    Eigen::Matrix4f projection = camera_.SetProjection();
-    Eigen::Matrix4f view = camera_.SetView();
-    Eigen::Matrix4f model = camera_.SetModel();
+    const data_visualization::Camera &kCamera = threaded_rendering() ? render_camera_ : camera_;
+    Eigen::Matrix4f projection = kCamera.SetProjection();
+    Eigen::Matrix4f view = kCamera.SetView();
+    Eigen::Matrix4f model = kCamera.SetModel();
 
 //    Eigen::Matrix4f t = view * model;
 //    Eigen::Matrix3f normal;
@@ -366,102 +2249,247 @@ void GLWidget::paintGL() {
 //      for (int j = 0; j < 3; ++j) normal(i, j) = t(i, j);
 //    normal = normal.inverse().transpose();
 
-    if (mesh_ != nullptr) {
+    if (HasGeometry() && views_ > 1) {
+      RenderMultiView(projection, view, model);
+    } else if (HasGeometry()) {
+      typedef data_visualization::RenderGraph::Resource Resource;
+
+      gpu_timer_.BeginFrame();
+
+      data_visualization::RenderGraph graph(&target_pool_, g_target_->width, g_target_->height);
+      const Resource kGBuffer = graph.Import("g_buffer", g_target_);
+      const Resource kAo = graph.Import("ao", ao_target_);
+      const Resource kBlurred = graph.Import("blurred", blur_target_);
+      const Resource kDepthView = graph.Create("depth_view", GL_RGBA16F);
+      const Resource kNormalView = graph.Create("normal_view", GL_RGBA16F);
+      const Resource kBackbuffer = graph.Backbuffer();
+
       // G Pass
-      glBindFramebuffer(GL_FRAMEBUFFER, g_fbo_);
+      data_visualization::PassInputs g_inputs;
+      g_inputs.Add(projection).Add(view).Add(model);
+      g_inputs.Add(scene_version_).Add(width_).Add(height_);
+      if (streamer_.open()) {
+        streamer_.Update(projection * view * model);
+        g_inputs.Add(streamer_.version());
+      }
+      const bool kGDirty = g_pass_.Dirty(g_inputs);
+      const unsigned int kGVersion = g_pass_.version() + (kGDirty ? 1 : 0);
+
+      graph.AddPass("g", {}, {kGBuffer}, !kGDirty, [&]() {
+        glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kGBuffer));
+        DrawGBuffer(projection, view, model);
+        g_pass_.Commit(g_inputs);
+      });
+
+      // AO Pass
+      const size_t kTechnique = ActiveAoTechnique();
+      const data_visualization::AoTechnique &kAoTechnique = ao_techniques_.Get(kTechnique);
+      const data_visualization::AoParameters kAoParameters = CurrentAoParameters();
+      const bool kAdaptive = adaptive_ao_ && !kAoTechnique.Resources().compute;
+
+      data_visualization::PassInputs ao_inputs;
+      ao_inputs.Add(kGVersion).Add(kTechnique).Add(kAdaptive);
+      ao_inputs.Add(hbao_directions).Add(kAoParameters.steps);
+      ao_inputs.Add(hbao_radius).Add(hbao_t_bias).Add(hbao_strength);
+      const bool kAoDirty = ao_pass_.Dirty(ao_inputs);
+      const unsigned int kAoVersion = ao_pass_.version() + (kAoDirty ? 1 : 0);
+
+      // Single channel view space z for the techniques that gather it. Culled
+      // when no AO pass reads it.
+      const Resource kLinearZ = graph.Create("linear_z", GL_R32F);
+      const bool kLinearZUsed = kAoTechnique.Resources().linear_z;
+      std::vector<Resource> ao_reads = {kGBuffer};
+      if (kLinearZUsed) ao_reads.push_back(kLinearZ);
+
+      graph.AddPass("linear_z", {kGBuffer}, {kLinearZ}, false, [&]() {
+        glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kLinearZ));
+        glDisable(GL_DEPTH_TEST);
+
+        linear_z_program_->bind();
+        glUniformMatrix4fv(linear_z_program_->uniformLocation("projection"), 1, GL_FALSE, projection.data());
+        glActiveTexture(GL_TEXTURE0 + 0);
+        glBindTexture(GL_TEXTURE_2D, graph.Texture(kGBuffer));
+        glUniform1i(linear_z_program_->uniformLocation("normalDepthTexture"), 0);
+
+        DrawQuad();
+      });
+
+      if (kAdaptive) {
+        // Coarse AO, then refinement of the complex tiles only.
+        const Resource kCoarse = graph.Create("coarse_ao", GL_RGBA16F);
+
+        graph.AddPass(kAoTechnique.Name() + "_coarse", ao_reads, {kCoarse}, !kAoDirty, [&]() {
+          glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kCoarse));
+          glDisable(GL_DEPTH_TEST);
+          RenderAo(kTechnique, CurrentAoFrame(projection), CoarseAoParameters(kAoParameters), graph.Texture(kGBuffer),
+                   kLinearZUsed ? graph.Texture(kLinearZ) : 0, 0, false);
+        });
+
+        graph.AddPass("ao_classify", {kGBuffer, kCoarse}, {kAo}, !kAoDirty, [&]() {
+          ClassifyAoTiles(projection, graph.Fbo(kCoarse), graph.Texture(kCoarse), graph.Fbo(kGBuffer),
+                          graph.Texture(kGBuffer), graph.Fbo(kAo));
+        });
+
+        std::vector<Resource> refine_reads = ao_reads;
+        refine_reads.push_back(kAo);
+        graph.AddPass(kAoTechnique.Name(), refine_reads, {kAo}, !kAoDirty, [&]() {
+          glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kAo));
+          glDisable(GL_DEPTH_TEST);
+          glEnable(GL_STENCIL_TEST);
+          glStencilFunc(GL_EQUAL, kStencilGeometry | kStencilRefine, kStencilGeometry | kStencilRefine);
+          glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+          CollectAdaptiveStats(false);
+          const bool kQuery = !adaptive_query_pending_;
+          if (kQuery) glBeginQuery(GL_SAMPLES_PASSED, adaptive_query_);
+          RenderAo(kTechnique, CurrentAoFrame(projection), kAoParameters, graph.Texture(kGBuffer),
+                   kLinearZUsed ? graph.Texture(kLinearZ) : 0, graph.Texture(kAo), false);
+          if (kQuery) {
+            glEndQuery(GL_SAMPLES_PASSED);
+            adaptive_query_pending_ = true;
+            adaptive_query_samples_[0] = kAoTechnique.Samples(CoarseAoParameters(kAoParameters));
+            adaptive_query_samples_[1] = kAoTechnique.Samples(kAoParameters);
+          }
+
+          glDisable(GL_STENCIL_TEST);
+          ao_pass_.Commit(ao_inputs);
+        });
+      } else {
+        graph.AddPass(kAoTechnique.Name(), ao_reads, {kAo}, !kAoDirty, [&]() {
+          // Compute techniques skip the background in the shader.
+          const bool kMasked = !kAoTechnique.Resources().compute;
+          if (kMasked) {
+            CopyStencil(graph.Fbo(kGBuffer), graph.Fbo(kAo), static_cast<GLint>(width_), static_cast<GLint>(height_));
+            glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kAo));
+
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // Background AO.
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            glDisable(GL_DEPTH_TEST);
+            glEnable(GL_STENCIL_TEST);
+            glStencilFunc(GL_EQUAL, kStencilGeometry, kStencilGeometry);
+            glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+          }
+
+          RenderAo(kTechnique, CurrentAoFrame(projection), kAoParameters, graph.Texture(kGBuffer),
+                   kLinearZUsed ? graph.Texture(kLinearZ) : 0, graph.Texture(kAo), false);
 
-      glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+          if (kMasked) glDisable(GL_STENCIL_TEST);
+          ao_pass_.Commit(ao_inputs);
+        });
+      }
 
-      glEnable(GL_DEPTH_TEST);
+      // Debug views. Cheap, so they are not cached.
+      graph.AddPass("depth", {kGBuffer}, {kDepthView}, false, [&]() {
+        glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kDepthView));
+        glDisable(GL_DEPTH_TEST);
 
-      g_program_->bind();
-      glUniformMatrix4fv(g_program_->uniformLocation("projection"), 1, GL_FALSE, projection.data());
-      glUniformMatrix4fv(g_program_->uniformLocation("view"), 1, GL_FALSE, view.data());
-      glUniformMatrix4fv(g_program_->uniformLocation("model"), 1, GL_FALSE, model.data());
-//      glUniformMatrix3fv(g_program_->uniformLocation("normal_matrix"), 1, GL_FALSE, normal.data());
+        depth_program_->bind();
+        glUniform2f(depth_program_->uniformLocation("uv_scale"), uv_scale_[0], uv_scale_[1]);
+        glActiveTexture(GL_TEXTURE0 + 0);
+        glBindTexture(GL_TEXTURE_2D, graph.Texture(kGBuffer));
+        glUniform1i(depth_program_->uniformLocation("normalDepthTexture"), 0);
 
-      // Draw model
-      glBindVertexArray(vao_);
-      assert(mesh_->faces_.size() <= std::numeric_limits<std::vector<int>::size_type>::max());
-      glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh_->faces_.size()), GL_UNSIGNED_INT, nullptr);
-      glBindVertexArray(0);
+        DrawQuad();
+      });
 
-      bool h = true;
-      if (blur_ > 0) {
-        glBindFramebuffer(GL_FRAMEBUFFER, c_fbo_[h]);
+      graph.AddPass("normal", {kGBuffer}, {kNormalView}, false, [&]() {
+        glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kNormalView));
+        glDisable(GL_DEPTH_TEST);
+
+        normal_program_->bind();
+        glUniform2f(normal_program_->uniformLocation("uv_scale"), uv_scale_[0], uv_scale_[1]);
+        glActiveTexture(GL_TEXTURE0 + 0);
+        glBindTexture(GL_TEXTURE_2D, graph.Texture(kGBuffer));
+        glUniform1i(normal_program_->uniformLocation("normalDepthTexture"), 0);
+
+        DrawQuad();
+      });
+
+      const Resource kViews[] = {kAo, kDepthView, kNormalView};
+      const Resource kView = kViews[ao_program_];
+
+      // With a single blur iteration of the AO, techniques with a fused shader
+      // render the AO and blur it in one dispatch. Nothing reads kAo then, so
+      // the AO pass is culled.
+      const bool kFusedBlur = fused_blur_ && blur_ == 1 && ao_program_ == 0 && !kAdaptive &&
+                              fused_programs_[kTechnique] != nullptr;
+
+      // Blur. The intermediate passes write transient resources, which the
+      // graph aliases into two targets. Culled when blur_ is 0.
+      data_visualization::PassInputs blur_inputs;
+      if (kFusedBlur) {
+        blur_inputs = ao_inputs;
+        blur_inputs.Add(blur_).Add(kFusedBlur);
       } else {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        blur_inputs.Add(ao_program_).Add(ao_program_ == 0 ? kAoVersion : kGVersion);
+        blur_inputs.Add(blur_);
       }
+      const bool kBlurDirty = blur_pass_.Dirty(blur_inputs);
 
-      glClearColor(0.0f, 0.0f, 0.3f, 1.0f); // Not black!
-      glClear(GL_COLOR_BUFFER_BIT);
+      if (kFusedBlur) {
+        graph.AddPass(kAoTechnique.Name() + "_blur", {kGBuffer}, {kBlurred}, !kBlurDirty, [&]() {
+          RenderAo(kTechnique, CurrentAoFrame(projection), kAoParameters, graph.Texture(kGBuffer), 0, graph.Texture(kBlurred), true);
+          blur_pass_.Commit(blur_inputs);
+        });
+      }
 
-      glDisable(GL_DEPTH_TEST);
+      const unsigned int kBlurPasses = kFusedBlur ? 0 : std::max(blur_, 1u) * 2;
+      Resource blur_input = kView;
+      for (unsigned int i = 0; i < kBlurPasses; ++i) {
+        const bool kLast = i + 1 == kBlurPasses;
+        const Resource kInput = blur_input;
+        const Resource kOutput = kLast ? kBlurred : graph.Create("blur", GL_RGBA16F);
 
-      switch (ao_program_) {
-        case 0: {
-          hbao_program_->bind();
-          glUniformMatrix4fv(hbao_program_->uniformLocation("projection"), 1, GL_FALSE, projection.data());
-          glUniform1f(hbao_program_->uniformLocation("aspect_ratio"), aspect_ratio);
-          glUniform1f(hbao_program_->uniformLocation("tan_half_fov"), tan_half_fov);
-          glUniform2f(hbao_program_->uniformLocation("pixel_size"), pixel_size[0], pixel_size[1]);
-          glUniform1i(hbao_program_->uniformLocation("directions"), hbao_directions);
-          glUniform1i(hbao_program_->uniformLocation("steps"), hbao_steps);
-          glUniform1f(hbao_program_->uniformLocation("radius"), hbao_radius);
-          glUniform1f(hbao_program_->uniformLocation("t_bias"), hbao_t_bias);
-          glUniform1f(hbao_program_->uniformLocation("strength"), hbao_strength);
+        graph.AddPass("blur", {kInput}, {kOutput}, kLast && !kBlurDirty, [&, i, kLast, kInput, kOutput]() {
+          glBindFramebuffer(GL_FRAMEBUFFER, graph.Fbo(kOutput));
+          glDisable(GL_DEPTH_TEST);
 
+          blur_program_->bind();
           glActiveTexture(GL_TEXTURE0 + 0);
-          glBindTexture(GL_TEXTURE_2D, g_normal_depth_texture_);
-          glUniform1i(hbao_program_->uniformLocation("normalDepthTexture"), 0);
-          glActiveTexture(GL_TEXTURE0 + 1);
-          glBindTexture(GL_TEXTURE_2D, noise_texture_);
-          glUniform1i(hbao_program_->uniformLocation("noise_texture"), 1);
-          break;
-        }
-      case 1: {
-          depth_program_->bind();
-          glActiveTexture(GL_TEXTURE0 + 0);
-          glBindTexture(GL_TEXTURE_2D, g_normal_depth_texture_);
-          glUniform1i(hbao_program_->uniformLocation("normalDepthTexture"), 0);
-          break;
-        }
-      case 2: {
-          normal_program_->bind();
-          glActiveTexture(GL_TEXTURE0 + 0);
-          glBindTexture(GL_TEXTURE_2D, g_normal_depth_texture_);
-          glUniform1i(hbao_program_->uniformLocation("normalDepthTexture"), 0);
-          break;
-        }
+          glBindTexture(GL_TEXTURE_2D, graph.Texture(kInput));
+          glUniform1i(blur_program_->uniformLocation("normalDepthTexture"), 0);
+          glUniform2f(blur_program_->uniformLocation("uv_scale"), uv_scale_[0], uv_scale_[1]);
+          glUniform1i(blur_program_->uniformLocation("h"), i % 2 == 0);
+
+          DrawQuad();
+
+          if (kLast) blur_pass_.Commit(blur_inputs);
+        });
+
+        blur_input = kOutput;
       }
 
-      glBindVertexArray(quad_vao_);
-      glDrawArrays(GL_TRIANGLES, 0, 6);
-      glBindVertexArray(0);
+      // Present. Always runs, the back buffer is undefined after a swap.
+      // Upscales the internal resolution to the window.
+      const Resource kOutput = blur_ > 0 ? kBlurred : kView;
+      graph.AddPass("present", {kOutput}, {kBackbuffer}, false, [&]() {
+        const bool kScaled = width_ != window_width_ || height_ != window_height_;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.Fbo(kOutput));
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, graph.Fbo(kBackbuffer));
+        glBlitFramebuffer(0, 0, static_cast<GLint>(width_), static_cast<GLint>(height_),
+                          0, 0, static_cast<GLint>(window_width_), static_cast<GLint>(window_height_),
+                          GL_COLOR_BUFFER_BIT, kScaled ? GL_LINEAR : GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      });
 
-      if (blur_ > 0) { // Blur. Render to ping pong color framebuffers
-        glActiveTexture(GL_TEXTURE0 + 0);
-        glUniform1i(blur_program_->uniformLocation("normalDepthTexture"), 0);
+      graph.Execute(kBackbuffer, &gpu_timer_);
+      graph_stats_ = graph.stats();
 
-        unsigned int passes = blur_ * 2;
-        for (unsigned int i = 0; i < passes; ++i) {
-          if (i + 1 >= passes) {
-              glBindFramebuffer(GL_FRAMEBUFFER, 0);
-          } else {
-              glBindFramebuffer(GL_FRAMEBUFFER, c_fbo_[!h]);
-          }
-          glBindTexture(GL_TEXTURE_2D, c_textures_[h]);
-          blur_program_->bind();
-          glUniform1i(blur_program_->uniformLocation("h"), h);
+      // The graph only adds targets to the pool the first time a size is
+      // needed.
+      if (target_pool_.Targets() != accounted_targets_) UpdateMemoryStats();
 
-          glBindVertexArray(quad_vao_);
-          glDrawArrays(GL_TRIANGLES, 0, 6);
-          glBindVertexArray(0);
+      gpu_timer_.EndFrame();
 
-          h = !h;
-        }
+      if (dynamic_resolution_ && resolution_.Update(gpu_timer_.FrameMs())) {
+        ApplyRenderScale();
+        InvalidatePasses();
+        RequestRedraw();
       }
+
+      // Keeps drawing until the visible pages are resident.
+      if (streamer_.pending() > 0) RequestRedraw();
     } else {
       glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
       glClear(GL_COLOR_BUFFER_BIT);
@@ -471,51 +2499,66 @@ void GLWidget::paintGL() {
 
 void GLWidget::set_hbao(bool v) {
   if (v) {
-    ao_program_ = 0;
-    update();
+    gui_state_.ao_program = 0;
+    PublishState();
   }
 }
 
 void GLWidget::set_depth(bool v) {
   if (v) {
-    ao_program_ = 1;
-    update();
+    gui_state_.ao_program = 1;
+    PublishState();
   }
 }
 
 void GLWidget::set_normal(bool v) {
   if (v) {
-    ao_program_ = 2;
-    update();
+    gui_state_.ao_program = 2;
+    PublishState();
   }
 }
 
+void GLWidget::set_ao_technique(int technique) {
+  if (technique < 0 || static_cast<size_t>(technique) >= ao_techniques_.Size()) return;
+
+  gui_state_.ao_technique = static_cast<size_t>(technique);
+  if (initialized_ && ao_programs_[gui_state_.ao_technique] == nullptr)
+    std::cout << ao_techniques_.Get(gui_state_.ao_technique).Label() << " not available, using "
+              << ao_techniques_.Get(0).Label() << std::endl;
+  PublishState();
+}
+
+void GLWidget::set_adaptive_ao(bool v) {
+  gui_state_.adaptive_ao = v;
+  PublishState();
+}
+
 void GLWidget::set_blur(int amount) {
-  blur_ = static_cast<unsigned int>(amount);
-  update();
+  gui_state_.blur = static_cast<unsigned int>(amount);
+  PublishState();
 }
 
 void GLWidget::set_hbao_directions(int v) {
-  hbao_directions = v;
-  update();
+  gui_state_.directions = v;
+  PublishState();
 }
 
 void GLWidget::set_hbao_steps(int v) {
-  hbao_steps = v;
-  update();
+  gui_state_.steps = v;
+  PublishState();
 }
 
 void GLWidget::set_hbao_radius(double v) {
-  hbao_radius = static_cast<float>(v);
-  update();
+  gui_state_.radius = static_cast<float>(v);
+  PublishState();
 }
 
 void GLWidget::set_hbao_t_bias(double v) {
-  hbao_t_bias = static_cast<float>(v) * (M_PI / 180.0f);
-  update();
+  gui_state_.t_bias = static_cast<float>(v) * (M_PI / 180.0f);
+  PublishState();
 }
 
 void GLWidget::set_hbao_strength(double v) {
-  hbao_strength = static_cast<float>(v);
-  update();
+  gui_state_.strength = static_cast<float>(v);
+  PublishState();
 }
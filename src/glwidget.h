@@ -2,16 +2,39 @@
 #define GLWIDGET_H_
 
 #include <GL/glew.h>
+#include <QElapsedTimer>
 #include <QGLWidget>
 #include <QImage>
 #include <QMouseEvent>
 #include <QOpenGLShaderProgram>
 #include <QString>
+#include <QTimer>
+#include <atomic>
+#include <limits>
 #include <memory>
+#include <vector>
 #include <glm/glm.hpp>
 
+#include "./ao_technique.h"
 #include "./camera.h"
+#include "./camera_path.h"
+#include "./frame_pacer.h"
+#include "./frame_stats.h"
+#include "./gpu_timer.h"
+#include "./layered_target.h"
+#include "./memory_stats.h"
+#include "./page_streamer.h"
+#include "./pass_cache.h"
+#include "./render_graph.h"
+#include "./render_target_pool.h"
+#include "./render_thread.h"
+#include "./resolution_controller.h"
+#include "./scene.h"
+#include "./snapshot_mailbox.h"
 #include "./triangle_mesh.h"
+#ifdef HBAO_VULKAN
+#include "./vulkan_backend.h"
+#endif
 
 class GLWidget : public QGLWidget {
   Q_OBJECT
@@ -21,13 +44,229 @@ class GLWidget : public QGLWidget {
   ~GLWidget();
 
   /**
-   * @brief LoadModel Loads a PLY model at the filename path into the mesh_ data
-   * structure.
-   * @param filename Path to the PLY model.
+   * @brief LoadModel Loads a PLY model at the filename path into the scene_
+   * data structure, as its only instance. Paged meshes, see BuildPages, are
+   * streamed out of core instead.
+   * @param filename Path to the PLY model or paged mesh.
    * @return Whether it was able to load the model.
    */
   bool LoadModel(const QString &filename);
 
+  /**
+   * @brief LoadScene Loads a scene description, see ReadFromScene, into the
+   * scene_ arena.
+   * @param filename Path to the scene.
+   * @return Whether it was able to load the scene.
+   */
+  bool LoadScene(const QString &filename);
+
+  /**
+   * @brief StartRecording Clears the camera path and starts recording the
+   * camera state on every user interaction.
+   */
+  void StartRecording();
+
+  /**
+   * @brief StopRecording Stops recording the camera path.
+   */
+  void StopRecording();
+
+  /**
+   * @brief SaveCameraPath Stores the recorded camera path.
+   * @param filename Destination file.
+   * @return Whether it was able to store the file.
+   */
+  bool SaveCameraPath(const QString &filename) const;
+
+  /**
+   * @brief LoadCameraPath Loads a camera path to be replayed by RunBenchmark.
+   * @param filename Source file.
+   * @return Whether it was able to read the file.
+   */
+  bool LoadCameraPath(const QString &filename);
+
+  /**
+   * @brief RunBenchmark Replays the camera path at fixed timesteps and prints
+   * the per-frame timing histogram and stutter count.
+   * @return Whether there was a camera path to replay.
+   */
+  bool RunBenchmark();
+
+  /**
+   * @brief SetFrameCoalescing Selects whether input events only mark the frame
+   * dirty and let the paint events coalesce them (true), or render a full
+   * frame synchronously for every event (false).
+   * @param enabled Whether to coalesce input frames.
+   */
+  void SetFrameCoalescing(bool enabled);
+
+  /**
+   * @brief SetDynamicResolution Selects whether the internal resolution of
+   * the passes, and if needed the AO steps, follow the frame time budget.
+   * When disabled the passes render at the window size.
+   * @param enabled Whether to scale the resolution.
+   */
+  void SetDynamicResolution(bool enabled);
+
+  /**
+   * @brief SetFrameBudget Changes the GPU frame time budget of the dynamic
+   * resolution.
+   * @param ms Budget in milliseconds.
+   */
+  void SetFrameBudget(double ms);
+
+  double frame_budget() const { return resolution_.budget_ms(); }
+
+  /**
+   * @brief SetThreadedRendering Selects whether frames are rendered on a
+   * dedicated render thread, which owns the GL context and receives snapshots
+   * of the camera and the AO parameters, or on the GUI thread.
+   * @param enabled Whether to use the render thread.
+   */
+  void SetThreadedRendering(bool enabled);
+
+  bool threaded_rendering() const { return render_thread_ != nullptr; }
+
+  /**
+   * @brief SetWelding Selects whether the duplicated vertices of the loaded
+   * PLY meshes are merged, see WeldVertices. Applies to the next load.
+   * @param enabled Whether to weld.
+   */
+  void SetWelding(bool enabled) { welding_ = enabled; }
+
+  /**
+   * @brief SetWeldEpsilon Changes the largest distance between two welded
+   * vertices, 0 to only merge equal positions.
+   * @param epsilon Distance in model units.
+   */
+  void SetWeldEpsilon(float epsilon) { weld_options_.epsilon = epsilon; }
+
+  float weld_epsilon() const { return weld_options_.epsilon; }
+
+  /**
+   * @brief ReportInputLatency Prints the event-to-swap latency histogram of
+   * the frames triggered by input since the last report, the GUI thread
+   * timer intervals and the frame pacing waits.
+   */
+  void ReportInputLatency();
+
+  /**
+   * @brief ReportPassTimings Prints the GPU time of every render graph pass,
+   * the culling and aliasing of the last frame and the pixels of the current
+   * view skipped by the AO.
+   */
+  void ReportPassTimings();
+
+  /**
+   * @brief ReportMemory Prints the CPU and GPU memory of every resource and
+   * the peaks since the last report, and resets the peaks.
+   */
+  void ReportMemory();
+
+  /**
+   * @brief SetReleaseCpuGeometry Selects whether the CPU copy of the scene
+   * arena is freed once it is in the GPU buffers, keeping only the mesh
+   * ranges and bounding boxes. Enabling it frees the current copy, disabling
+   * it applies to the next load. Features that read the arena back, such as
+   * the Vulkan comparison, need the model to be loaded again.
+   * @param enabled Whether to free the CPU geometry.
+   */
+  void SetReleaseCpuGeometry(bool enabled);
+
+  /**
+   * @brief kMaxViews Largest number of views of a multi-view frame, see
+   * g_layered.geom.
+   */
+  static const int kMaxViews = 4;
+
+  /**
+   * @brief SetMultiView Selects how many views are rendered side by side,
+   * each one offset along the camera x axis. With more than one, a single
+   * draw renders the G buffer of every view into the layers of an array
+   * texture, and the compute HBAO and the blur process all the layers in one
+   * dispatch each, whatever the selected technique.
+   * @param views Number of views, from 1 to kMaxViews.
+   * @return Whether the views are supported, multi-view rendering needs
+   * compute shaders.
+   */
+  bool SetMultiView(int views);
+
+  int views() const { return views_; }
+
+  /**
+   * @brief RenderTiled Renders the AO of the current view at any resolution,
+   * in tiles with a guard band wide enough for the AO radius and the blur, and
+   * writes it as a binary PGM one row of tiles at a time. GPU memory only
+   * depends on the tile size.
+   * @param filename Destination file.
+   * @param width Image width.
+   * @param height Image height.
+   * @return Whether it was able to render and store the image.
+   */
+  bool RenderTiled(const QString &filename, int width, int height);
+
+  /**
+   * @brief RunRadiusBenchmark Measures the GPU time of the fragment and
+   * compute HBAO passes for several radius values at the current view.
+   * @return Whether there was a model to render.
+   */
+  bool RunRadiusBenchmark();
+
+  /**
+   * @brief RunHbaoComparison Renders the reference and the fast HBAO at the
+   * current view and prints their GPU times and the AO error of the fast one.
+   * @return Whether there was a model to render.
+   */
+  bool RunHbaoComparison();
+
+  /**
+   * @brief RunTechniqueBenchmark Renders every registered AO technique at the
+   * current view and prints its GPU time and its mean AO error against a
+   * high quality HBAO reference.
+   * @return Whether there was a model to render.
+   */
+  bool RunTechniqueBenchmark();
+
+  /**
+   * @brief RunAdaptiveComparison Renders the selected technique with full and
+   * with adaptive sampling at the current view and prints their GPU times,
+   * samples per pixel and the AO error of the adaptive one.
+   * @return Whether there was a model to render.
+   */
+  bool RunAdaptiveComparison();
+
+  /**
+   * @brief RunFusedBlurComparison Renders the selected technique with one
+   * blur iteration, as separate passes and fused, and prints their GPU times
+   * and the difference of the blurred AO.
+   * @return Whether there was a model to render.
+   */
+  bool RunFusedBlurComparison();
+
+  /**
+   * @brief RunVulkanComparison Replays the camera path, or the current view
+   * when there is none, with the GL compute HBAO and with the Vulkan backend,
+   * once serialized on the graphics queue and once with the AO and blur on
+   * the compute queue, and prints the throughput of each.
+   * @return Whether there was a model or scene to render and the Vulkan
+   * backend is available.
+   */
+  bool RunVulkanComparison();
+
+  /**
+   * @brief RunMultiViewComparison Renders the current view as one single
+   * view frame per view, and as a layered multi-view frame, both with the
+   * compute HBAO and the separate blur, and prints the throughput of each.
+   * Uses the selected number of views, or two when it is one.
+   * @return Whether there was a model to render and multi-view rendering is
+   * supported.
+   */
+  bool RunMultiViewComparison();
+
+  const data_visualization::AoTechniqueRegistry &ao_techniques() const {
+    return ao_techniques_;
+  }
+
  protected:
   /**
    * @brief initializeGL Initializes OpenGL variables and loads, compiles and
@@ -42,12 +281,253 @@ class GLWidget : public QGLWidget {
    */
   void resizeGL(int w, int h);
 
+  /**
+   * @brief resizeEvent Forwards the new size to the render thread while it
+   * owns the context, and to resizeGL otherwise.
+   */
+  void resizeEvent(QResizeEvent *event);
+
+  /**
+   * @brief paintEvent Paints on the GUI thread. The render thread presents
+   * its frames itself, so it does nothing while it runs.
+   */
+  void paintEvent(QPaintEvent *event);
+
   void mousePressEvent(QMouseEvent *event);
   void mouseMoveEvent(QMouseEvent *event);
   void mouseReleaseEvent(QMouseEvent *event);
   void keyPressEvent(QKeyEvent *event);
 
+  /**
+   * @brief glDraw Renders and swaps a frame, and accounts the input latency
+   * of the frame if it was requested by an input event.
+   */
+  void glDraw();
+
  private:
+  /**
+   * @brief RenderState Everything the GUI thread changes that a frame depends
+   * on, handed over to the render thread as a whole.
+   */
+  struct RenderState {
+    data_visualization::Camera camera;
+    int window_width = 0;
+    int window_height = 0;
+    unsigned int ao_program = 0;
+    size_t ao_technique = 0;
+    bool adaptive_ao = false;
+    unsigned int blur = 0;
+    GLint directions = 0;
+    GLint steps = 0;
+    GLfloat radius = 0.0f;
+    GLfloat t_bias = 0.0f;
+    GLfloat strength = 0.0f;
+
+    /**
+     * @brief event_time Time of the oldest input event of the snapshot, 0 if
+     * it was not caused by input.
+     */
+    qint64 event_time = 0;
+  };
+
+  /**
+   * @brief RequestFrame Marks the frame dirty after an input event updated the
+   * camera state, and schedules a repaint.
+   * @param event The input event that changed the state.
+   */
+  void RequestFrame(const QInputEvent *event);
+
+  /**
+   * @brief PublishState Makes gui_state_ visible to the renderer: applied
+   * directly when rendering on the GUI thread, or sent with the current
+   * camera to the render thread.
+   */
+  void PublishState();
+
+  /**
+   * @brief ApplyState Copies the AO parameters of a snapshot to the members
+   * read by paintGL.
+   */
+  void ApplyState(const RenderState &state);
+
+  /**
+   * @brief RenderThreadFrame Renders and presents a frame on the render
+   * thread with the newest snapshot.
+   */
+  void RenderThreadFrame();
+
+  /**
+   * @brief RequestRedraw Schedules another frame on the thread that renders.
+   */
+  void RequestRedraw();
+
+  /**
+   * @brief ResizeViewport Sets the window size and internal resolution of the
+   * passes. The camera is resized by the caller.
+   */
+  void ResizeViewport(int w, int h);
+
+  /**
+   * @brief MeasureResponsiveness Records the interval of ui_timer_, which
+   * grows when the GUI thread is kept busy.
+   */
+  void MeasureResponsiveness();
+
+  /**
+   * @brief InvalidatePasses Forces every pass to run on the next frame.
+   */
+  void InvalidatePasses();
+
+  /**
+   * @brief DrawQuad Draws the full screen quad.
+   */
+  void DrawQuad() const;
+
+  /**
+   * @brief LoadAoPrograms (Re)loads the programs of every AO technique.
+   * Techniques that need compute shaders are skipped when not supported.
+   * @return Whether every fragment shader technique loaded.
+   */
+  bool LoadAoPrograms();
+
+  /**
+   * @brief ActiveAoTechnique The selected technique, or the first one if it
+   * could not be loaded.
+   */
+  size_t ActiveAoTechnique() const;
+
+  /**
+   * @brief CurrentAoParameters The Render group values, with the steps
+   * reduced by the dynamic resolution.
+   */
+  data_visualization::AoParameters CurrentAoParameters() const;
+
+  /**
+   * @brief CurrentAoFrame Per frame AO values of the current viewport.
+   * @param projection Projection matrix of the G buffer.
+   */
+  data_visualization::AoFrame CurrentAoFrame(const Eigen::Matrix4f &projection) const;
+
+  /**
+   * @brief DrawGBuffer Clears and renders the G buffer and its geometry
+   * stencil into the bound framebuffer.
+   */
+  void DrawGBuffer(const Eigen::Matrix4f &projection, const Eigen::Matrix4f &view,
+                   const Eigen::Matrix4f &model);
+
+  /**
+   * @brief LoadMultiViewPrograms (Re)loads the layered G buffer, HBAO and
+   * blur programs and sets multiview_supported_.
+   */
+  void LoadMultiViewPrograms();
+
+  /**
+   * @brief RenderMultiView Renders and presents a frame of views_ views with
+   * the layered targets. Replaces the render graph of paintGL.
+   * @param projection Projection matrix shared by the views.
+   * @param view View matrix of the central view.
+   * @param model Model matrix.
+   */
+  void RenderMultiView(const Eigen::Matrix4f &projection, const Eigen::Matrix4f &view,
+                       const Eigen::Matrix4f &model);
+
+  /**
+   * @brief ReleaseMultiViewTargets Frees the layered targets. Requires a
+   * current GL context.
+   */
+  void ReleaseMultiViewTargets();
+
+  /**
+   * @brief RenderAo Renders the AO of a technique. Fragment shader techniques
+   * draw to the bound framebuffer.
+   * @param technique Index in the registry.
+   * @param frame Projection and viewport of the G buffer.
+   * @param parameters Technique parameters.
+   * @param g_texture Normal and depth G buffer texture.
+   * @param linear_z_texture View space z texture, for the techniques that
+   * use it.
+   * @param ao_texture Output texture, for compute shader techniques and the
+   * fused blur.
+   * @param fused_blur Whether to render the AO with one blur iteration using
+   * the fused shader of the technique.
+   */
+  void RenderAo(size_t technique, const data_visualization::AoFrame &frame,
+                const data_visualization::AoParameters &parameters,
+                GLuint g_texture, GLuint linear_z_texture, GLuint ao_texture,
+                bool fused_blur);
+
+  /**
+   * @brief ClassifyAoTiles Copies the coarse AO and the geometry mask to the
+   * AO target and sets the refine stencil bit on the tiles that need the full
+   * quality AO.
+   * @param projection Projection matrix of the G buffer.
+   * @param coarse_fbo Coarse AO framebuffer.
+   * @param coarse_texture Coarse AO texture.
+   * @param g_fbo G buffer framebuffer, its stencil has the geometry mask.
+   * @param g_texture Normal and depth G buffer texture.
+   * @param ao_fbo AO target framebuffer, with a stencil attachment.
+   */
+  void ClassifyAoTiles(const Eigen::Matrix4f &projection, GLuint coarse_fbo,
+                       GLuint coarse_texture, GLuint g_fbo, GLuint g_texture,
+                       GLuint ao_fbo);
+
+  /**
+   * @brief CollectAdaptiveStats Reads the refined pixel count of the last
+   * adaptive AO frame.
+   * @param wait Whether to wait for the query result instead of leaving it
+   * for a later frame.
+   */
+  void CollectAdaptiveStats(bool wait);
+
+  /**
+   * @brief CountSkippedAoPixels Reads back the G buffer and counts the
+   * background pixels and the ones whose AO radius projects under a pixel,
+   * neither of which is marched by the AO.
+   */
+  void CountSkippedAoPixels();
+
+  /**
+   * @brief RenderTimedFrames Renders frames with every pass invalidated and
+   * collects their GPU times after a warm-up. Requires a current GL context.
+   * @param frames Frames to render, including the warm-up.
+   */
+  void RenderTimedFrames(int frames);
+
+  /**
+   * @brief TimeAoPass Renders frames and measures the GPU time of the AO
+   * passes, including the ones that prepare its inputs, after a warm-up.
+   * Requires a current GL context.
+   * @param frames Frames to render, including the warm-up.
+   * @return Mean time in milliseconds.
+   */
+  double TimeAoPass(int frames);
+
+  /**
+   * @brief AllocateRenderTargets Acquires from the pool the targets for the
+   * current viewport size, giving back the previous ones.
+   */
+  void AllocateRenderTargets();
+
+  /**
+   * @brief ApplyRenderScale Sets the internal resolution from the window size
+   * and the dynamic resolution scale. It renders to a viewport subrect of the
+   * current targets when it fits in them.
+   */
+  void ApplyRenderScale();
+
+  /**
+   * @brief SettleRenderTargets Called once resizing stops. Moves to targets of
+   * the final size bucket and frees the ones that are no longer used, on the
+   * render thread if it runs.
+   */
+  void SettleRenderTargets();
+
+  /**
+   * @brief RecordKeyframe Appends the current camera state to the camera path
+   * if recording.
+   */
+  void RecordKeyframe();
+
   /**
    * @brief program_ The G buffer shader program.
    */
@@ -59,23 +539,246 @@ class GLWidget : public QGLWidget {
   QOpenGLShaderProgram *blur_program_ = nullptr;
 
   /**
-   * @brief program_ The HBAO shader program.
+   * @brief ao_techniques_ The selectable AO techniques.
+   */
+  data_visualization::AoTechniqueRegistry ao_techniques_;
+
+  /**
+   * @brief ao_programs_ Program of every technique, nullptr if it could not
+   * be loaded.
    */
-  QOpenGLShaderProgram *hbao_program_ = nullptr;
+  std::vector<QOpenGLShaderProgram *> ao_programs_;
+
+  /**
+   * @brief fused_programs_ Fused AO and blur program of every technique,
+   * nullptr if it has none or it could not be loaded.
+   */
+  std::vector<QOpenGLShaderProgram *> fused_programs_;
+
+  /**
+   * @brief fused_blur_ Whether to use the fused programs when possible.
+   */
+  bool fused_blur_ = true;
+
+  /**
+   * @brief ao_technique_ Selected technique.
+   */
+  size_t ao_technique_ = 0;
 
   QOpenGLShaderProgram *depth_program_ = nullptr;
 
   QOpenGLShaderProgram *normal_program_ = nullptr;
 
+  /**
+   * @brief classify_program_ Marks the tiles refined by the adaptive AO.
+   */
+  QOpenGLShaderProgram *classify_program_ = nullptr;
+
+  /**
+   * @brief linear_z_program_ Writes the view space z of the G buffer to a
+   * single channel target.
+   */
+  QOpenGLShaderProgram *linear_z_program_ = nullptr;
+
+  /**
+   * @brief adaptive_ao_ Whether the AO is computed coarsely and refined only
+   * on silhouettes, depth discontinuities and high variance tiles.
+   */
+  bool adaptive_ao_ = false;
+
+  /**
+   * @brief adaptive_query_ Counts the pixels refined by the adaptive AO.
+   */
+  GLuint adaptive_query_ = 0;
+  bool adaptive_query_pending_ = false;
+
+  /**
+   * @brief adaptive_query_samples_ Coarse and full samples per pixel of the
+   * frame being counted.
+   */
+  int adaptive_query_samples_[2] = {0, 0};
+
+  /**
+   * @brief adaptive_refined_ Fraction of the viewport refined in the last
+   * counted frame.
+   */
+  double adaptive_refined_ = 0.0;
+
+  /**
+   * @brief adaptive_samples_ Mean samples per pixel of the last counted frame,
+   * against adaptive_full_samples_ without adaptive sampling.
+   */
+  double adaptive_samples_ = 0.0;
+  int adaptive_full_samples_ = 0;
+
+  /**
+   * @brief skipped_background_ Fraction of the viewport skipped by the AO as
+   * background, and skipped_sub_pixel_ as having a sub-pixel radius.
+   */
+  double skipped_background_ = 0.0;
+  double skipped_sub_pixel_ = 0.0;
+
   /**
    * @brief camera_ Class that computes the multiple camera transform matrices.
    */
   data_visualization::Camera camera_;
 
   /**
-   * @brief mesh_ Data structure representing a triangle mesh.
+   * @brief camera_path_ Recorded or loaded camera path used for benchmarking.
+   */
+  data_visualization::CameraPath camera_path_;
+
+  /**
+   * @brief recording_ Whether the camera state is being recorded.
+   */
+  bool recording_ = false;
+
+  /**
+   * @brief record_timer_ Time since the recording started.
+   */
+  QElapsedTimer record_timer_;
+
+  /**
+   * @brief coalesce_frames_ Whether input events are coalesced into the next
+   * paint event instead of rendering synchronously.
+   */
+  bool coalesce_frames_ = true;
+
+  /**
+   * @brief frame_dirty_ Whether an input event changed the state since the
+   * last swap.
+   */
+  bool frame_dirty_ = false;
+
+  /**
+   * @brief input_timer_ Clock used to timestamp input events and swaps.
+   */
+  QElapsedTimer input_timer_;
+
+  /**
+   * @brief input_clock_offset_ Offset in nanoseconds from the window system
+   * event timestamps to input_timer_.
+   */
+  qint64 input_clock_offset_ = std::numeric_limits<qint64>::max();
+
+  /**
+   * @brief dirty_event_time_ Time of the oldest input event not displayed yet.
+   */
+  qint64 dirty_event_time_ = 0;
+
+  /**
+   * @brief latency_stats_ Event-to-swap latency of the input driven frames.
+   */
+  data_visualization::FrameStats latency_stats_;
+
+  /**
+   * @brief gui_state_ State set by the GUI thread, see PublishState.
+   */
+  RenderState gui_state_;
+
+  /**
+   * @brief state_mailbox_ Newest snapshot for the render thread.
+   */
+  data_visualization::SnapshotMailbox<RenderState> state_mailbox_;
+
+  /**
+   * @brief render_camera_ Camera of the last snapshot. paintGL uses it
+   * instead of camera_, which belongs to the GUI thread, while the render
+   * thread runs.
+   */
+  data_visualization::Camera render_camera_;
+
+  /**
+   * @brief settle_pending_ Set by the GUI thread when resizing stops while
+   * the render thread runs, which then settles the targets it owns.
+   */
+  std::atomic<bool> settle_pending_{false};
+
+  /**
+   * @brief render_event_time_ Event time of the last snapshot not presented
+   * yet. Render thread only.
+   */
+  qint64 render_event_time_ = 0;
+
+  /**
+   * @brief presented_event_time_ Event time of the last input driven frame
+   * presented by the render thread. Tells the GUI thread when the oldest
+   * dirty event has been displayed.
+   */
+  std::atomic<qint64> presented_event_time_{0};
+
+  /**
+   * @brief render_thread_ Renders the frames when threaded rendering is
+   * enabled, nullptr otherwise.
+   */
+  std::unique_ptr<gui::RenderThread> render_thread_;
+
+  /**
+   * @brief frame_pacer_ Keeps the render thread at most two frames ahead of
+   * the GPU.
+   */
+  data_visualization::FramePacer frame_pacer_;
+
+  /**
+   * @brief ui_timer_ Periodic GUI thread timer, its intervals are in
+   * ui_stats_.
+   */
+  QTimer ui_timer_;
+  QElapsedTimer ui_clock_;
+  data_visualization::FrameStats ui_stats_;
+
+  /**
+   * @brief UploadScene Fills the arena, instance and indirect buffers from
+   * scene_ and updates the interface labels.
+   */
+  void UploadScene();
+
+  /**
+   * @brief UpdateMemoryStats Reports the current size of the scene buffers,
+   * the render targets, the noise textures and the page pool to
+   * memory_stats_, and updates the memory labels when they change. Called
+   * when they are allocated or freed, not every frame.
+   */
+  void UpdateMemoryStats();
+
+  /**
+   * @brief DrawScene Draws every instance of scene_, with a single multi draw
+   * indirect when supported and one instanced draw per mesh otherwise.
+   */
+  void DrawScene();
+
+  /**
+   * @brief scene_ Meshes in a shared arena and their instances. A loaded
+   * model is a scene with a single instance.
+   */
+  data_representation::Scene scene_;
+
+  /**
+   * @brief scene_version_ Increased every time a model or scene is loaded.
+   */
+  unsigned int scene_version_ = 0;
+
+  /**
+   * @brief draw_commands_ Instanced draws of scene_, also in indirect_buffer_.
+   */
+  std::vector<data_representation::DrawCommand> draw_commands_;
+
+  /**
+   * @brief welding_ Whether loaded meshes are welded with weld_options_.
+   */
+  bool welding_ = false;
+  data_representation::WeldOptions weld_options_;
+
+  /**
+   * @brief streamer_ Resident pages of the paged mesh, when one is loaded
+   * instead of scene_.
+   */
+  data_visualization::PageStreamer streamer_;
+
+  /**
+   * @brief HasGeometry Whether a scene or a paged mesh is loaded.
    */
-  std::unique_ptr<data_representation::TriangleMesh> mesh_;
+  bool HasGeometry() const;
 
   /**
    * @brief initialized_ Whether the widget has finished initializations.
@@ -83,43 +786,166 @@ class GLWidget : public QGLWidget {
   bool initialized_ = false;
 
   /**
-   * @brief width_ Viewport current width.
+   * @brief width_ Viewport current width, the internal resolution of the
+   * passes.
    */
   float width_;
 
   /**
-   * @brief height_ Viewport current height.
+   * @brief height_ Viewport current height, the internal resolution of the
+   * passes.
    */
   float height_;
 
+  /**
+   * @brief window_width_ Widget width, the present pass upscales to it.
+   */
+  float window_width_ = 0.0f;
+
+  /**
+   * @brief window_height_ Widget height.
+   */
+  float window_height_ = 0.0f;
+
+  /**
+   * @brief dynamic_resolution_ Whether resolution_ drives the internal
+   * resolution.
+   */
+  bool dynamic_resolution_ = false;
+
+  /**
+   * @brief resolution_ Keeps the GPU frame time within budget.
+   */
+  data_visualization::ResolutionController resolution_;
+
   unsigned int ao_program_ = 0;
 
-  GLuint g_fbo_;
-  GLuint g_rbo_;
-  GLuint g_normal_depth_texture_;
+  /**
+   * @brief target_pool_ Owns every render target, bucketed by size.
+   */
+  data_visualization::RenderTargetPool target_pool_;
+
+  data_visualization::RenderTarget *g_target_ = nullptr;
+  data_visualization::RenderTarget *ao_target_ = nullptr;
+  data_visualization::RenderTarget *blur_target_ = nullptr;
+
+  /**
+   * @brief views_ Views rendered side by side, 1 for the regular frame.
+   */
+  int views_ = 1;
+
+  /**
+   * @brief multiview_supported_ Whether the layered programs loaded.
+   */
+  bool multiview_supported_ = false;
+
+  QOpenGLShaderProgram *g_layered_program_ = nullptr;
+  QOpenGLShaderProgram *hbao_layered_program_ = nullptr;
+  QOpenGLShaderProgram *blur_layered_program_ = nullptr;
+
+  /**
+   * @brief g_layers_ G buffer of the multi-view frame, one layer per view.
+   * ao_layers_ and blur_layers_ hold the AO and the blur ping-pong. They are
+   * sized to the internal resolution and are not pooled.
+   */
+  data_visualization::LayeredTarget g_layers_;
+  data_visualization::LayeredTarget ao_layers_;
+  data_visualization::LayeredTarget blur_layers_;
+
+  /**
+   * @brief gpu_timer_ Per-pass GPU timings, hooked into the render graph.
+   */
+  data_visualization::GpuTimer gpu_timer_;
+
+  /**
+   * @brief graph_stats_ Culling and aliasing of the last frame.
+   */
+  data_visualization::RenderGraph::Stats graph_stats_;
 
-  const GLsizei COLOR_FBOS = 2;
+  /**
+   * @brief uv_scale_ Viewport size over render target size. Targets can be
+   * larger than the viewport while resizing.
+   */
+  glm::vec2 uv_scale_;
 
-  GLuint *c_fbo_;
-  GLuint *c_textures_;
+  /**
+   * @brief resize_timer_ Fires when the viewport has not been resized for a
+   * while.
+   */
+  QTimer resize_timer_;
 
-  GLuint vao_;
+  GLuint vao_ = 0;
   GLuint vbo_;
   GLuint vno_;
   GLuint ebo_;
 
+  /**
+   * @brief instance_buffer_ Model transform per instance, attribute 2 to 5.
+   */
+  GLuint instance_buffer_;
+
+  /**
+   * @brief indirect_buffer_ DrawCommand per mesh of the scene.
+   */
+  GLuint indirect_buffer_;
+
   GLuint quad_vao_;
   GLuint quad_vbo_;
 
   GLuint noise_texture_;
 
+  /**
+   * @brief direction_texture_ Starting direction and step jitter per noise
+   * texel, used by the fast HBAO.
+   */
+  GLuint direction_texture_;
+
+  /**
+   * @brief noise_bytes_ GPU memory of noise_texture_ and direction_texture_.
+   */
+  size_t noise_bytes_ = 0;
+
+  /**
+   * @brief scene_gpu_bytes_ Bytes last uploaded to the arena, instance and
+   * indirect buffers, which keep them until the next upload.
+   */
+  size_t scene_gpu_bytes_ = 0;
+
+  bool release_cpu_geometry_ = false;
+  data_visualization::MemoryStats memory_stats_;
+
+  /**
+   * @brief memory_labels_ Last values sent to the memory labels.
+   */
+  QString memory_labels_[2];
+
+  /**
+   * @brief accounted_targets_ Targets of target_pool_ when memory_stats_ was
+   * last updated.
+   */
+  size_t accounted_targets_ = 0;
+
+  /**
+   * @brief g_pass_ Inputs of the G buffer: camera matrices, mesh and viewport.
+   */
+  data_visualization::CachedPass g_pass_;
+
+  /**
+   * @brief ao_pass_ Inputs of the HBAO output: G buffer and HBAO parameters.
+   */
+  data_visualization::CachedPass ao_pass_;
+
+  /**
+   * @brief blur_pass_ Inputs of the blur chain output: blurred view, its
+   * version and amount.
+   */
+  data_visualization::CachedPass blur_pass_;
+
   GLfloat aspect_ratio;
   GLfloat tan_half_fov;
 
   glm::vec2 pixel_size;
 
-  bool resized_ = false;
-
   unsigned int blur_ = 0;
 
   GLint hbao_directions = 3;
@@ -128,6 +954,34 @@ class GLWidget : public QGLWidget {
   GLfloat hbao_t_bias = 30.0f * (M_PI / 180.0f);
   GLfloat hbao_strength = 1.0f;
 
+  /**
+   * @brief compute_supported_ Whether the context supports compute shaders.
+   */
+  bool compute_supported_ = false;
+
+  /**
+   * @brief gather_supported_ Whether the context has textureGather.
+   */
+  bool gather_supported_ = false;
+
+#ifdef HBAO_VULKAN
+  /**
+   * @brief vulkan_ Backend of the Vulkan comparison, created on first use.
+   */
+  std::unique_ptr<data_visualization::VulkanRenderer> vulkan_;
+
+  /**
+   * @brief vulkan_scene_version_ scene_version_ uploaded to vulkan_.
+   */
+  unsigned int vulkan_scene_version_ = 0;
+#endif
+
+  /**
+   * @brief multi_draw_supported_ Whether the context has
+   * glMultiDrawElementsIndirect with base instances.
+   */
+  bool multi_draw_supported_ = false;
+
  protected slots:
   /**
    * @brief paintGL Function that handles rendering the scene.
@@ -152,6 +1006,10 @@ class GLWidget : public QGLWidget {
 
   void set_hbao_strength(double v);
 
+  void set_ao_technique(int technique);
+
+  void set_adaptive_ao(bool v);
+
  signals:
   /**
    * @brief SetFaces Signal that updates the interface label "Faces".
@@ -167,6 +1025,16 @@ class GLWidget : public QGLWidget {
    * @brief SetFaces Signal that updates the interface label "Framerate".
    */
   void SetFramerate(QString);
+
+  /**
+   * @brief SetCpuMemory Signal that updates the interface label "CPU memory".
+   */
+  void SetCpuMemory(QString);
+
+  /**
+   * @brief SetGpuMemory Signal that updates the interface label "GPU memory".
+   */
+  void SetGpuMemory(QString);
 };
 
 #endif  //  GLWIDGET_H_
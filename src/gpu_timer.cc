@@ -0,0 +1,147 @@
+// Author: Marc Comino 2020
+
+#include <gpu_timer.h>
+
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace data_visualization {
+
+namespace {
+
+/**
+ * @brief kFramesInFlight Number of frames whose queries can be pending.
+ */
+const size_t kFramesInFlight = 4;
+
+/**
+ * @brief kSmoothing Weight of a new measurement in the moving averages.
+ */
+const double kSmoothing = 0.1;
+
+double Smooth(double average, double value) {
+  return average == 0.0 ? value : average + (value - average) * kSmoothing;
+}
+
+}  //  namespace
+
+GpuTimer::GpuTimer() : frames_(kFramesInFlight) {}
+
+void GpuTimer::BeginFrame() {
+  for (size_t i = 1; i < kFramesInFlight; ++i)
+    Collect(&frames_[(current_ + i) % kFramesInFlight], false);
+
+  Frame &frame = frames_[current_];
+  if (frame.pending) {
+    // The GPU is more than kFramesInFlight frames behind. Drop the results
+    // instead of stalling.
+    frame.pending = false;
+  }
+  frame.used = 0;
+}
+
+void GpuTimer::EndFrame() {
+  frames_[current_].pending = frames_[current_].used > 0;
+  current_ = (current_ + 1) % kFramesInFlight;
+}
+
+void GpuTimer::BeginPass(const std::string &name) {
+  Frame &frame = frames_[current_];
+  if (frame.used == frame.queries.size()) {
+    Query query;
+    glGenQueries(1, &query.query);
+    frame.queries.push_back(query);
+  }
+
+  Query &query = frame.queries[frame.used++];
+  query.name = name;
+  glBeginQuery(GL_TIME_ELAPSED, query.query);
+  in_pass_ = true;
+}
+
+void GpuTimer::EndPass() {
+  if (!in_pass_) return;
+  glEndQuery(GL_TIME_ELAPSED);
+  in_pass_ = false;
+}
+
+double GpuTimer::PassMs(const std::string &name) const {
+  auto it = pass_ms_.find(name);
+  return it == pass_ms_.end() ? 0.0 : it->second;
+}
+
+double GpuTimer::FrameMs() const { return frame_ms_; }
+
+double GpuTimer::MeanPassMs(const std::string &name) const {
+  auto it = pass_total_ms_.find(name);
+  if (it == pass_total_ms_.end() || collected_frames_ == 0) return 0.0;
+  return it->second / static_cast<double>(collected_frames_);
+}
+
+void GpuTimer::Flush() {
+  for (size_t i = 1; i <= kFramesInFlight; ++i)
+    Collect(&frames_[(current_ + i) % kFramesInFlight], true);
+}
+
+void GpuTimer::Clear() {
+  pass_ms_.clear();
+  frame_ms_ = 0.0;
+  pass_total_ms_.clear();
+  collected_frames_ = 0;
+}
+
+void GpuTimer::Print(std::ostream *out) const {
+  const std::ios_base::fmtflags kFlags = out->flags();
+  const std::streamsize kPrecision = out->precision();
+
+  *out << "GPU pass timings" << std::endl;
+  *out << std::fixed << std::setprecision(3);
+  for (const auto &pass : pass_ms_)
+    *out << "\t" << pass.first << " = " << pass.second << " ms" << std::endl;
+  *out << "\tFrame = " << frame_ms_ << " ms" << std::endl;
+
+  out->flags(kFlags);
+  out->precision(kPrecision);
+}
+
+void GpuTimer::Release() {
+  for (Frame &frame : frames_) {
+    for (Query &query : frame.queries) glDeleteQueries(1, &query.query);
+    frame.queries.clear();
+    frame.used = 0;
+    frame.pending = false;
+  }
+}
+
+void GpuTimer::Collect(Frame *frame, bool wait) {
+  if (!frame->pending) return;
+
+  if (!wait) {
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame->queries[frame->used - 1].query,
+                       GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) return;
+  }
+
+  std::map<std::string, double> frame_passes;
+  double total = 0.0;
+  for (size_t i = 0; i < frame->used; ++i) {
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(frame->queries[i].query, GL_QUERY_RESULT, &ns);
+    frame_passes[frame->queries[i].name] += ns / 1000000.0;
+    total += ns / 1000000.0;
+  }
+
+  for (const auto &pass : frame_passes) {
+    pass_ms_[pass.first] = Smooth(pass_ms_[pass.first], pass.second);
+    pass_total_ms_[pass.first] += pass.second;
+  }
+  frame_ms_ = Smooth(frame_ms_, total);
+  ++collected_frames_;
+
+  frame->pending = false;
+}
+
+}  //  namespace data_visualization
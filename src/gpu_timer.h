@@ -0,0 +1,110 @@
+// Author: Marc Comino 2020
+
+#ifndef GPU_TIMER_H_
+#define GPU_TIMER_H_
+
+#include <GL/glew.h>
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "./render_graph.h"
+
+namespace data_visualization {
+
+/**
+ * @brief GpuTimer Measures the GPU time of every pass with GL_TIME_ELAPSED
+ * queries. Results are read a few frames later, when available, so that the
+ * CPU never waits for the GPU.
+ */
+class GpuTimer : public PassTimer {
+ public:
+  GpuTimer();
+
+  /**
+   * @brief BeginFrame Collects the available results of previous frames and
+   * starts a new one. Requires a current GL context.
+   */
+  void BeginFrame();
+
+  /**
+   * @brief EndFrame Finishes the current frame.
+   */
+  void EndFrame();
+
+  void BeginPass(const std::string &name) override;
+  void EndPass() override;
+
+  /**
+   * @brief PassMs Smoothed GPU time of a pass, summing every pass with the
+   * same name in a frame.
+   * @param name Pass name.
+   * @return Time in milliseconds, 0 if the pass has not been measured.
+   */
+  double PassMs(const std::string &name) const;
+
+  /**
+   * @brief FrameMs Smoothed GPU time of all the passes of a frame.
+   */
+  double FrameMs() const;
+
+  /**
+   * @brief MeanPassMs Mean GPU time of a pass over the frames collected since
+   * the last Clear.
+   * @param name Pass name.
+   * @return Time in milliseconds, 0 if the pass has not been measured.
+   */
+  double MeanPassMs(const std::string &name) const;
+
+  /**
+   * @brief Flush Waits for the results of every pending frame. Meant for
+   * benchmarks, it stalls the CPU.
+   */
+  void Flush();
+
+  /**
+   * @brief Clear Forgets the accumulated times.
+   */
+  void Clear();
+
+  /**
+   * @brief Print Writes the smoothed time of every pass.
+   * @param out Output stream.
+   */
+  void Print(std::ostream *out) const;
+
+  /**
+   * @brief Release Deletes the queries. Requires a current GL context.
+   */
+  void Release();
+
+ private:
+  struct Query {
+    std::string name;
+    GLuint query;
+  };
+
+  struct Frame {
+    std::vector<Query> queries;
+    size_t used = 0;
+    bool pending = false;
+  };
+
+  void Collect(Frame *frame, bool wait);
+
+  std::vector<Frame> frames_;
+  size_t current_ = 0;
+  bool in_pass_ = false;
+
+  std::map<std::string, double> pass_ms_;
+  double frame_ms_ = 0.0;
+
+  std::map<std::string, double> pass_total_ms_;
+  size_t collected_frames_ = 0;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  GPU_TIMER_H_
@@ -0,0 +1,85 @@
+// Author: Marc Comino 2020
+
+#include <layered_target.h>
+
+#include "./render_target_pool.h"
+
+namespace data_visualization {
+
+bool LayeredTarget::Allocate(GLsizei width, GLsizei height, GLsizei layers, GLint internal_format,
+                             bool depth) {
+  if (texture_ != 0 && width == width_ && height == height_ && layers == layers_ &&
+      internal_format == internal_format_ && depth == (depth_ != 0))
+    return true;
+
+  Release();
+  width_ = width;
+  height_ = height;
+  layers_ = layers;
+  internal_format_ = internal_format;
+
+  glGenTextures(1, &texture_);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internal_format, width, height, layers, 0,
+               PixelFormat(internal_format), GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  if (depth) {
+    glGenTextures(1, &depth_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depth_);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, width, height, layers, 0,
+                 GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+  }
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  // Attaching whole arrays makes the framebuffer layered, gl_Layer then
+  // selects the layer written.
+  glGenFramebuffers(1, &fbo_);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture_, 0);
+  if (depth_ != 0) glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depth_, 0);
+  const bool kComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+  layer_fbos_.resize(static_cast<size_t>(layers));
+  glGenFramebuffers(layers, layer_fbos_.data());
+  for (GLsizei layer = 0; layer < layers; ++layer) {
+    glBindFramebuffer(GL_FRAMEBUFFER, layer_fbos_[layer]);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture_, 0, layer);
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  // Keeping an incomplete target would make the next call return early as
+  // if it were usable.
+  if (!kComplete) Release();
+  return kComplete;
+}
+
+void LayeredTarget::Release() {
+  if (texture_ == 0) return;
+
+  glDeleteFramebuffers(1, &fbo_);
+  glDeleteFramebuffers(static_cast<GLsizei>(layer_fbos_.size()), layer_fbos_.data());
+  glDeleteTextures(1, &texture_);
+  if (depth_ != 0) glDeleteTextures(1, &depth_);
+
+  texture_ = 0;
+  depth_ = 0;
+  fbo_ = 0;
+  layer_fbos_.clear();
+  width_ = height_ = layers_ = 0;
+}
+
+size_t LayeredTarget::GpuBytes() const {
+  if (texture_ == 0) return 0;
+
+  const size_t kTexels = static_cast<size_t>(width_) * static_cast<size_t>(height_) *
+                         static_cast<size_t>(layers_);
+  size_t bytes = kTexels * BytesPerPixel(internal_format_);
+  if (depth_ != 0) bytes += kTexels * BytesPerPixel(GL_DEPTH_COMPONENT24);
+  return bytes;
+}
+
+}  //  namespace data_visualization
@@ -0,0 +1,66 @@
+// Author: Marc Comino 2020
+
+#ifndef LAYERED_TARGET_H_
+#define LAYERED_TARGET_H_
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace data_visualization {
+
+/**
+ * @brief LayeredTarget A 2D array color texture, one layer per view, with an
+ * optional depth array. Its layered framebuffer lets a geometry shader pick
+ * the layer of every primitive, and the per layer framebuffers read single
+ * layers back, e.g. to present them.
+ */
+class LayeredTarget {
+ public:
+  /**
+   * @brief Allocate Creates the textures and framebuffers, unless they
+   * already have this size, layer count and format. Requires a current GL
+   * context.
+   * @param width Width of every layer.
+   * @param height Height of every layer.
+   * @param layers Number of layers.
+   * @param internal_format Texture internal format, e.g. GL_RGBA16F.
+   * @param depth Whether a GL_DEPTH_COMPONENT24 array is attached.
+   * @return Whether the layered framebuffer is complete.
+   */
+  bool Allocate(GLsizei width, GLsizei height, GLsizei layers, GLint internal_format, bool depth);
+
+  /**
+   * @brief Release Deletes the textures and framebuffers. Requires a current
+   * GL context.
+   */
+  void Release();
+
+  GLuint texture() const { return texture_; }
+  GLuint fbo() const { return fbo_; }
+  GLuint layer_fbo(GLsizei layer) const { return layer_fbos_[layer]; }
+  GLsizei width() const { return width_; }
+  GLsizei height() const { return height_; }
+  GLsizei layers() const { return layers_; }
+
+  /**
+   * @brief GpuBytes Estimated GPU memory of the textures.
+   */
+  size_t GpuBytes() const;
+
+ private:
+  GLuint texture_ = 0;
+  GLuint depth_ = 0;
+  GLuint fbo_ = 0;
+  std::vector<GLuint> layer_fbos_;
+
+  GLsizei width_ = 0;
+  GLsizei height_ = 0;
+  GLsizei layers_ = 0;
+  GLint internal_format_ = 0;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  LAYERED_TARGET_H_
@@ -8,6 +8,7 @@ int main(int argc, char *argv[]) {
   QGLFormat fmt;
   fmt.setVersion(3, 3);
   fmt.setProfile(QGLFormat::CoreProfile);
+  fmt.setSwapInterval(1);
   QGLFormat::setDefaultFormat(fmt);
 
   QApplication a(argc, argv);
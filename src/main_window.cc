@@ -3,7 +3,11 @@
 #include <main_window.h>
 
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
+#include <algorithm>
+#include <vector>
+#include "./mesh_pages.h"
 #include "./ui_main_window.h"
 
 namespace gui {
@@ -11,6 +15,12 @@ namespace gui {
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow) {
   ui->setupUi(this);
+
+  const data_visualization::AoTechniqueRegistry &kTechniques =
+      ui->glwidget->ao_techniques();
+  for (size_t i = 0; i < kTechniques.Size(); ++i)
+    ui->comboBox_technique->addItem(
+        QString::fromStdString(kTechniques.Get(i).Label()));
 }
 
 MainWindow::~MainWindow() { delete ui; }
@@ -23,7 +33,7 @@ void MainWindow::on_actionLoad_triggered() {
   QString filename;
 
   filename = QFileDialog::getOpenFileName(this, tr("Load model"), "./",
-                                          tr("PLY Files ( *.ply )"));
+                                          tr("Models ( *.ply *.pages )"));
   if (!filename.isNull()) {
     if (!ui->glwidget->LoadModel(filename))
       QMessageBox::warning(this, tr("Error"),
@@ -31,4 +41,225 @@ void MainWindow::on_actionLoad_triggered() {
   }
 }
 
+void MainWindow::on_actionLoad_scene_triggered() {
+  QString filename;
+
+  filename = QFileDialog::getOpenFileName(this, tr("Load scene"), "./",
+                                          tr("Scene Files ( *.scene )"));
+  if (!filename.isNull()) {
+    if (!ui->glwidget->LoadScene(filename))
+      QMessageBox::warning(this, tr("Error"),
+                           tr("The file could not be opened"));
+  }
+}
+
+void MainWindow::on_actionBuild_pages_triggered() {
+  QString filename;
+
+  filename = QFileDialog::getOpenFileName(this, tr("Build pages"), "./",
+                                          tr("PLY Files ( *.ply )"));
+  if (filename.isNull()) return;
+
+  const QString kPages = filename.left(filename.lastIndexOf('.')) + ".pages";
+  if (!data_representation::BuildPages(filename.toStdString(),
+                                       kPages.toStdString()) ||
+      !ui->glwidget->LoadModel(kPages))
+    QMessageBox::warning(this, tr("Error"),
+                         tr("The pages could not be built"));
+}
+
+void MainWindow::on_actionWeld_vertices_toggled(bool checked) {
+  ui->glwidget->SetWelding(checked);
+}
+
+void MainWindow::on_actionSet_weld_epsilon_triggered() {
+  bool ok = false;
+  const double kEpsilon = QInputDialog::getDouble(
+      this, tr("Weld epsilon"), tr("Largest distance between welded vertices"),
+      ui->glwidget->weld_epsilon(), 0.0, 1000.0, 6, &ok);
+  if (ok) ui->glwidget->SetWeldEpsilon(static_cast<float>(kEpsilon));
+}
+
+void MainWindow::on_actionRelease_CPU_geometry_toggled(bool checked) {
+  ui->glwidget->SetReleaseCpuGeometry(checked);
+}
+
+void MainWindow::on_actionRecord_camera_path_toggled(bool checked) {
+  if (checked) {
+    ui->glwidget->StartRecording();
+  } else {
+    ui->glwidget->StopRecording();
+  }
+}
+
+void MainWindow::on_actionSave_camera_path_triggered() {
+  QString filename;
+
+  filename = QFileDialog::getSaveFileName(this, tr("Save camera path"), "./",
+                                          tr("Camera paths ( *.path )"));
+  if (!filename.isNull()) {
+    if (!ui->glwidget->SaveCameraPath(filename))
+      QMessageBox::warning(this, tr("Error"),
+                           tr("The file could not be saved"));
+  }
+}
+
+void MainWindow::on_actionLoad_camera_path_triggered() {
+  QString filename;
+
+  filename = QFileDialog::getOpenFileName(this, tr("Load camera path"), "./",
+                                          tr("Camera paths ( *.path )"));
+  if (!filename.isNull()) {
+    if (!ui->glwidget->LoadCameraPath(filename))
+      QMessageBox::warning(this, tr("Error"),
+                           tr("The file could not be opened"));
+  }
+}
+
+void MainWindow::on_actionRun_benchmark_triggered() {
+  if (!ui->glwidget->RunBenchmark())
+    QMessageBox::warning(this, tr("Error"),
+                         tr("Record or load a camera path first"));
+}
+
+void MainWindow::on_actionCoalesce_input_frames_toggled(bool checked) {
+  ui->glwidget->SetFrameCoalescing(checked);
+}
+
+void MainWindow::on_actionDynamic_resolution_toggled(bool checked) {
+  ui->glwidget->SetDynamicResolution(checked);
+}
+
+void MainWindow::on_actionRender_thread_toggled(bool checked) {
+  ui->glwidget->SetThreadedRendering(checked);
+}
+
+void MainWindow::on_actionSet_frame_budget_triggered() {
+  bool ok = false;
+  const double kBudget = QInputDialog::getDouble(
+      this, tr("Frame budget"), tr("GPU frame time (ms)"),
+      ui->glwidget->frame_budget(), 1.0, 1000.0, 1, &ok);
+  if (ok) ui->glwidget->SetFrameBudget(kBudget);
+}
+
+void MainWindow::on_actionSet_views_triggered() {
+  bool ok = false;
+  const int kViews = QInputDialog::getInt(
+      this, tr("Views"), tr("Views rendered side by side"),
+      ui->glwidget->views(), 1, GLWidget::kMaxViews, 1, &ok);
+  if (ok && !ui->glwidget->SetMultiView(kViews))
+    QMessageBox::warning(this, tr("Error"),
+                         tr("Multi-view rendering needs compute shaders"));
+}
+
+void MainWindow::on_actionReport_input_latency_triggered() {
+  ui->glwidget->ReportInputLatency();
+}
+
+void MainWindow::on_actionReport_pass_timings_triggered() {
+  ui->glwidget->ReportPassTimings();
+}
+
+void MainWindow::on_actionReport_memory_triggered() {
+  ui->glwidget->ReportMemory();
+}
+
+void MainWindow::on_actionRender_tiled_triggered() {
+  bool ok = false;
+  const int kWidth = QInputDialog::getInt(this, tr("Render tiled AO"),
+                                          tr("Width (pixels)"), 16384, 1,
+                                          1 << 20, 1, &ok);
+  if (!ok) return;
+
+  // Keeps the aspect ratio of the view by default.
+  const int kHeight = QInputDialog::getInt(
+      this, tr("Render tiled AO"), tr("Height (pixels)"),
+      std::max(1, static_cast<int>(static_cast<double>(kWidth) *
+                                   ui->glwidget->height() /
+                                   std::max(1, ui->glwidget->width()))),
+      1, 1 << 20, 1, &ok);
+  if (!ok) return;
+
+  QString filename;
+
+  filename = QFileDialog::getSaveFileName(this, tr("Render tiled AO"), "./",
+                                          tr("PGM images ( *.pgm )"));
+  if (!filename.isNull()) {
+    if (!ui->glwidget->RenderTiled(filename, kWidth, kHeight))
+      QMessageBox::warning(this, tr("Error"),
+                           tr("The image could not be rendered"));
+  }
+}
+
+void MainWindow::on_actionRun_radius_benchmark_triggered() {
+  if (!ui->glwidget->RunRadiusBenchmark())
+    QMessageBox::warning(this, tr("Error"), tr("Load a model first"));
+}
+
+void MainWindow::on_actionCompare_fast_hbao_triggered() {
+  if (!ui->glwidget->RunHbaoComparison())
+    QMessageBox::warning(this, tr("Error"), tr("Load a model first"));
+}
+
+void MainWindow::on_actionRun_technique_benchmark_triggered() {
+  if (!ui->glwidget->RunTechniqueBenchmark())
+    QMessageBox::warning(this, tr("Error"), tr("Load a model first"));
+}
+
+void MainWindow::on_actionCompare_adaptive_ao_triggered() {
+  if (!ui->glwidget->RunAdaptiveComparison())
+    QMessageBox::warning(this, tr("Error"), tr("Load a model first"));
+}
+
+void MainWindow::on_actionCompare_fused_blur_triggered() {
+  if (!ui->glwidget->RunFusedBlurComparison())
+    QMessageBox::warning(this, tr("Error"), tr("Load a model first"));
+}
+
+void MainWindow::on_actionCompare_vulkan_triggered() {
+  if (!ui->glwidget->RunVulkanComparison())
+    QMessageBox::warning(this, tr("Error"),
+                         tr("Load a model or scene first, or check that the Vulkan "
+                            "backend is built (CONFIG+=vulkan_backend) and has a driver"));
+}
+
+void MainWindow::on_actionCompare_multi_view_triggered() {
+  if (!ui->glwidget->RunMultiViewComparison())
+    QMessageBox::warning(this, tr("Error"),
+                         tr("Load a model first, multi-view rendering also "
+                            "needs compute shaders"));
+}
+
+void MainWindow::on_comboBox_technique_currentIndexChanged(int index) {
+  if (index < 0) return;
+
+  typedef data_visualization::AoParameter AoParameter;
+  struct ParameterWidgets {
+    AoParameter parameter;
+    QLabel *label;
+    QWidget *input;
+  };
+  const std::vector<ParameterWidgets> kWidgets = {
+      {AoParameter::kDirections, ui->label, ui->spinBox_directions},
+      {AoParameter::kSteps, ui->label_2, ui->spinBox_steps},
+      {AoParameter::kRadius, ui->label_3, ui->doubleSpinBox_radius},
+      {AoParameter::kBias, ui->label_5, ui->doubleSpinBox_bias},
+      {AoParameter::kStrength, ui->label_4, ui->doubleSpinBox_strength}};
+
+  const std::vector<data_visualization::AoParameterSpec> kSpecs =
+      ui->glwidget->ao_techniques().Get(static_cast<size_t>(index)).Parameters();
+
+  for (const ParameterWidgets &widgets : kWidgets) {
+    bool used = false;
+    for (const data_visualization::AoParameterSpec &spec : kSpecs) {
+      if (spec.parameter == widgets.parameter) {
+        widgets.label->setText(QString::fromStdString(spec.label));
+        used = true;
+      }
+    }
+    widgets.label->setEnabled(used);
+    widgets.input->setEnabled(used);
+  }
+}
+
 }  //  namespace gui
@@ -31,6 +31,161 @@ class MainWindow : public QMainWindow {
    */
   void on_actionLoad_triggered();
 
+  /**
+   * @brief on_actionLoad_scene_triggered Opens a file dialog to load a scene
+   * of instanced PLY meshes.
+   */
+  void on_actionLoad_scene_triggered();
+
+  /**
+   * @brief on_actionBuild_pages_triggered Opens a file dialog to split a PLY
+   * mesh into pages next to it, and streams them out of core.
+   */
+  void on_actionBuild_pages_triggered();
+
+  /**
+   * @brief on_actionWeld_vertices_toggled Enables or disables the welding of
+   * the meshes loaded next.
+   */
+  void on_actionWeld_vertices_toggled(bool checked);
+
+  /**
+   * @brief on_actionSet_weld_epsilon_triggered Asks for the welding distance.
+   */
+  void on_actionSet_weld_epsilon_triggered();
+
+  /**
+   * @brief on_actionRelease_CPU_geometry_toggled Selects whether the CPU copy
+   * of the geometry is freed after the upload.
+   */
+  void on_actionRelease_CPU_geometry_toggled(bool checked);
+
+  /**
+   * @brief on_actionRecord_camera_path_toggled Starts or stops recording the
+   * camera path.
+   */
+  void on_actionRecord_camera_path_toggled(bool checked);
+
+  /**
+   * @brief on_actionSave_camera_path_triggered Opens a file dialog to store
+   * the recorded camera path.
+   */
+  void on_actionSave_camera_path_triggered();
+
+  /**
+   * @brief on_actionLoad_camera_path_triggered Opens a file dialog to load a
+   * camera path.
+   */
+  void on_actionLoad_camera_path_triggered();
+
+  /**
+   * @brief on_actionRun_benchmark_triggered Replays the camera path and
+   * reports the frame timings.
+   */
+  void on_actionRun_benchmark_triggered();
+
+  /**
+   * @brief on_actionCoalesce_input_frames_toggled Switches between coalesced
+   * and synchronous rendering of input events.
+   */
+  void on_actionCoalesce_input_frames_toggled(bool checked);
+
+  /**
+   * @brief on_actionDynamic_resolution_toggled Enables or disables the
+   * dynamic resolution scaling.
+   */
+  void on_actionDynamic_resolution_toggled(bool checked);
+
+  /**
+   * @brief on_actionRender_thread_toggled Moves the rendering to a dedicated
+   * thread, or back to the GUI thread.
+   */
+  void on_actionRender_thread_toggled(bool checked);
+
+  /**
+   * @brief on_actionSet_frame_budget_triggered Asks for the GPU frame time
+   * budget of the dynamic resolution.
+   */
+  void on_actionSet_frame_budget_triggered();
+
+  /**
+   * @brief on_actionSet_views_triggered Asks for the number of views rendered
+   * side by side.
+   */
+  void on_actionSet_views_triggered();
+
+  /**
+   * @brief on_actionReport_input_latency_triggered Prints the input latency
+   * histogram.
+   */
+  void on_actionReport_input_latency_triggered();
+
+  /**
+   * @brief on_actionReport_pass_timings_triggered Prints the GPU time of every
+   * render pass.
+   */
+  void on_actionReport_pass_timings_triggered();
+
+  /**
+   * @brief on_actionReport_memory_triggered Prints the CPU and GPU memory of
+   * every resource.
+   */
+  void on_actionReport_memory_triggered();
+
+  /**
+   * @brief on_actionRender_tiled_triggered Asks for an image size and a PGM
+   * file and renders the AO of the current view into it in tiles.
+   */
+  void on_actionRender_tiled_triggered();
+
+  /**
+   * @brief on_actionRun_radius_benchmark_triggered Times the fragment and
+   * compute HBAO for several radius values.
+   */
+  void on_actionRun_radius_benchmark_triggered();
+
+  /**
+   * @brief on_actionCompare_fast_hbao_triggered Prints the speedup and the
+   * error of the fast HBAO against the reference one.
+   */
+  void on_actionCompare_fast_hbao_triggered();
+
+  /**
+   * @brief on_actionRun_technique_benchmark_triggered Compares the cost and
+   * quality of every AO technique.
+   */
+  void on_actionRun_technique_benchmark_triggered();
+
+  /**
+   * @brief on_actionCompare_adaptive_ao_triggered Compares the selected AO
+   * technique with and without adaptive sampling.
+   */
+  void on_actionCompare_adaptive_ao_triggered();
+
+  /**
+   * @brief on_actionCompare_fused_blur_triggered Compares the separate and
+   * the fused AO and blur passes.
+   */
+  void on_actionCompare_fused_blur_triggered();
+
+  /**
+   * @brief on_actionCompare_vulkan_triggered Compares the throughput of the
+   * GL path and the Vulkan backend.
+   */
+  void on_actionCompare_vulkan_triggered();
+
+  /**
+   * @brief on_actionCompare_multi_view_triggered Compares the layered
+   * multi-view frame with one frame per view.
+   */
+  void on_actionCompare_multi_view_triggered();
+
+  /**
+   * @brief on_comboBox_technique_currentIndexChanged Shows the parameters of
+   * the selected AO technique with its labels.
+   */
+  void on_comboBox_technique_currentIndexChanged(int index);
+
  private:
   Ui::MainWindow *ui;
 };
@@ -0,0 +1,84 @@
+// Author: Marc Comino 2020
+
+#include <memory_stats.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+
+namespace data_visualization {
+
+void MemoryStats::Set(const std::string &name, size_t cpu_bytes, size_t gpu_bytes) {
+  auto it = std::find_if(resources_.begin(), resources_.end(),
+                         [&name](const MemoryResource &resource) { return resource.name == name; });
+  if (it == resources_.end()) {
+    resources_.emplace_back();
+    it = resources_.end() - 1;
+    it->name = name;
+  }
+
+  it->cpu_bytes = cpu_bytes;
+  it->gpu_bytes = gpu_bytes;
+  it->cpu_peak = std::max(it->cpu_peak, cpu_bytes);
+  it->gpu_peak = std::max(it->gpu_peak, gpu_bytes);
+
+  cpu_peak_ = std::max(cpu_peak_, CpuBytes());
+  gpu_peak_ = std::max(gpu_peak_, GpuBytes());
+}
+
+size_t MemoryStats::CpuBytes() const {
+  size_t bytes = 0;
+  for (const MemoryResource &kResource : resources_) bytes += kResource.cpu_bytes;
+  return bytes;
+}
+
+size_t MemoryStats::GpuBytes() const {
+  size_t bytes = 0;
+  for (const MemoryResource &kResource : resources_) bytes += kResource.gpu_bytes;
+  return bytes;
+}
+
+void MemoryStats::ResetPeaks() {
+  for (MemoryResource &resource : resources_) {
+    resource.cpu_peak = resource.cpu_bytes;
+    resource.gpu_peak = resource.gpu_bytes;
+  }
+  cpu_peak_ = CpuBytes();
+  gpu_peak_ = GpuBytes();
+}
+
+void MemoryStats::Print(std::ostream *out) const {
+  size_t name_width = 5;
+  for (const MemoryResource &kResource : resources_)
+    name_width = std::max(name_width, kResource.name.size());
+
+  *out << "Memory" << std::endl;
+  *out << "\t" << std::left << std::setw(static_cast<int>(name_width)) << "" << std::right
+       << std::setw(12) << "CPU" << std::setw(12) << "CPU peak" << std::setw(12) << "GPU"
+       << std::setw(12) << "GPU peak" << std::endl;
+  for (const MemoryResource &kResource : resources_) {
+    *out << "\t" << std::left << std::setw(static_cast<int>(name_width)) << kResource.name
+         << std::right << std::setw(12) << Format(kResource.cpu_bytes) << std::setw(12)
+         << Format(kResource.cpu_peak) << std::setw(12) << Format(kResource.gpu_bytes)
+         << std::setw(12) << Format(kResource.gpu_peak) << std::endl;
+  }
+  *out << "\t" << std::left << std::setw(static_cast<int>(name_width)) << "Total" << std::right
+       << std::setw(12) << Format(CpuBytes()) << std::setw(12) << Format(cpu_peak_)
+       << std::setw(12) << Format(GpuBytes()) << std::setw(12) << Format(gpu_peak_) << std::endl;
+}
+
+std::string MemoryStats::Format(size_t bytes) {
+  const char *kUnits[] = {"B", "KB", "MB", "GB", "TB"};
+  double value = static_cast<double>(bytes);
+  size_t unit = 0;
+  while (value >= 1024.0 && unit + 1 < sizeof(kUnits) / sizeof(kUnits[0])) {
+    value /= 1024.0;
+    ++unit;
+  }
+
+  char text[32];
+  snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", value, kUnits[unit]);
+  return text;
+}
+
+}  //  namespace data_visualization
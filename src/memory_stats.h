@@ -0,0 +1,72 @@
+// Author: Marc Comino 2020
+
+#ifndef MEMORY_STATS_H_
+#define MEMORY_STATS_H_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace data_visualization {
+
+/**
+ * @brief MemoryResource Bytes a resource holds in CPU and GPU memory, and the
+ * most it has held since the peaks were last reset.
+ */
+struct MemoryResource {
+  std::string name;
+  size_t cpu_bytes = 0;
+  size_t gpu_bytes = 0;
+  size_t cpu_peak = 0;
+  size_t gpu_peak = 0;
+};
+
+/**
+ * @brief MemoryStats Accounting of the memory held by named resources. The
+ * owners of the resources report their current size whenever it changes, and
+ * the totals keep their own peaks, which are lower than the sum of the
+ * resource peaks when resources peak at different times.
+ */
+class MemoryStats {
+ public:
+  /**
+   * @brief Set Updates the bytes of a resource, adding it the first time.
+   * @param name Name of the resource.
+   * @param cpu_bytes Bytes held in CPU memory.
+   * @param gpu_bytes Bytes held, or estimated, in GPU memory.
+   */
+  void Set(const std::string &name, size_t cpu_bytes, size_t gpu_bytes);
+
+  size_t CpuBytes() const;
+  size_t GpuBytes() const;
+  size_t cpu_peak() const { return cpu_peak_; }
+  size_t gpu_peak() const { return gpu_peak_; }
+
+  const std::vector<MemoryResource> &resources() const { return resources_; }
+
+  /**
+   * @brief ResetPeaks Sets every peak to the current value.
+   */
+  void ResetPeaks();
+
+  /**
+   * @brief Print Writes a table of the resources and the totals.
+   * @param out Output stream.
+   */
+  void Print(std::ostream *out) const;
+
+  /**
+   * @brief Format Bytes with a binary unit, e.g. "12.5 MB".
+   */
+  static std::string Format(size_t bytes);
+
+ private:
+  std::vector<MemoryResource> resources_;
+  size_t cpu_peak_ = 0;
+  size_t gpu_peak_ = 0;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  MEMORY_STATS_H_
@@ -2,11 +2,13 @@
 
 #include <mesh_io.h>
 
-#include <assert.h>
-
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -16,225 +18,394 @@ namespace data_representation {
 
 namespace {
 
-template <typename T>
-void Add3Items(T i1, T i2, T i3, size_t index, std::vector<T> *vector) {
-  (*vector)[index] = i1;
-  (*vector)[index + 1] = i2;
-  (*vector)[index + 2] = i3;
+/**
+ * @brief kMaxVertexBytes Largest binary vertex the readers accept.
+ */
+const int kMaxVertexBytes = 256;
+
+/**
+ * @brief kWriteBlock Bytes encoded by WriteToPly before writing them out.
+ */
+const size_t kWriteBlock = 1 << 20;
+
+/**
+ * @brief kIngestChunk Vertices or faces read per block by ReadFromPly. The
+ * faces of a block get their normals accumulated while they are still in
+ * cache.
+ */
+const size_t kIngestChunk = 1 << 16;
+
+/**
+ * @brief kFaceBytes Size of a binary triangle, a uchar count and three int
+ * indices.
+ */
+const size_t kFaceBytes = 1 + 3 * sizeof(int);
+
+/**
+ * @brief PlyTypeBytes Size of a PLY scalar type, 0 if unknown.
+ */
+int PlyTypeBytes(const std::string &type) {
+  if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+  if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+  if (type == "int" || type == "uint" || type == "float" || type == "int32" ||
+      type == "uint32" || type == "float32")
+    return 4;
+  if (type == "double" || type == "float64") return 8;
+  return 0;
 }
 
-bool ReadPlyHeader(std::ifstream *fin, int *vertices, int *faces, bool *binary) {
-  char line[100];
+/**
+ * @brief BlockWriter Gathers small writes into blocks of kWriteBlock bytes.
+ */
+class BlockWriter {
+ public:
+  explicit BlockWriter(std::ofstream *out) : out_(out) { block_.reserve(kWriteBlock); }
 
-  fin->getline(line, 100);
-  if (strncmp(line, "ply", 3) != 0) return false;
+  ~BlockWriter() { Flush(); }
 
-  *vertices = 0;
-  fin->getline(line, 100);
-  while (strncmp(line, "end_header", 10) != 0) {
-    if (strncmp(line, "format", 6) == 0)  *binary = strncmp(&line[7], "binary", 5) == 0;
-    else if (strncmp(line, "element vertex", 14) == 0) *vertices = atoi(&line[15]);
-    else if (strncmp(line, "element face", 12) == 0) *faces = atoi(&line[13]);
-    fin->getline(line, 100);
+  void Write(const void *data, size_t bytes) {
+    if (block_.size() + bytes > kWriteBlock) Flush();
+    const char *kBytes = static_cast<const char *>(data);
+    block_.insert(block_.end(), kBytes, kBytes + bytes);
   }
 
-  if (*vertices <= 0) return false;
+  /**
+   * @brief WriteText Writes a value in ASCII followed by a separator. Floats
+   * keep enough digits to be read back exactly.
+   */
+  void WriteText(float value, char separator) {
+    char text[32];
+    const int kLength = snprintf(text, sizeof(text), "%.9g%c", value, separator);
+    Write(text, static_cast<size_t>(kLength));
+  }
 
-  std::cout << "Loading triangle mesh" << std::endl;
-  std::cout << "\tVertices = " << *vertices << std::endl;
-  std::cout << "\tFaces = " << *faces << std::endl;
+  void WriteText(int value, char separator) {
+    char text[16];
+    const int kLength = snprintf(text, sizeof(text), "%d%c", value, separator);
+    Write(text, static_cast<size_t>(kLength));
+  }
 
-  return true;
-}
+  void Flush() {
+    out_->write(block_.data(), static_cast<std::streamsize>(block_.size()));
+    block_.clear();
+  }
 
-void ReadPlyVerticesBinary(std::ifstream *fin, TriangleMesh *mesh) {
-  const size_t kVertices = mesh->vertices_.size() / 3;
-  for (size_t i = 0; i < kVertices; ++i) {
-    float x, y, z;
-    fin->read(reinterpret_cast<char *>(&x), sizeof(float));
-    fin->read(reinterpret_cast<char *>(&y), sizeof(float));
-    fin->read(reinterpret_cast<char *>(&z), sizeof(float));
+ private:
+  std::ofstream *out_;
+  std::vector<char> block_;
+};
+
+/**
+ * @brief AccumulateFaceNormals Adds the unit normal of every face in [begin,
+ * end), weighted by the angle of each corner, to the normals of its vertices.
+ */
+void AccumulateFaceNormals(const std::vector<float> &vertices, const std::vector<int> &faces,
+                           size_t begin, size_t end, std::vector<float> *normals) {
+  for (size_t f = begin; f < end; ++f) {
+    const int *kFace = &faces[f * 3];
+    const Eigen::Vector3d kCorners[3] = {
+        Eigen::Map<const Eigen::Vector3f>(&vertices[kFace[0] * 3]).cast<double>(),
+        Eigen::Map<const Eigen::Vector3f>(&vertices[kFace[1] * 3]).cast<double>(),
+        Eigen::Map<const Eigen::Vector3f>(&vertices[kFace[2] * 3]).cast<double>()};
+    const Eigen::Vector3d kEdges[3] = {kCorners[1] - kCorners[0], kCorners[2] - kCorners[1],
+                                       kCorners[0] - kCorners[2]};
+
+    Eigen::Vector3d normal = kEdges[0].cross(-kEdges[2]);
+    if (normal.norm() < 0.00001) continue;  // Adds nothing.
+    const Eigen::Vector3f kNormal = normal.normalized().cast<float>();
 
-    Add3Items(x, y, z, i * 3, &(mesh->vertices_));
+    for (size_t j = 0; j < 3; ++j) {
+      // Angle between the edges leaving corner j.
+      const Eigen::Vector3d &kNext = kEdges[j];
+      const Eigen::Vector3d kPrevious = -kEdges[(j + 2) % 3];
+      const double kAngle = acos(kNext.dot(kPrevious) / (kNext.norm() * kPrevious.norm()));
+      if (kAngle != kAngle) continue;  // NaN, from a zero length edge.
+
+      float *normal_j = &(*normals)[static_cast<size_t>(kFace[j]) * 3];
+      for (size_t k = 0; k < 3; ++k) normal_j[k] += kNormal[k] * kAngle;
+    }
   }
 }
 
-void ReadPlyVerticesASCII(std::ifstream *fin, TriangleMesh *mesh) {
-  const size_t kVertices = mesh->vertices_.size() / 3;
-  for (size_t i = 0; i < kVertices; ++i) {
-    float x, y, z;
-
-    *fin >> x;
-    *fin >> y;
-    *fin >> z;
+void NormalizeNormals(std::vector<float> *normals, TaskScheduler *scheduler) {
+  const size_t kNormals = normals->size() / 3;
+  const size_t kChunks = (scheduler != nullptr ? scheduler : &TaskScheduler::Default())->chunks();
+  ParallelFor(scheduler, kNormals, kChunks, [normals](size_t, size_t begin, size_t end) {
+    for (size_t i = begin * 3; i < end * 3; i += 3) {
+      Eigen::Vector3d normal((*normals)[i], (*normals)[i + 1], (*normals)[i + 2]);
+      if (normal.norm() > 0) {
+        normal.normalize();
+      } else {
+        normal = Eigen::Vector3d(0, 0, 0);
+      }
 
-    Add3Items(x, y, z, i * 3, &(mesh->vertices_));
-  }
+      for (size_t j = 0; j < 3; ++j) (*normals)[i + j] = normal[j];
+    }
+  });
 }
 
-void ReadPlyFacesBinary(std::ifstream *fin, TriangleMesh *mesh) {
-  unsigned char vertex_per_face;
+/**
+ * @brief ReadPlyVertices Reads every vertex position into the mesh and grows
+ * its bounding box with them. Binary vertices are read in blocks.
+ */
+bool ReadPlyVertices(std::ifstream *fin, const PlyHeader &header, TriangleMesh *mesh) {
+  const size_t kVertices = mesh->vertices_.size() / 3;
+  std::vector<char> block(header.binary ? kIngestChunk * header.vertex_bytes : 0);
+
+  for (size_t first = 0; first < kVertices; first += kIngestChunk) {
+    const size_t kCount = std::min(kIngestChunk, kVertices - first);
+    if (header.binary && !fin->read(block.data(), static_cast<std::streamsize>(kCount * header.vertex_bytes)))
+      return false;
+
+    for (size_t i = first; i < first + kCount; ++i) {
+      float *position = &mesh->vertices_[i * 3];
+      if (header.binary) {
+        const char *kVertex = &block[(i - first) * header.vertex_bytes];
+        for (int j = 0; j < 3; ++j)
+          std::memcpy(&position[j], kVertex + header.position_offset[j], sizeof(float));
+      } else if (!ReadPlyVertex(fin, header, position)) {
+        return false;
+      }
 
-  const size_t kFaces = mesh->faces_.size() / 3;
-  for (size_t i = 0; i < kFaces; ++i) {
-    int v1, v2, v3;
-    fin->read(reinterpret_cast<char *>(&vertex_per_face),
-              sizeof(unsigned char));
-    assert(vertex_per_face == 3);
-
-    fin->read(reinterpret_cast<char *>(&v1), sizeof(int));
-    fin->read(reinterpret_cast<char *>(&v2), sizeof(int));
-    fin->read(reinterpret_cast<char *>(&v3), sizeof(int));
-    Add3Items(v1, v2, v3, i * 3, &(mesh->faces_));
+      const Eigen::Map<const Eigen::Vector3f> kPosition(position);
+      mesh->min_ = mesh->min_.cwiseMin(kPosition);
+      mesh->max_ = mesh->max_.cwiseMax(kPosition);
+    }
   }
-}
 
-void ReadPlyFacesASCII(std::ifstream *fin, TriangleMesh *mesh) {
-  unsigned int vertex_per_face;
+  return true;
+}
 
+/**
+ * @brief ReadPlyFaces Reads the triangles in blocks. The normals of a block
+ * are accumulated by a task while the next one is read, one block at a time
+ * and in order, so the sums are the same as when loading serially. The
+ * vertices must have been read.
+ * @return Whether every face is a triangle of valid vertex indices.
+ */
+bool ReadPlyFaces(std::ifstream *fin, const PlyHeader &header, TriangleMesh *mesh,
+                  TaskScheduler *scheduler) {
   const size_t kFaces = mesh->faces_.size() / 3;
-  for (size_t i = 0; i < kFaces; ++i) {
-    int v1, v2, v3;
-    *fin >> vertex_per_face;
-    assert(vertex_per_face == 3);
+  const int kVertices = header.vertices;
+  std::vector<char> block(header.binary ? kIngestChunk * kFaceBytes : 0);
+  TaskGroup accumulation(scheduler);
+
+  for (size_t first = 0; first < kFaces; first += kIngestChunk) {
+    const size_t kCount = std::min(kIngestChunk, kFaces - first);
+    if (header.binary && !fin->read(block.data(), static_cast<std::streamsize>(kCount * kFaceBytes)))
+      return false;
+
+    for (size_t i = first; i < first + kCount; ++i) {
+      int *face = &mesh->faces_[i * 3];
+      unsigned int vertex_per_face;
+      if (header.binary) {
+        const char *kFace = &block[(i - first) * kFaceBytes];
+        vertex_per_face = static_cast<unsigned char>(kFace[0]);
+        std::memcpy(face, kFace + 1, 3 * sizeof(int));
+      } else if (!(*fin >> vertex_per_face >> face[0] >> face[1] >> face[2])) {
+        return false;
+      }
 
-    *fin >> v1;
-    *fin >> v2;
-    *fin >> v3;
+      if (vertex_per_face != 3) return false;
+      for (int j = 0; j < 3; ++j)
+        if (face[j] < 0 || face[j] >= kVertices) return false;
+    }
 
-    Add3Items(v1, v2, v3, i * 3, &(mesh->faces_));
+    accumulation.Wait();
+    accumulation.Run([mesh, first, kCount]() {
+      AccumulateFaceNormals(mesh->vertices_, mesh->faces_, first, first + kCount, &mesh->normals_);
+    });
   }
-}
 
-void ComputeVertexNormals(const std::vector<float> &vertices,
-                          const std::vector<int> &faces,
-                          std::vector<float> *normals) {
-  const size_t kFaces = faces.size();
-  std::vector<float> face_normals(kFaces, 0);
-
-  for (size_t i = 0; i < kFaces; i += 3) {
-    Eigen::Vector3d v1(vertices[faces[i] * 3], vertices[faces[i] * 3 + 1],
-                       vertices[faces[i] * 3 + 2]);
-    Eigen::Vector3d v2(vertices[faces[i + 1] * 3],
-                       vertices[faces[i + 1] * 3 + 1],
-                       vertices[faces[i + 1] * 3 + 2]);
-    Eigen::Vector3d v3(vertices[faces[i + 2] * 3],
-                       vertices[faces[i + 2] * 3 + 1],
-                       vertices[faces[i + 2] * 3 + 2]);
-    Eigen::Vector3d v1v2 = v2 - v1;
-    Eigen::Vector3d v1v3 = v3 - v1;
-    Eigen::Vector3d normal = v1v2.cross(v1v3);
-
-    if (normal.norm() < 0.00001) {
-      normal = Eigen::Vector3d(0.0, 0.0, 0.0);
-    } else {
-      normal.normalize();
-    }
+  return accumulation.Wait();
+}
 
-    for (size_t j = 0; j < 3; ++j) face_normals[i + j] = normal[j];
-  }
+}  // namespace
 
-  const size_t kVertices = vertices.size();
-  normals->resize(kVertices, 0);
-  for (size_t i = 0; i < kFaces; i += 3) {
-    for (size_t j = 0; j < 3; ++j) {
-      size_t idx = static_cast<size_t>(faces[i + j]);
-      Eigen::Vector3d v1(vertices[faces[i + j] * 3],
-                         vertices[faces[i + j] * 3 + 1],
-                         vertices[faces[i + j] * 3 + 2]);
-      Eigen::Vector3d v2(vertices[faces[i + (j + 1) % 3] * 3],
-                         vertices[faces[i + (j + 1) % 3] * 3 + 1],
-                         vertices[faces[i + (j + 1) % 3] * 3 + 2]);
-      Eigen::Vector3d v3(vertices[faces[i + (j + 2) % 3] * 3],
-                         vertices[faces[i + (j + 2) % 3] * 3 + 1],
-                         vertices[faces[i + (j + 2) % 3] * 3 + 2]);
-
-      Eigen::Vector3d v1v2 = v2 - v1;
-      Eigen::Vector3d v1v3 = v3 - v1;
-      double angle = acos(v1v2.dot(v1v3) / (v1v2.norm() * v1v3.norm()));
-
-      if (angle == angle) {
-        for (size_t k = 0; k < 3; ++k) {
-          (*normals)[idx * 3 + k] += face_normals[i + k] * angle;
+bool ReadPlyHeader(std::ifstream *fin, PlyHeader *header, std::ostream *log) {
+  *header = PlyHeader();
+
+  std::string line;
+  std::getline(*fin, line);
+  if (line.compare(0, 3, "ply") != 0) return false;
+
+  const char *kAxes[] = {"x", "y", "z"};
+  bool found[3] = {false, false, false};
+  std::string element;
+  while (std::getline(*fin, line) && line.compare(0, 10, "end_header") != 0) {
+    std::istringstream tokens(line);
+    std::string keyword;
+    tokens >> keyword;
+
+    if (keyword == "format") {
+      std::string format;
+      tokens >> format;
+      header->binary = format.compare(0, 6, "binary") == 0;
+    } else if (keyword == "element") {
+      int count = 0;
+      tokens >> element >> count;
+      if (element == "vertex") header->vertices = count;
+      else if (element == "face") header->faces = count;
+    } else if (keyword == "property" && element == "vertex") {
+      std::string type, name;
+      tokens >> type >> name;
+      const int kBytes = PlyTypeBytes(type);
+      if (kBytes == 0) return false;  // Lists per vertex are not supported.
+
+      for (int i = 0; i < 3; ++i) {
+        if (name == kAxes[i]) {
+          if (kBytes != 4 || type.compare(0, 5, "float") != 0) return false;
+          header->position[i] = header->vertex_properties;
+          header->position_offset[i] = header->vertex_bytes;
+          found[i] = true;
         }
       }
+      ++header->vertex_properties;
+      header->vertex_bytes += kBytes;
     }
   }
 
-  const size_t kNormals = normals->size();
-  for (size_t i = 0; i < kNormals; i += 3) {
-    Eigen::Vector3d normal((*normals)[i], (*normals)[i + 1], (*normals)[i + 2]);
-    if (normal.norm() > 0) {
-      normal.normalize();
-    } else {
-      normal = Eigen::Vector3d(0, 0, 0);
-    }
+  if (header->vertices <= 0 || !found[0] || !found[1] || !found[2] ||
+      header->vertex_bytes > kMaxVertexBytes)
+    return false;
 
-    for (size_t j = 0; j < 3; ++j) (*normals)[i + j] = normal[j];
-  }
+  *log << "Loading triangle mesh" << std::endl;
+  *log << "\tVertices = " << header->vertices << std::endl;
+  *log << "\tFaces = " << header->faces << std::endl;
+
+  return true;
 }
 
-void ComputeBoundingBox(const std::vector<float> vertices, TriangleMesh *mesh) {
-  const size_t kVertices = vertices.size() / 3;
-  for (size_t i = 0; i < kVertices; ++i) {
-    mesh->min_[0] = std::min(mesh->min_[0], vertices[i * 3]);
-    mesh->min_[1] = std::min(mesh->min_[1], vertices[i * 3 + 1]);
-    mesh->min_[2] = std::min(mesh->min_[2], vertices[i * 3 + 2]);
+bool ReadPlyVertex(std::ifstream *fin, const PlyHeader &header, float *position) {
+  if (header.binary) {
+    char vertex[kMaxVertexBytes];
+    if (!fin->read(vertex, header.vertex_bytes)) return false;
+    for (int i = 0; i < 3; ++i)
+      std::memcpy(&position[i], vertex + header.position_offset[i], sizeof(float));
+    return true;
+  }
 
-    mesh->max_[0] = std::max(mesh->max_[0], vertices[i * 3]);
-    mesh->max_[1] = std::max(mesh->max_[1], vertices[i * 3 + 1]);
-    mesh->max_[2] = std::max(mesh->max_[2], vertices[i * 3 + 2]);
+  for (int p = 0; p < header.vertex_properties; ++p) {
+    float value;
+    if (!(*fin >> value)) return false;
+    for (int i = 0; i < 3; ++i)
+      if (header.position[i] == p) position[i] = value;
   }
+  return true;
 }
 
-}  // namespace
+void ComputeVertexNormals(const std::vector<float> &vertices,
+                          const std::vector<int> &faces,
+                          std::vector<float> *normals,
+                          TaskScheduler *scheduler) {
+  normals->assign(vertices.size(), 0);
+  AccumulateFaceNormals(vertices, faces, 0, faces.size() / 3, normals);
+  NormalizeNormals(normals, scheduler);
+}
 
-bool ReadFromPly(const std::string &filename, TriangleMesh *mesh) {
+bool ReadFromPly(const std::string &filename, TriangleMesh *mesh,
+                 TaskScheduler *scheduler, std::ostream *log) {
+  const auto kStart = std::chrono::steady_clock::now();
   std::ifstream fin;
 
   fin.open(filename.c_str(), std::ios_base::in | std::ios_base::binary);
   if (!fin.is_open() || !fin.good()) return false;
 
-  int vertices = 0, faces = 0;
-  bool binary;
-  if (!ReadPlyHeader(&fin, &vertices, &faces, &binary)) {
+  PlyHeader header;
+  if (!ReadPlyHeader(&fin, &header, log)) {
     fin.close();
     return false;
   }
 
-  mesh->vertices_.resize(static_cast<size_t>(vertices) * 3);
-  if (binary) {
-    ReadPlyVerticesBinary(&fin, mesh);
-  } else {
-    ReadPlyVerticesASCII(&fin, mesh);
-  }
+  // Every array gets its final size once, so that nothing is reallocated or
+  // copied while loading. Swapping drops the capacity of a reused mesh.
+  mesh->Clear();
+  std::vector<float>(static_cast<size_t>(header.vertices) * 3).swap(mesh->vertices_);
+  std::vector<int>(static_cast<size_t>(header.faces) * 3).swap(mesh->faces_);
+  std::vector<float>(mesh->vertices_.size(), 0.0f).swap(mesh->normals_);
 
-  mesh->faces_.resize(static_cast<size_t>(faces) * 3);
-  if (binary) {
-    ReadPlyFacesBinary(&fin, mesh);
-  } else {
-    ReadPlyFacesASCII(&fin, mesh);
+  const bool kRead = ReadPlyVertices(&fin, header, mesh) && ReadPlyFaces(&fin, header, mesh, scheduler);
+  fin.close();
+  if (!kRead) {
+    std::cerr << "Invalid or truncated PLY data in " << filename << std::endl;
+    mesh->Clear();
+    return false;
   }
 
-  fin.close();
+  NormalizeNormals(&mesh->normals_, scheduler);
 
-  ComputeVertexNormals(mesh->vertices_, mesh->faces_, &mesh->normals_);
-  ComputeBoundingBox(mesh->vertices_, mesh);
+  const size_t kBytes = (mesh->vertices_.size() + mesh->normals_.size()) * sizeof(float) +
+                        mesh->faces_.size() * sizeof(int);
+  *log << "\tLoaded in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count()
+            << " ms, " << kBytes / (1024.0 * 1024.0) << " MB" << std::endl;
 
   return true;
 }
 
-bool WriteToPly(const std::string &filename, const TriangleMesh &mesh) {
-  (void)filename;
-  (void)mesh;
-
-  std::cerr << "Not yet implemented" << std::endl;
+bool WriteToPly(const std::string &filename, const TriangleMesh &mesh,
+                const PlyWriteOptions &options) {
+  const size_t kVertices = mesh.vertices_.size() / 3;
+  const size_t kFaces = mesh.faces_.size() / 3;
+  const bool kNormals = options.normals && mesh.normals_.size() == mesh.vertices_.size();
+  for (const PlyAttribute &kAttribute : options.attributes) {
+    if (kAttribute.values.size() != kVertices) {
+      std::cerr << "Attribute " << kAttribute.name << " has " << kAttribute.values.size()
+                << " values for " << kVertices << " vertices" << std::endl;
+      return false;
+    }
+  }
 
-  // TODO(students): Implement storing to PLY format.
+  std::ofstream out(filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!out.is_open()) return false;
+
+  // Binary files are written in the host byte order, which the readers also
+  // assume.
+  out << "ply\n";
+  out << "format " << (options.binary ? "binary_little_endian" : "ascii") << " 1.0\n";
+  out << "element vertex " << kVertices << "\n";
+  out << "property float x\nproperty float y\nproperty float z\n";
+  if (kNormals) out << "property float nx\nproperty float ny\nproperty float nz\n";
+  for (const PlyAttribute &kAttribute : options.attributes)
+    out << "property float " << kAttribute.name << "\n";
+  out << "element face " << kFaces << "\n";
+  out << "property list uchar int vertex_indices\n";
+  out << "end_header\n";
+
+  BlockWriter writer(&out);
+
+  std::vector<float> vertex;
+  for (size_t i = 0; i < kVertices; ++i) {
+    vertex.assign(mesh.vertices_.begin() + i * 3, mesh.vertices_.begin() + i * 3 + 3);
+    if (kNormals)
+      vertex.insert(vertex.end(), mesh.normals_.begin() + i * 3, mesh.normals_.begin() + i * 3 + 3);
+    for (const PlyAttribute &kAttribute : options.attributes)
+      vertex.push_back(kAttribute.values[i]);
+
+    if (options.binary) {
+      writer.Write(vertex.data(), vertex.size() * sizeof(float));
+    } else {
+      for (size_t j = 0; j < vertex.size(); ++j)
+        writer.WriteText(vertex[j], j + 1 < vertex.size() ? ' ' : '\n');
+    }
+  }
 
-  // END.
+  for (size_t i = 0; i < kFaces; ++i) {
+    const int *kFace = &mesh.faces_[i * 3];
+    if (options.binary) {
+      char face[1 + 3 * sizeof(int)];
+      face[0] = 3;
+      std::memcpy(face + 1, kFace, 3 * sizeof(int));
+      writer.Write(face, sizeof(face));
+    } else {
+      writer.WriteText(3, ' ');
+      writer.WriteText(kFace[0], ' ');
+      writer.WriteText(kFace[1], ' ');
+      writer.WriteText(kFace[2], '\n');
+    }
+  }
 
-  return false;
+  writer.Flush();
+  return static_cast<bool>(out);
 }
 
 }  // namespace data_representation
@@ -3,29 +3,127 @@
 #ifndef MESH_IO_H_
 #define MESH_IO_H_
 
+#include <task_scheduler.h>
 #include <triangle_mesh.h>
 
+#include <fstream>
+#include <iostream>
 #include <string>
+#include <vector>
 
 namespace data_representation {
 
+/**
+ * @brief PlyHeader Element counts and vertex layout of a PLY file. Vertex
+ * properties other than the float position, such as normals or colors, are
+ * skipped by the readers.
+ */
+struct PlyHeader {
+  int vertices = 0;
+  int faces = 0;
+  bool binary = false;
+
+  /**
+   * @brief vertex_properties Properties per vertex, and vertex_bytes the size
+   * of a binary vertex.
+   */
+  int vertex_properties = 0;
+  int vertex_bytes = 0;
+
+  /**
+   * @brief position Property index of x, y and z, and position_offset their
+   * byte offset in a binary vertex.
+   */
+  int position[3] = {0, 1, 2};
+  int position_offset[3] = {0, 4, 8};
+};
+
+/**
+ * @brief ReadPlyHeader Reads the header of a PLY file, leaving the stream at
+ * the first vertex.
+ * @param fin Stream opened in binary mode.
+ * @param header The element counts and vertex layout.
+ * @param log Stream the element counts are printed to.
+ * @return Whether it is a PLY file with float vertex positions.
+ */
+bool ReadPlyHeader(std::ifstream *fin, PlyHeader *header, std::ostream *log = &std::cout);
+
+/**
+ * @brief ReadPlyVertex Reads the position of the next vertex.
+ * @param fin Stream after the header or the previous vertex.
+ * @param header Header of the file.
+ * @param position The x, y and z of the vertex.
+ * @return Whether the vertex could be read.
+ */
+bool ReadPlyVertex(std::ifstream *fin, const PlyHeader &header, float *position);
+
+/**
+ * @brief ComputeVertexNormals Angle weighted per-vertex normals. The sums
+ * are accumulated in face order, so they do not depend on the threads, and
+ * normalized in parallel.
+ * @param vertices Vertex positions, 3 floats each.
+ * @param faces Triangle vertex indices.
+ * @param normals The resulting normals, 3 floats per vertex.
+ * @param scheduler Scheduler of the normalization, nullptr for the default
+ * one.
+ */
+void ComputeVertexNormals(const std::vector<float> &vertices,
+                          const std::vector<int> &faces,
+                          std::vector<float> *normals,
+                          TaskScheduler *scheduler = nullptr);
+
 /**
  * @brief ReadFromPly Read the mesh stored in PLY format at the path filename
- * and stores the corresponding TriangleMesh representation
+ * and stores the corresponding TriangleMesh representation. The bounding box
+ * is grown while the vertices are parsed and the normals are accumulated as
+ * the faces are read, with every array allocated once at its final size.
+ * The normals of a block of faces are accumulated by a task while the next
+ * block is parsed.
  * @param filename The path to the PLY mesh.
  * @param mesh The resulting representation with computed per-vertex normals.
- * @return Whether it was able to read the file.
+ * @param scheduler Runs the normal tasks, nullptr for the default one.
+ * @param log Stream the counts and load time are printed to. Loaders running
+ * concurrently can pass a buffer of their own and print it when done.
+ * @return Whether it was able to read the file, and all of its faces are
+ * triangles of valid vertex indices.
+ */
+bool ReadFromPly(const std::string &filename, TriangleMesh *mesh,
+                 TaskScheduler *scheduler = nullptr, std::ostream *log = &std::cout);
+
+/**
+ * @brief PlyAttribute Extra float property written for every vertex, such as
+ * a baked AO term.
  */
-bool ReadFromPly(const std::string &filename, TriangleMesh *mesh);
+struct PlyAttribute {
+  std::string name;
+  std::vector<float> values;  // One per vertex.
+};
+
+/**
+ * @brief PlyWriteOptions Encoding and vertex properties of WriteToPly.
+ */
+struct PlyWriteOptions {
+  bool binary = true;
+
+  /**
+   * @brief normals Whether to write nx, ny and nz, if the mesh has normals.
+   */
+  bool normals = true;
+
+  std::vector<PlyAttribute> attributes;
+};
 
 /**
  * @brief WriteToPly Stores the mesh representation in PLY format at the path
- * filename.
+ * filename. Elements are encoded into large blocks before they are handed to
+ * the stream, so that writing is bound by the disk.
  * @param filename The path where the mesh will be stored.
  * @param mesh The mesh to be stored.
+ * @param options Encoding and vertex properties.
  * @return Whether it was able to store the file.
  */
-bool WriteToPly(const std::string &filename, const TriangleMesh &mesh);
+bool WriteToPly(const std::string &filename, const TriangleMesh &mesh,
+                const PlyWriteOptions &options = PlyWriteOptions());
 
 }  // namespace data_representation
 
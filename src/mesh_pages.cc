@@ -0,0 +1,348 @@
+// Author: Marc Comino 2020
+
+#include <mesh_pages.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./mesh_io.h"
+
+namespace data_representation {
+
+namespace {
+
+const char kMagic[8] = {'H', 'B', 'A', 'O', 'P', 'G', '0', '1'};
+
+/**
+ * @brief kPageEntryBytes Size of a page in the page table: offset, vertex and
+ * index counts and bounding box.
+ */
+const uint64_t kPageEntryBytes = sizeof(uint64_t) + 2 * sizeof(uint32_t) + 6 * sizeof(float);
+
+/**
+ * @brief kFlushFaces Faces buffered per grid cell before writing them to the
+ * scratch file.
+ */
+const size_t kFlushFaces = 256;
+
+/**
+ * @brief kMaxCellsPerAxis Bounds the memory of the per cell buffers.
+ */
+const int kMaxCellsPerAxis = 32;
+
+template <typename T>
+void Write(std::ostream *out, const T &value) {
+  out->write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+bool Read(std::istream *in, T *value) {
+  return static_cast<bool>(in->read(reinterpret_cast<char *>(value), sizeof(T)));
+}
+
+void WriteVector3f(std::ostream *out, const Eigen::Vector3f &v) {
+  for (int i = 0; i < 3; ++i) Write(out, v[i]);
+}
+
+bool ReadVector3f(std::istream *in, Eigen::Vector3f *v) {
+  for (int i = 0; i < 3; ++i)
+    if (!Read(in, &(*v)[i])) return false;
+  return true;
+}
+
+// Same layout as ReadPlyFacesBinary / ReadPlyFacesASCII.
+bool ReadFace(std::ifstream *fin, bool binary, int *v) {
+  if (binary) {
+    unsigned char vertex_per_face;
+    fin->read(reinterpret_cast<char *>(&vertex_per_face), sizeof(unsigned char));
+    fin->read(reinterpret_cast<char *>(v), 3 * sizeof(int));
+    return static_cast<bool>(*fin) && vertex_per_face == 3;
+  }
+
+  unsigned int vertex_per_face;
+  *fin >> vertex_per_face >> v[0] >> v[1] >> v[2];
+  return static_cast<bool>(*fin) && vertex_per_face == 3;
+}
+
+/**
+ * @brief Grid Uniform grid over the mesh bounding box with roughly one cell
+ * per page.
+ */
+struct Grid {
+  Grid(const Eigen::Vector3f &min, const Eigen::Vector3f &max, size_t cells)
+      : min(min) {
+    const Eigen::Vector3f kExtent = (max - min).cwiseMax(Eigen::Vector3f::Constant(1e-6f));
+    const float kCellSize = std::cbrt(kExtent.prod() / static_cast<float>(std::max<size_t>(cells, 1)));
+    for (int i = 0; i < 3; ++i) {
+      dims[i] = std::min(kMaxCellsPerAxis, std::max(1, static_cast<int>(std::ceil(kExtent[i] / kCellSize))));
+      scale[i] = dims[i] / kExtent[i];
+    }
+  }
+
+  size_t Cells() const { return static_cast<size_t>(dims[0]) * dims[1] * dims[2]; }
+
+  size_t Cell(const Eigen::Vector3f &p) const {
+    int c[3];
+    for (int i = 0; i < 3; ++i)
+      c[i] = std::min(dims[i] - 1, std::max(0, static_cast<int>((p[i] - min[i]) * scale[i])));
+    return (static_cast<size_t>(c[2]) * dims[1] + c[1]) * dims[0] + c[0];
+  }
+
+  Eigen::Vector3f min;
+  Eigen::Vector3f scale;
+  int dims[3];
+};
+
+size_t FaceCell(const Grid &grid, const std::vector<float> &positions, const int *v) {
+  Eigen::Vector3f centroid = Eigen::Vector3f::Zero();
+  for (int i = 0; i < 3; ++i)
+    centroid += Eigen::Vector3f(positions[v[i] * 3], positions[v[i] * 3 + 1], positions[v[i] * 3 + 2]);
+  return grid.Cell(centroid / 3.0f);
+}
+
+/**
+ * @brief WritePage Re-indexes a chunk of faces to its own vertices and
+ * appends it to the paged mesh.
+ */
+void WritePage(const std::vector<float> &positions, const std::vector<uint32_t> &faces,
+               std::ofstream *out, PageInfo *info) {
+  std::unordered_map<uint32_t, int> local;
+  std::vector<float> vertices;
+  std::vector<int> indices;
+  indices.reserve(faces.size());
+  for (uint32_t global : faces) {
+    auto it = local.find(global);
+    if (it == local.end()) {
+      it = local.emplace(global, static_cast<int>(vertices.size() / 3)).first;
+      vertices.insert(vertices.end(), &positions[global * 3], &positions[global * 3] + 3);
+    }
+    indices.push_back(it->second);
+  }
+
+  std::vector<float> normals;
+  ComputeVertexNormals(vertices, indices, &normals);
+
+  info->offset = static_cast<uint64_t>(out->tellp());
+  info->vertices = static_cast<uint32_t>(vertices.size() / 3);
+  info->indices = static_cast<uint32_t>(indices.size());
+  info->min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  info->max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  for (size_t i = 0; i < vertices.size(); i += 3) {
+    const Eigen::Vector3f kVertex(vertices[i], vertices[i + 1], vertices[i + 2]);
+    info->min = info->min.cwiseMin(kVertex);
+    info->max = info->max.cwiseMax(kVertex);
+  }
+
+  out->write(reinterpret_cast<const char *>(vertices.data()), vertices.size() * sizeof(float));
+  out->write(reinterpret_cast<const char *>(normals.data()), normals.size() * sizeof(float));
+  out->write(reinterpret_cast<const char *>(indices.data()), indices.size() * sizeof(int));
+}
+
+void WriteTable(const Eigen::Vector3f &min, const Eigen::Vector3f &max,
+                const std::vector<PageInfo> &pages, std::ofstream *out) {
+  out->write(kMagic, sizeof(kMagic));
+  Write(out, static_cast<uint32_t>(pages.size()));
+  WriteVector3f(out, min);
+  WriteVector3f(out, max);
+  for (const PageInfo &kPage : pages) {
+    Write(out, kPage.offset);
+    Write(out, kPage.vertices);
+    Write(out, kPage.indices);
+    WriteVector3f(out, kPage.min);
+    WriteVector3f(out, kPage.max);
+  }
+}
+
+}  // namespace
+
+bool BuildPages(const std::string &ply_filename, const std::string &pages_filename,
+                size_t page_triangles) {
+  std::ifstream fin(ply_filename.c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!fin.is_open() || !fin.good()) return false;
+
+  PlyHeader header;
+  if (!ReadPlyHeader(&fin, &header) || header.faces <= 0) return false;
+  const int kVertices = header.vertices;
+  const int kFaces = header.faces;
+  const bool kBinary = header.binary;
+
+  // Positions are needed to place and re-index the faces, 12 bytes per vertex.
+  std::vector<float> positions(static_cast<size_t>(kVertices) * 3);
+  Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  for (size_t i = 0; i < static_cast<size_t>(kVertices); ++i) {
+    if (!ReadPlyVertex(&fin, header, &positions[i * 3])) return false;
+    const Eigen::Vector3f kVertex(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+    min = min.cwiseMin(kVertex);
+    max = max.cwiseMax(kVertex);
+  }
+
+  const std::streampos kFacesStart = fin.tellg();
+  const Grid kGrid(min, max, static_cast<size_t>(kFaces) / std::max<size_t>(page_triangles, 1));
+
+  // Counts the faces per cell, to give every cell a contiguous range of the
+  // scratch file.
+  std::vector<uint64_t> cell_faces(kGrid.Cells(), 0);
+  for (int i = 0; i < kFaces; ++i) {
+    int v[3];
+    if (!ReadFace(&fin, kBinary, v)) return false;
+    for (int j = 0; j < 3; ++j)
+      if (v[j] < 0 || v[j] >= kVertices) return false;
+    ++cell_faces[FaceCell(kGrid, positions, v)];
+  }
+
+  std::vector<uint64_t> cell_start(kGrid.Cells(), 0);
+  for (size_t c = 1; c < kGrid.Cells(); ++c)
+    cell_start[c] = cell_start[c - 1] + cell_faces[c - 1];
+
+  const std::string kScratchFilename = pages_filename + ".tmp";
+  std::fstream scratch(kScratchFilename.c_str(),
+                       std::ios_base::in | std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!scratch.is_open()) return false;
+
+  std::vector<std::vector<uint32_t>> buffers(kGrid.Cells());
+  std::vector<uint64_t> written(kGrid.Cells(), 0);
+  auto flush = [&](size_t cell) {
+    scratch.seekp(static_cast<std::streamoff>((cell_start[cell] + written[cell]) * 3 * sizeof(uint32_t)));
+    scratch.write(reinterpret_cast<const char *>(buffers[cell].data()), buffers[cell].size() * sizeof(uint32_t));
+    written[cell] += buffers[cell].size() / 3;
+    buffers[cell].clear();
+  };
+
+  fin.clear();
+  fin.seekg(kFacesStart);
+  for (int i = 0; i < kFaces; ++i) {
+    int v[3];
+    ReadFace(&fin, kBinary, v);
+    const size_t kCell = FaceCell(kGrid, positions, v);
+    buffers[kCell].insert(buffers[kCell].end(), v, v + 3);
+    if (buffers[kCell].size() >= kFlushFaces * 3) flush(kCell);
+  }
+  for (size_t c = 0; c < kGrid.Cells(); ++c)
+    if (!buffers[c].empty()) flush(c);
+  fin.close();
+
+  // Pages, cell by cell. The table goes first, so it is written twice.
+  size_t pages_count = 0;
+  for (size_t c = 0; c < kGrid.Cells(); ++c)
+    pages_count += (cell_faces[c] + page_triangles - 1) / page_triangles;
+
+  std::ofstream out(pages_filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!out.is_open()) return false;
+
+  std::vector<PageInfo> pages(pages_count);
+  WriteTable(min, max, pages, &out);
+
+  size_t page = 0;
+  std::vector<uint32_t> chunk;
+  for (size_t c = 0; c < kGrid.Cells(); ++c) {
+    scratch.seekg(static_cast<std::streamoff>(cell_start[c] * 3 * sizeof(uint32_t)));
+    for (uint64_t first = 0; first < cell_faces[c]; first += page_triangles) {
+      const uint64_t kChunkFaces = std::min<uint64_t>(page_triangles, cell_faces[c] - first);
+      chunk.resize(kChunkFaces * 3);
+      scratch.read(reinterpret_cast<char *>(chunk.data()), chunk.size() * sizeof(uint32_t));
+      WritePage(positions, chunk, &out, &pages[page++]);
+    }
+  }
+
+  scratch.close();
+  std::remove(kScratchFilename.c_str());
+
+  out.seekp(0);
+  WriteTable(min, max, pages, &out);
+
+  std::cout << "Building pages" << std::endl;
+  std::cout << "\tGrid = " << kGrid.dims[0] << " x " << kGrid.dims[1] << " x "
+            << kGrid.dims[2] << std::endl;
+  std::cout << "\tPages = " << pages.size() << std::endl;
+
+  return static_cast<bool>(out);
+}
+
+PagedMesh::PagedMesh() { Close(); }
+
+bool PagedMesh::Open(const std::string &filename) {
+  Close();
+
+  fin_.open(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!fin_.is_open()) return false;
+
+  fin_.seekg(0, std::ios_base::end);
+  const uint64_t kFileBytes = static_cast<uint64_t>(fin_.tellg());
+  fin_.seekg(0, std::ios_base::beg);
+
+  char magic[sizeof(kMagic)];
+  uint32_t pages = 0;
+  fin_.read(magic, sizeof(magic));
+  if (!fin_ || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !Read(&fin_, &pages) ||
+      !ReadVector3f(&fin_, &min_) || !ReadVector3f(&fin_, &max_)) {
+    Close();
+    return false;
+  }
+
+  // The table must fit in the file before it is allocated.
+  const uint64_t kTableStart = static_cast<uint64_t>(fin_.tellg());
+  if (pages > (kFileBytes - kTableStart) / kPageEntryBytes) {
+    Close();
+    return false;
+  }
+
+  pages_.resize(pages);
+  for (PageInfo &page : pages_) {
+    if (!Read(&fin_, &page.offset) || !Read(&fin_, &page.vertices) || !Read(&fin_, &page.indices) ||
+        !ReadVector3f(&fin_, &page.min) || !ReadVector3f(&fin_, &page.max) || page.vertices == 0 ||
+        page.indices == 0 || page.offset > kFileBytes || page.Bytes() > kFileBytes - page.offset) {
+      Close();
+      return false;
+    }
+    max_vertices_ = std::max<size_t>(max_vertices_, page.vertices);
+    max_indices_ = std::max<size_t>(max_indices_, page.indices);
+    triangles_ += page.indices / 3;
+  }
+
+  std::cout << "Loading paged mesh" << std::endl;
+  std::cout << "\tPages = " << pages_.size() << std::endl;
+  std::cout << "\tFaces = " << triangles_ << std::endl;
+
+  return !pages_.empty();
+}
+
+void PagedMesh::Close() {
+  if (fin_.is_open()) fin_.close();
+  fin_.clear();
+  pages_.clear();
+  max_vertices_ = 0;
+  max_indices_ = 0;
+  triangles_ = 0;
+
+  min_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  max_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+}
+
+bool PagedMesh::ReadPage(size_t page, Page *data) {
+  if (page >= pages_.size()) return false;
+
+  const PageInfo &kInfo = pages_[page];
+  data->vertices.resize(kInfo.vertices * 3);
+  data->normals.resize(kInfo.vertices * 3);
+  data->indices.resize(kInfo.indices);
+
+  // A failed read of an earlier page must not fail every later one.
+  fin_.clear();
+  fin_.seekg(static_cast<std::streamoff>(kInfo.offset));
+  fin_.read(reinterpret_cast<char *>(data->vertices.data()), data->vertices.size() * sizeof(float));
+  fin_.read(reinterpret_cast<char *>(data->normals.data()), data->normals.size() * sizeof(float));
+  fin_.read(reinterpret_cast<char *>(data->indices.data()), data->indices.size() * sizeof(uint32_t));
+
+  return static_cast<bool>(fin_);
+}
+
+}  // namespace data_representation
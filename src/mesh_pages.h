@@ -0,0 +1,128 @@
+// Author: Marc Comino 2020
+
+#ifndef MESH_PAGES_H_
+#define MESH_PAGES_H_
+
+#include <eigen3/Eigen/Geometry>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace data_representation {
+
+/**
+ * @brief kPageTriangles Default maximum number of triangles of a page.
+ */
+const size_t kPageTriangles = 65536;
+
+/**
+ * @brief PageInfo Page table entry of a paged mesh.
+ */
+struct PageInfo {
+  uint64_t offset;
+  uint32_t vertices;
+  uint32_t indices;
+
+  Eigen::Vector3f min;
+  Eigen::Vector3f max;
+
+  /**
+   * @brief Bytes Size of the page vertices, normals and indices.
+   */
+  size_t Bytes() const {
+    return vertices * 6 * sizeof(float) + indices * sizeof(uint32_t);
+  }
+};
+
+/**
+ * @brief Page Geometry of a page, indices relative to its first vertex.
+ */
+struct Page {
+  std::vector<float> vertices;
+  std::vector<float> normals;
+  std::vector<uint32_t> indices;
+};
+
+/**
+ * @brief BuildPages Splits a PLY mesh into spatially coherent pages: faces are
+ * bucketed by the grid cell of their centroid, and cells larger than a page
+ * are split in file order. The faces never are in memory all at once, only
+ * the vertex positions and one page. Normals are computed per page.
+ * @param ply_filename The path to the PLY mesh.
+ * @param pages_filename The path where the paged mesh will be stored.
+ * @param page_triangles Maximum number of triangles of a page.
+ * @return Whether it was able to read the mesh and store the pages.
+ */
+bool BuildPages(const std::string &ply_filename,
+                const std::string &pages_filename,
+                size_t page_triangles = kPageTriangles);
+
+/**
+ * @brief PagedMesh Reads the pages written by BuildPages on demand. Only the
+ * page table is kept in memory.
+ */
+class PagedMesh {
+ public:
+  PagedMesh();
+
+  /**
+   * @brief Open Reads the page table.
+   * @param filename The path to the paged mesh.
+   * @return Whether it is a valid paged mesh.
+   */
+  bool Open(const std::string &filename);
+
+  /**
+   * @brief Close Closes the file and forgets the page table.
+   */
+  void Close();
+
+  /**
+   * @brief ReadPage Reads the geometry of a page.
+   * @param page Page index.
+   * @param data The resulting geometry.
+   * @return Whether it was able to read it.
+   */
+  bool ReadPage(size_t page, Page *data);
+
+  const std::vector<PageInfo> &pages() const { return pages_; }
+
+  /**
+   * @brief max_vertices Vertices of the largest page.
+   */
+  size_t max_vertices() const { return max_vertices_; }
+
+  /**
+   * @brief max_indices Indices of the largest page.
+   */
+  size_t max_indices() const { return max_indices_; }
+
+  /**
+   * @brief triangles Triangles of all the pages.
+   */
+  size_t triangles() const { return triangles_; }
+
+  /**
+   * @brief min The minimum point of the bounding box.
+   */
+  Eigen::Vector3f min_;
+
+  /**
+   * @brief max The maximum point of the bounding box.
+   */
+  Eigen::Vector3f max_;
+
+ private:
+  std::ifstream fin_;
+  std::vector<PageInfo> pages_;
+
+  size_t max_vertices_ = 0;
+  size_t max_indices_ = 0;
+  size_t triangles_ = 0;
+};
+
+}  // namespace data_representation
+
+#endif  //  MESH_PAGES_H_
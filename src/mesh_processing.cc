@@ -0,0 +1,296 @@
+// Author: Marc Comino 2020
+
+#include <mesh_processing.h>
+
+#include <mesh_io.h>
+#include <task_scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace data_representation {
+
+namespace {
+
+/**
+ * @brief CellKey Cell of a vertex in the spatial hash. With a tolerance it
+ * holds the integer cell coordinates, otherwise the bit pattern of the
+ * position with -0 folded into 0, so that both compare equal as they do as
+ * floats.
+ */
+struct CellKey {
+  uint32_t bits[3];
+
+  bool operator==(const CellKey &other) const {
+    return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+  }
+};
+
+struct CellKeyHash {
+  size_t operator()(const CellKey &key) const {
+    uint64_t hash = 1469598103934665603ull;
+    for (uint32_t bits : key.bits) hash = (hash ^ bits) * 1099511628211ull;
+    // The buckets are picked from the low bits, which the multiplications
+    // alone leave poorly mixed.
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+  }
+};
+
+CellKey MakeKey(const float *position, float cell_side) {
+  CellKey key;
+  for (int i = 0; i < 3; ++i) {
+    if (cell_side > 0.0f) {
+      const float kCell = std::floor(position[i] / cell_side);
+      const float kLimit = static_cast<float>(std::numeric_limits<int32_t>::max() / 2);
+      key.bits[i] = static_cast<uint32_t>(static_cast<int32_t>(std::max(-kLimit, std::min(kLimit, kCell))));
+    } else {
+      const float kValue = position[i] == 0.0f ? 0.0f : position[i];
+      std::memcpy(&key.bits[i], &kValue, sizeof(float));
+    }
+  }
+  return key;
+}
+
+/**
+ * @brief SpreadBits Inserts two zero bits between each of the 10 lowest bits.
+ */
+uint32_t SpreadBits(uint32_t value) {
+  value &= 0x3ff;
+  value = (value | (value << 16)) & 0x030000ff;
+  value = (value | (value << 8)) & 0x0300f00f;
+  value = (value | (value << 4)) & 0x030c30c3;
+  value = (value | (value << 2)) & 0x09249249;
+  return value;
+}
+
+}  // namespace
+
+void WeldStats::Print(std::ostream *out) const {
+  *out << "Vertex welding" << std::endl;
+  *out << "\tVertices = " << vertices_before << " -> " << vertices_after << std::endl;
+  *out << "\tDegenerate faces removed = " << degenerate_faces << std::endl;
+  *out << "\tTime = " << ms << " ms" << std::endl;
+}
+
+WeldStats WeldVertices(TriangleMesh *mesh, const WeldOptions &options) {
+  const auto kStart = std::chrono::steady_clock::now();
+  const size_t kVertices = mesh->vertices_.size() / 3;
+  const size_t kFaces = mesh->faces_.size() / 3;
+  const float kEpsilon = std::max(options.epsilon, 0.0f);
+  TaskScheduler *scheduler = options.scheduler;
+  const size_t kChunks = (scheduler != nullptr ? scheduler : &TaskScheduler::Default())->chunks();
+  const std::vector<float> &kPositions = mesh->vertices_;
+
+  WeldStats stats;
+  stats.vertices_before = kVertices;
+
+  // With cells of side 2 epsilon the vertices within epsilon of a vertex are
+  // in its cell or in the neighbour on the nearer side along every axis.
+  const float kCellSide = 2.0f * kEpsilon;
+  std::vector<CellKey> keys(kVertices);
+  std::vector<size_t> hashes(kVertices);
+  ParallelFor(scheduler, kVertices, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      keys[i] = MakeKey(&kPositions[i * 3], kCellSide);
+      hashes[i] = CellKeyHash()(keys[i]);
+    }
+  });
+
+  // The spatial hash is a bucket array with the vertices of every bucket
+  // stored contiguously, filled with a counting sort. The order inside a
+  // bucket depends on the scheduling, which does not matter since only the
+  // lowest index is kept.
+  size_t buckets = 1;
+  while (buckets < kVertices * 2) buckets <<= 1;
+  const size_t kMask = buckets - 1;
+  std::unique_ptr<std::atomic<uint32_t>[]> bucket_start(new std::atomic<uint32_t>[buckets + 1]);
+  ParallelFor(scheduler, buckets + 1, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t b = begin; b < end; ++b) bucket_start[b].store(0, std::memory_order_relaxed);
+  });
+  ParallelFor(scheduler, kVertices, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      bucket_start[(hashes[i] & kMask) + 1].fetch_add(1, std::memory_order_relaxed);
+  });
+  for (size_t b = 1; b <= buckets; ++b)
+    bucket_start[b].store(bucket_start[b].load(std::memory_order_relaxed) +
+                              bucket_start[b - 1].load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+
+  std::vector<uint32_t> bucket_end(buckets);
+  std::vector<uint32_t> bucketed(kVertices);
+  ParallelFor(scheduler, buckets, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t b = begin; b < end; ++b) bucket_end[b] = bucket_start[b + 1].load(std::memory_order_relaxed);
+  });
+  ParallelFor(scheduler, kVertices, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      bucketed[bucket_start[hashes[i] & kMask].fetch_add(1, std::memory_order_relaxed)] = static_cast<uint32_t>(i);
+  });
+  // The scatter advanced every start to the end of its bucket, that is the
+  // start of the next one.
+  auto bucket_begin = [&](size_t b) {
+    return b == 0 ? 0u : bucket_start[b - 1].load(std::memory_order_relaxed);
+  };
+
+  // Lowest indexed vertex within epsilon of every vertex, looked up in its
+  // cell and, with a tolerance, in the 7 others of the 2x2x2 block nearest
+  // to the vertex.
+  const bool kTolerance = kEpsilon > 0.0f;
+  const float kEpsilon2 = kEpsilon * kEpsilon;
+  std::vector<int> nearest(kVertices);
+  ParallelFor(scheduler, kVertices, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const Eigen::Map<const Eigen::Vector3f> kVertex(&kPositions[i * 3]);
+      uint32_t side[3] = {0, 0, 0};
+      if (kTolerance) {
+        for (int a = 0; a < 3; ++a) {
+          const float kOffset = kVertex[a] / kCellSide - std::floor(kVertex[a] / kCellSide);
+          side[a] = kOffset < 0.5f ? static_cast<uint32_t>(-1) : 1u;
+        }
+      }
+
+      uint32_t lowest = static_cast<uint32_t>(i);
+      for (int c = 0; c < (kTolerance ? 8 : 1); ++c) {
+        CellKey cell = keys[i];
+        for (int a = 0; a < 3; ++a)
+          if (c & (1 << a)) cell.bits[a] += side[a];
+        const size_t kBucket = (c == 0 ? hashes[i] : CellKeyHash()(cell)) & kMask;
+        for (uint32_t k = bucket_begin(kBucket); k < bucket_end[kBucket]; ++k) {
+          const uint32_t kOther = bucketed[k];
+          if (kOther >= lowest || !(keys[kOther] == cell)) continue;
+          if (!kTolerance ||
+              (Eigen::Map<const Eigen::Vector3f>(&kPositions[kOther * 3]) - kVertex).squaredNorm() <= kEpsilon2)
+            lowest = kOther;
+        }
+      }
+      nearest[i] = static_cast<int>(lowest);
+    }
+  });
+  bucket_start.reset();
+
+  // Nearest vertices always come first, so one forward pass resolves the
+  // chains to their root and numbers the roots.
+  std::vector<int> remap(kVertices);
+  int welded = 0;
+  for (size_t i = 0; i < kVertices; ++i)
+    remap[i] = nearest[i] == static_cast<int>(i) ? welded++ : remap[nearest[i]];
+
+  std::vector<float> vertices(static_cast<size_t>(welded) * 3);
+  ParallelFor(scheduler, kVertices, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      if (nearest[i] == static_cast<int>(i))
+        std::memcpy(&vertices[remap[i] * 3], &kPositions[i * 3], 3 * sizeof(float));
+  });
+
+  // Faces are remapped and compacted per chunk, after counting the faces
+  // every chunk keeps.
+  std::vector<int> &faces = mesh->faces_;
+  std::vector<size_t> kept(kChunks + 1, 0);
+  ParallelFor(scheduler, kFaces, kChunks, [&](size_t chunk, size_t begin, size_t end) {
+    for (size_t f = begin; f < end; ++f) {
+      int *face = &faces[f * 3];
+      for (int j = 0; j < 3; ++j) face[j] = remap[face[j]];
+      if (face[0] != face[1] && face[1] != face[2] && face[0] != face[2]) ++kept[chunk + 1];
+    }
+  });
+  for (size_t c = 1; c < kept.size(); ++c) kept[c] += kept[c - 1];
+
+  std::vector<int> compacted(kept.back() * 3);
+  ParallelFor(scheduler, kFaces, kChunks, [&](size_t chunk, size_t begin, size_t end) {
+    size_t out = kept[chunk] * 3;
+    for (size_t f = begin; f < end; ++f) {
+      const int *kFace = &faces[f * 3];
+      if (kFace[0] == kFace[1] || kFace[1] == kFace[2] || kFace[0] == kFace[2]) continue;
+      std::memcpy(&compacted[out], kFace, 3 * sizeof(int));
+      out += 3;
+    }
+  });
+
+  mesh->faces_.swap(compacted);
+  mesh->vertices_.swap(vertices);
+  ComputeVertexNormals(mesh->vertices_, mesh->faces_, &mesh->normals_, scheduler);
+
+  mesh->min_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  mesh->max_ = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  for (size_t i = 0; i < mesh->vertices_.size(); i += 3) {
+    const Eigen::Map<const Eigen::Vector3f> kVertex(&mesh->vertices_[i]);
+    mesh->min_ = mesh->min_.cwiseMin(kVertex);
+    mesh->max_ = mesh->max_.cwiseMax(kVertex);
+  }
+
+  stats.vertices_after = static_cast<size_t>(welded);
+  stats.degenerate_faces = kFaces - mesh->faces_.size() / 3;
+  stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+  return stats;
+}
+
+void ReorderMesh(TriangleMesh *mesh, TaskScheduler *scheduler) {
+  const size_t kVertices = mesh->vertices_.size() / 3;
+  const size_t kFaces = mesh->faces_.size() / 3;
+
+  Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  for (size_t i = 0; i < kVertices; ++i) {
+    const Eigen::Vector3f kVertex(mesh->vertices_[i * 3], mesh->vertices_[i * 3 + 1],
+                                  mesh->vertices_[i * 3 + 2]);
+    min = min.cwiseMin(kVertex);
+    max = max.cwiseMax(kVertex);
+  }
+  const Eigen::Vector3f kScale =
+      (max - min).cwiseMax(Eigen::Vector3f::Constant(1e-20f)).cwiseInverse() * 1023.0f;
+
+  std::vector<uint32_t> codes(kFaces);
+  const size_t kChunks = (scheduler != nullptr ? scheduler : &TaskScheduler::Default())->chunks();
+  ParallelFor(scheduler, kFaces, kChunks, [&](size_t, size_t begin, size_t end) {
+    for (size_t f = begin; f < end; ++f) {
+      Eigen::Vector3f centroid = Eigen::Vector3f::Zero();
+      for (int j = 0; j < 3; ++j)
+        centroid += Eigen::Map<const Eigen::Vector3f>(&mesh->vertices_[mesh->faces_[f * 3 + j] * 3]);
+      const Eigen::Vector3f kCell = ((centroid / 3.0f - min).cwiseProduct(kScale)).cwiseMax(0.0f).cwiseMin(1023.0f);
+      codes[f] = SpreadBits(static_cast<uint32_t>(kCell[0])) |
+                 (SpreadBits(static_cast<uint32_t>(kCell[1])) << 1) |
+                 (SpreadBits(static_cast<uint32_t>(kCell[2])) << 2);
+    }
+  });
+
+  std::vector<size_t> order(kFaces);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&codes](size_t a, size_t b) { return codes[a] < codes[b]; });
+
+  const bool kNormals = mesh->normals_.size() == mesh->vertices_.size();
+  std::vector<int> remap(kVertices, -1);
+  std::vector<int> faces;
+  std::vector<float> vertices, normals;
+  faces.reserve(mesh->faces_.size());
+  vertices.reserve(mesh->vertices_.size());
+  if (kNormals) normals.reserve(mesh->normals_.size());
+  for (size_t f : order) {
+    for (int j = 0; j < 3; ++j) {
+      const int kOld = mesh->faces_[f * 3 + j];
+      if (remap[kOld] < 0) {
+        remap[kOld] = static_cast<int>(vertices.size() / 3);
+        vertices.insert(vertices.end(), &mesh->vertices_[kOld * 3], &mesh->vertices_[kOld * 3] + 3);
+        if (kNormals)
+          normals.insert(normals.end(), &mesh->normals_[kOld * 3], &mesh->normals_[kOld * 3] + 3);
+      }
+      faces.push_back(remap[kOld]);
+    }
+  }
+
+  mesh->vertices_.swap(vertices);
+  mesh->faces_.swap(faces);
+  mesh->normals_.swap(normals);
+}
+
+}  // namespace data_representation
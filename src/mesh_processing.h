@@ -0,0 +1,69 @@
+// Author: Marc Comino 2020
+
+#ifndef MESH_PROCESSING_H_
+#define MESH_PROCESSING_H_
+
+#include <task_scheduler.h>
+#include <triangle_mesh.h>
+
+#include <cstddef>
+#include <ostream>
+
+namespace data_representation {
+
+/**
+ * @brief WeldOptions Tolerance and parallelism of WeldVertices.
+ */
+struct WeldOptions {
+  /**
+   * @brief epsilon Largest distance between two merged vertices. With 0 only
+   * vertices with exactly the same position are merged.
+   */
+  float epsilon = 0.0f;
+
+  /**
+   * @brief scheduler Runs the parallel passes, nullptr for the default one.
+   */
+  TaskScheduler *scheduler = nullptr;
+};
+
+/**
+ * @brief WeldStats Outcome of WeldVertices.
+ */
+struct WeldStats {
+  size_t vertices_before = 0;
+  size_t vertices_after = 0;
+  size_t degenerate_faces = 0;
+  double ms = 0.0;
+
+  void Print(std::ostream *out) const;
+};
+
+/**
+ * @brief WeldVertices Merges the duplicated vertices of a mesh, remaps the
+ * faces to the merged vertices, drops the triangles that became degenerate
+ * and recomputes the normals and the bounding box. Vertices are bucketed in
+ * a spatial hash of cells of side epsilon, every pass split into chunks run
+ * by the scheduler, and every vertex is merged into the lowest indexed vertex
+ * within epsilon of it, transitively. The result does not depend on the
+ * number of threads.
+ * @param mesh The mesh to weld.
+ * @param options Tolerance and scheduler.
+ * @return Vertex counts and time.
+ */
+WeldStats WeldVertices(TriangleMesh *mesh, const WeldOptions &options = WeldOptions());
+
+/**
+ * @brief ReorderMesh Sorts the triangles along a Morton curve of their
+ * centroids and renumbers the vertices in the order the triangles first use
+ * them, so that neighbouring triangles share cache lines both in the index
+ * and in the vertex buffers. Vertices not used by any triangle are dropped.
+ * @param mesh The mesh to reorder.
+ * @param scheduler Computes the Morton codes in parallel, nullptr for the
+ * default one.
+ */
+void ReorderMesh(TriangleMesh *mesh, TaskScheduler *scheduler = nullptr);
+
+}  // namespace data_representation
+
+#endif  // MESH_PROCESSING_H_
@@ -0,0 +1,237 @@
+// Author: Marc Comino 2020
+
+#include <mesh_io.h>
+#include <mesh_processing.h>
+#include <task_scheduler.h>
+#include <triangle_mesh.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Options Command line of meshtool.
+ */
+struct Options {
+  std::vector<std::string> inputs;
+  std::string output_dir;
+  std::string suffix = "_out";
+  bool weld = false;
+  bool reorder = false;
+  bool scaling = false;
+  unsigned int threads = 0;
+  data_representation::WeldOptions weld_options;
+  data_representation::PlyWriteOptions write;
+};
+
+void PrintUsage() {
+  std::cerr << "Usage: meshtool [options] input.ply..." << std::endl;
+  std::cerr << "  -o DIR          Directory of the outputs, the input one by default" << std::endl;
+  std::cerr << "  --suffix S      Appended to the output names, _out by default" << std::endl;
+  std::cerr << "  --ascii         Write ASCII instead of binary PLY" << std::endl;
+  std::cerr << "  --no-normals    Do not write the vertex normals" << std::endl;
+  std::cerr << "  --weld          Merge the vertices with the same position" << std::endl;
+  std::cerr << "  --weld-epsilon E  Merge the vertices closer than E, implies --weld" << std::endl;
+  std::cerr << "  --reorder       Sort the triangles and vertices for locality" << std::endl;
+  std::cerr << "  -j N            Threads of the task scheduler, all cores by default" << std::endl;
+  std::cerr << "  --scaling       Time the loading and processing with 1, 2, 4... up to" << std::endl;
+  std::cerr << "                  -j threads instead of writing the outputs" << std::endl;
+}
+
+bool ParseOptions(int argc, char *argv[], Options *options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string kArgument = argv[i];
+    const bool kHasValue = i + 1 < argc;
+    if (kArgument == "-o" && kHasValue) {
+      options->output_dir = argv[++i];
+    } else if (kArgument == "--suffix" && kHasValue) {
+      options->suffix = argv[++i];
+    } else if (kArgument == "-j" && kHasValue) {
+      const int kThreads = std::atoi(argv[++i]);
+      if (kThreads <= 0) return false;
+      options->threads = static_cast<unsigned int>(kThreads);
+    } else if (kArgument == "--weld-epsilon" && kHasValue) {
+      options->weld = true;
+      options->weld_options.epsilon = static_cast<float>(std::atof(argv[++i]));
+      if (options->weld_options.epsilon < 0.0f) return false;
+    } else if (kArgument == "--ascii") {
+      options->write.binary = false;
+    } else if (kArgument == "--no-normals") {
+      options->write.normals = false;
+    } else if (kArgument == "--weld") {
+      options->weld = true;
+    } else if (kArgument == "--reorder") {
+      options->reorder = true;
+    } else if (kArgument == "--scaling") {
+      options->scaling = true;
+    } else if (!kArgument.empty() && kArgument[0] != '-') {
+      options->inputs.push_back(kArgument);
+    } else {
+      return false;
+    }
+  }
+  return !options->inputs.empty();
+}
+
+/**
+ * @brief OutputFilename Name of the output of an input, in the output
+ * directory if there is one and with the suffix before the extension.
+ */
+std::string OutputFilename(const Options &options, const std::string &input) {
+  const size_t kSlash = input.find_last_of('/');
+  std::string directory = kSlash == std::string::npos ? "" : input.substr(0, kSlash + 1);
+  std::string name = kSlash == std::string::npos ? input : input.substr(kSlash + 1);
+
+  const size_t kDot = name.find_last_of('.');
+  if (kDot != std::string::npos) name = name.substr(0, kDot);
+
+  if (!options.output_dir.empty()) {
+    directory = options.output_dir;
+    if (directory.back() != '/') directory += '/';
+  }
+  return directory + name + options.suffix + ".ply";
+}
+
+/**
+ * @brief Load Reads a file and welds and reorders it as requested.
+ * @param weld Statistics of the weld, if any.
+ * @param log Stream the loader prints to.
+ * @return Whether it was read.
+ */
+bool Load(const Options &options, const std::string &input,
+          data_representation::TaskScheduler *scheduler, data_representation::TriangleMesh *mesh,
+          data_representation::WeldStats *weld, std::ostream *log) {
+  if (!data_representation::ReadFromPly(input, mesh, scheduler, log)) return false;
+
+  data_representation::WeldOptions weld_options = options.weld_options;
+  weld_options.scheduler = scheduler;
+  if (options.weld) *weld = data_representation::WeldVertices(mesh, weld_options);
+  if (options.reorder) data_representation::ReorderMesh(mesh, scheduler);
+  return true;
+}
+
+/**
+ * @brief Process Converts one file and prints a line about it.
+ * @return Whether it was read and written.
+ */
+bool Process(const Options &options, const std::string &input,
+             data_representation::TaskScheduler *scheduler, std::mutex *print_mutex) {
+  const auto kStart = std::chrono::steady_clock::now();
+
+  data_representation::TriangleMesh mesh;
+  data_representation::WeldStats weld;
+  std::ostringstream log;  // Printed with the report, files load concurrently.
+  bool ok = Load(options, input, scheduler, &mesh, &weld, &log);
+  const size_t kVerticesIn = options.weld ? weld.vertices_before : mesh.vertices_.size() / 3;
+
+  const std::string kOutput = OutputFilename(options, input);
+  ok = ok && data_representation::WriteToPly(kOutput, mesh, options.write);
+
+  const double kMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+
+  std::lock_guard<std::mutex> lock(*print_mutex);
+  std::cout << log.str();
+  if (ok) {
+    std::cout << input << " -> " << kOutput << std::endl;
+    std::cout << "\tVertices = " << kVerticesIn << " -> " << mesh.vertices_.size() / 3 << std::endl;
+    std::cout << "\tFaces = " << mesh.faces_.size() / 3 << std::endl;
+    if (options.weld)
+      std::cout << "\tWeld = " << weld.ms << " ms, " << weld.degenerate_faces
+                << " degenerate faces removed" << std::endl;
+    std::cout << "\tTime = " << kMs << " ms" << std::endl;
+  } else {
+    std::cerr << "Could not convert " << input << std::endl;
+  }
+  return ok;
+}
+
+/**
+ * @brief RunScaling Loads and processes every input with schedulers of 1, 2,
+ * 4... threads, up to the -j ones, and prints the time and speedup of each.
+ * Nothing is written, so that the disk does not hide the scaling.
+ * @return Whether every input was read with every scheduler.
+ */
+bool RunScaling(const Options &options) {
+  const unsigned int kMaxThreads =
+      options.threads > 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<unsigned int> counts;
+  for (unsigned int t = 1; t < kMaxThreads; t *= 2) counts.push_back(t);
+  counts.push_back(kMaxThreads);
+
+  // Only the table is printed, the output of the loaders is dropped.
+  std::vector<double> times;
+  for (unsigned int threads : counts) {
+    data_representation::TaskScheduler scheduler(threads);
+    std::atomic<bool> ok(true);
+
+    const auto kStart = std::chrono::steady_clock::now();
+    data_representation::TaskGroup files(&scheduler);
+    for (const std::string &input : options.inputs) {
+      files.Run([&]() {
+        data_representation::TriangleMesh mesh;
+        data_representation::WeldStats weld;
+        std::ostringstream log;
+        if (!Load(options, input, &scheduler, &mesh, &weld, &log)) ok = false;
+      });
+    }
+    files.Wait();
+    const double kMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+
+    if (!ok) {
+      std::cerr << "Could not read the inputs" << std::endl;
+      return false;
+    }
+    times.push_back(kMs);
+  }
+
+  std::cout << "Threads\tTime (ms)\tSpeedup" << std::endl;
+  for (size_t i = 0; i < counts.size(); ++i)
+    std::cout << counts[i] << "\t" << times[i] << "\t" << times[0] / times[i] << std::endl;
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage();
+    return 1;
+  }
+
+  if (options.scaling) return RunScaling(options) ? 0 : 1;
+
+  // Files are tasks of the same scheduler as the loops that process them, so
+  // the threads left idle by the small files steal work from the large ones.
+  data_representation::TaskScheduler scheduler(options.threads);
+  std::atomic<int> failures(0);
+  std::mutex print_mutex;
+
+  const auto kStart = std::chrono::steady_clock::now();
+  data_representation::TaskGroup files(&scheduler);
+  for (const std::string &input : options.inputs) {
+    files.Run([&]() {
+      if (!Process(options, input, &scheduler, &print_mutex)) ++failures;
+    });
+  }
+  files.Wait();
+  const double kMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+
+  std::cout << options.inputs.size() - failures << " of " << options.inputs.size()
+            << " files converted in " << kMs << " ms with " << scheduler.threads() << " threads"
+            << std::endl;
+
+  return failures == 0 ? 0 : 1;
+}
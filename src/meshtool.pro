@@ -0,0 +1,30 @@
+TARGET = meshtool
+TEMPLATE = app
+
+CONFIG += console c++14
+CONFIG -= qt app_bundle
+CONFIG(release, release|debug):QMAKE_CXXFLAGS += -Wall -O2
+
+CONFIG(release, release|debug):DESTDIR = ../build/release/
+CONFIG(release, release|debug):OBJECTS_DIR = ../build/release/meshtool/
+
+CONFIG(debug, release|debug):DESTDIR = ../build/debug/
+CONFIG(debug, release|debug):OBJECTS_DIR = ../build/debug/meshtool/
+
+INCLUDEPATH += /usr/include/eigen3/
+
+QMAKE_CXXFLAGS += -pthread
+LIBS += -pthread
+
+SOURCES += \
+    triangle_mesh.cc \
+    mesh_io.cc \
+    mesh_processing.cc \
+    task_scheduler.cc \
+    meshtool.cc
+
+HEADERS  += \
+    triangle_mesh.h \
+    mesh_io.h \
+    mesh_processing.h \
+    task_scheduler.h
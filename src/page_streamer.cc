@@ -0,0 +1,224 @@
+// Author: Marc Comino 2020
+
+#include <page_streamer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace data_visualization {
+
+namespace {
+
+/**
+ * @brief kPageInsPerFrame Pages uploaded per frame at most, so that moving
+ * the camera into an unloaded region does not stall a single frame.
+ */
+const size_t kPageInsPerFrame = 4;
+
+/**
+ * @brief Outside Whether a box is fully outside of one of the clip planes.
+ */
+bool Outside(const Eigen::Matrix4f &model_view_projection,
+             const data_representation::PageInfo &page) {
+  int outside[6] = {0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < 8; ++i) {
+    const Eigen::Vector4f kCorner((i & 1) ? page.max[0] : page.min[0],
+                                  (i & 2) ? page.max[1] : page.min[1],
+                                  (i & 4) ? page.max[2] : page.min[2], 1.0f);
+    const Eigen::Vector4f kClip = model_view_projection * kCorner;
+    for (int axis = 0; axis < 3; ++axis) {
+      if (kClip[axis] < -kClip[3]) ++outside[axis * 2];
+      if (kClip[axis] > kClip[3]) ++outside[axis * 2 + 1];
+    }
+  }
+
+  for (int plane = 0; plane < 6; ++plane)
+    if (outside[plane] == 8) return true;
+  return false;
+}
+
+}  //  namespace
+
+PageStreamer::PageStreamer() {}
+
+bool PageStreamer::Open(const std::string &filename, size_t budget_bytes) {
+  Release();
+  if (!mesh_.Open(filename)) return false;
+
+  const std::vector<data_representation::PageInfo> &kPages = mesh_.pages();
+  slot_vertices_ = mesh_.max_vertices();
+  slot_indices_ = mesh_.max_indices();
+  const size_t kSlotBytes = slot_vertices_ * 6 * sizeof(float) + slot_indices_ * sizeof(uint32_t);
+  const size_t kSlots = std::max<size_t>(1, std::min(kPages.size(), budget_bytes / kSlotBytes));
+
+  glGenVertexArrays(1, &vao_);
+  glBindVertexArray(vao_);
+
+  glGenBuffers(1, &vbo_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glBufferData(GL_ARRAY_BUFFER, kSlots * slot_vertices_ * 3 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glEnableVertexAttribArray(0);
+
+  glGenBuffers(1, &vno_);
+  glBindBuffer(GL_ARRAY_BUFFER, vno_);
+  glBufferData(GL_ARRAY_BUFFER, kSlots * slot_vertices_ * 3 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glEnableVertexAttribArray(1);
+
+  glGenBuffers(1, &ebo_);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, kSlots * slot_indices_ * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glBindVertexArray(0);
+
+  slot_page_.assign(kSlots, -1);
+  slot_frame_.assign(kSlots, 0);
+  page_slot_.assign(kPages.size(), -1);
+  stats_ = StreamingStats();
+  stats_.capacity_bytes = kSlots * kSlotBytes;
+  ++version_;
+
+  return true;
+}
+
+void PageStreamer::Release() {
+  if (open()) {
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &vbo_);
+    glDeleteBuffers(1, &vno_);
+    glDeleteBuffers(1, &ebo_);
+  }
+
+  mesh_.Close();
+  slot_page_.clear();
+  slot_frame_.clear();
+  page_slot_.clear();
+  drawn_.clear();
+  pending_ = 0;
+}
+
+void PageStreamer::Update(const Eigen::Matrix4f &model_view_projection) {
+  if (!open()) return;
+  ++frame_;
+
+  // Visible pages, nearest first.
+  const std::vector<data_representation::PageInfo> &kPages = mesh_.pages();
+  std::vector<std::pair<float, size_t>> visible;
+  for (size_t page = 0; page < kPages.size(); ++page) {
+    if (Outside(model_view_projection, kPages[page])) continue;
+
+    const Eigen::Vector3f kCenter = (kPages[page].min + kPages[page].max) * 0.5f;
+    visible.emplace_back((model_view_projection * kCenter.homogeneous())[3], page);
+  }
+  std::sort(visible.begin(), visible.end());
+
+  // Resident visible pages are used this frame and cannot be evicted by the
+  // page ins below.
+  for (const std::pair<float, size_t> &kVisible : visible)
+    if (page_slot_[kVisible.second] >= 0) slot_frame_[page_slot_[kVisible.second]] = frame_;
+
+  std::vector<size_t> drawn;
+  size_t page_ins = 0;
+  pending_ = 0;
+  for (const std::pair<float, size_t> &kVisible : visible) {
+    const size_t kPage = kVisible.second;
+    if (page_slot_[kPage] < 0) {
+      if (page_ins == kPageInsPerFrame) {
+        ++pending_;
+        continue;
+      }
+
+      // Free slot, or else the least recently visible one.
+      size_t slot = 0;
+      for (size_t s = 1; s < slot_page_.size(); ++s)
+        if (slot_frame_[s] < slot_frame_[slot]) slot = s;
+      if (slot_frame_[slot] == frame_) continue;  // Every slot is visible.
+
+      if (!PageIn(kPage, slot)) continue;
+      ++page_ins;
+    }
+
+    drawn.push_back(static_cast<size_t>(page_slot_[kPage]));
+  }
+
+  if (page_ins > 0 || drawn != drawn_) ++version_;
+  drawn_.swap(drawn);
+  stats_.visible_pages = visible.size();
+}
+
+bool PageStreamer::PageIn(size_t page, size_t slot) {
+  const auto kStart = std::chrono::steady_clock::now();
+  if (!mesh_.ReadPage(page, &page_)) return false;
+
+  const int kEvicted = slot_page_[slot];
+  if (kEvicted >= 0) {
+    page_slot_[kEvicted] = -1;
+    stats_.resident_bytes -= mesh_.pages()[kEvicted].Bytes();
+    --stats_.resident_pages;
+    ++stats_.evictions;
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glBufferSubData(GL_ARRAY_BUFFER, slot * slot_vertices_ * 3 * sizeof(float),
+                  page_.vertices.size() * sizeof(float), page_.vertices.data());
+  glBindBuffer(GL_ARRAY_BUFFER, vno_);
+  glBufferSubData(GL_ARRAY_BUFFER, slot * slot_vertices_ * 3 * sizeof(float),
+                  page_.normals.size() * sizeof(float), page_.normals.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // The element buffer binding is VAO state.
+  glBindVertexArray(vao_);
+  glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, slot * slot_indices_ * sizeof(uint32_t),
+                  page_.indices.size() * sizeof(uint32_t), page_.indices.data());
+  glBindVertexArray(0);
+
+  slot_page_[slot] = static_cast<int>(page);
+  slot_frame_[slot] = frame_;
+  page_slot_[page] = static_cast<int>(slot);
+
+  const double kMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+  stats_.resident_bytes += mesh_.pages()[page].Bytes();
+  ++stats_.resident_pages;
+  ++stats_.page_ins;
+  stats_.total_page_in_ms += kMs;
+  stats_.max_page_in_ms = std::max(stats_.max_page_in_ms, kMs);
+
+  return true;
+}
+
+void PageStreamer::Draw() const {
+  glBindVertexArray(vao_);
+
+  // Pages are in model space, the instance attributes are not enabled.
+  for (GLuint column = 0; column < 4; ++column)
+    glVertexAttrib4f(2 + column, column == 0, column == 1, column == 2, column == 3);
+
+  for (size_t slot : drawn_) {
+    const data_representation::PageInfo &kPage = mesh_.pages()[slot_page_[slot]];
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(kPage.indices), GL_UNSIGNED_INT,
+                             reinterpret_cast<void *>(slot * slot_indices_ * sizeof(uint32_t)),
+                             static_cast<GLint>(slot * slot_vertices_));
+  }
+
+  glBindVertexArray(0);
+}
+
+void PageStreamer::Print(std::ostream *out) const {
+  *out << "Out of core" << std::endl;
+  *out << "\tPages = " << stats_.visible_pages << " visible, "
+       << stats_.resident_pages << " resident of " << mesh_.pages().size() << std::endl;
+  *out << "\tResident = " << stats_.resident_bytes / (1024.0 * 1024.0) << " MB of "
+       << stats_.capacity_bytes / (1024.0 * 1024.0) << " MB" << std::endl;
+  *out << "\tPage ins = " << stats_.page_ins << ", evictions = " << stats_.evictions << std::endl;
+  *out << "\tPage in = "
+       << (stats_.page_ins > 0 ? stats_.total_page_in_ms / stats_.page_ins : 0.0)
+       << " ms mean, " << stats_.max_page_in_ms << " ms max" << std::endl;
+}
+
+}  //  namespace data_visualization
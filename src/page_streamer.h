@@ -0,0 +1,135 @@
+// Author: Marc Comino 2020
+
+#ifndef PAGE_STREAMER_H_
+#define PAGE_STREAMER_H_
+
+#include <GL/glew.h>
+
+#include <eigen3/Eigen/Geometry>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "./mesh_pages.h"
+
+namespace data_visualization {
+
+/**
+ * @brief StreamingStats Counters of the page streamer.
+ */
+struct StreamingStats {
+  size_t visible_pages = 0;
+  size_t resident_pages = 0;
+  size_t resident_bytes = 0;
+  size_t capacity_bytes = 0;
+  size_t page_ins = 0;
+  size_t evictions = 0;
+  double total_page_in_ms = 0.0;
+  double max_page_in_ms = 0.0;
+};
+
+/**
+ * @brief PageStreamer Renders a paged mesh out of core. The GPU buffers are a
+ * fixed pool of slots, each holding one page. Every frame the pages in the
+ * view frustum are paged in, nearest first and a few per frame, evicting the
+ * least recently visible resident page when the pool is full. Only resident
+ * visible pages are drawn.
+ */
+class PageStreamer {
+ public:
+  PageStreamer();
+
+  /**
+   * @brief Open Reads the page table and allocates the slot pool. Requires a
+   * current GL context.
+   * @param filename The path to the paged mesh.
+   * @param budget_bytes GPU memory of the pool. At least one slot is created.
+   * @return Whether it is a valid paged mesh.
+   */
+  bool Open(const std::string &filename, size_t budget_bytes);
+
+  /**
+   * @brief Release Deletes the pool and closes the mesh. Requires a current
+   * GL context.
+   */
+  void Release();
+
+  /**
+   * @brief Update Culls the pages and pages in the missing visible ones.
+   * @param model_view_projection Transform from model to clip space.
+   */
+  void Update(const Eigen::Matrix4f &model_view_projection);
+
+  /**
+   * @brief Draw Draws the resident visible pages. The instance transform of
+   * the G pass is set to the identity.
+   */
+  void Draw() const;
+
+  bool open() const { return !slot_page_.empty(); }
+
+  /**
+   * @brief pending Visible pages that are not resident yet.
+   */
+  size_t pending() const { return pending_; }
+
+  /**
+   * @brief version Increased every time the set of drawn pages changes.
+   */
+  unsigned int version() const { return version_; }
+
+  const data_representation::PagedMesh &mesh() const { return mesh_; }
+  const StreamingStats &stats() const { return stats_; }
+
+  /**
+   * @brief Print Writes the counters.
+   * @param out Output stream.
+   */
+  void Print(std::ostream *out) const;
+
+ private:
+  bool PageIn(size_t page, size_t slot);
+
+  data_representation::PagedMesh mesh_;
+  data_representation::Page page_;
+
+  GLuint vao_ = 0;
+  GLuint vbo_ = 0;
+  GLuint vno_ = 0;
+  GLuint ebo_ = 0;
+
+  size_t slot_vertices_ = 0;
+  size_t slot_indices_ = 0;
+
+  /**
+   * @brief slot_page_ Page held by every slot, -1 when free.
+   */
+  std::vector<int> slot_page_;
+
+  /**
+   * @brief slot_frame_ Last frame the page of every slot was visible.
+   */
+  std::vector<uint64_t> slot_frame_;
+
+  /**
+   * @brief page_slot_ Slot of every page, -1 when not resident.
+   */
+  std::vector<int> page_slot_;
+
+  /**
+   * @brief drawn_ Slots drawn this frame.
+   */
+  std::vector<size_t> drawn_;
+
+  uint64_t frame_ = 0;
+  size_t pending_ = 0;
+  unsigned int version_ = 0;
+
+  StreamingStats stats_;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  PAGE_STREAMER_H_
@@ -0,0 +1,33 @@
+// Author: Marc Comino 2020
+
+#include <pass_cache.h>
+
+namespace data_visualization {
+
+PassInputs &PassInputs::Add(const Eigen::Matrix4f &matrix) {
+  return Add(matrix.data(), sizeof(float) * 16);
+}
+
+PassInputs &PassInputs::Add(const void *data, size_t bytes) {
+  const unsigned char *begin = static_cast<const unsigned char *>(data);
+  bytes_.insert(bytes_.end(), begin, begin + bytes);
+  return *this;
+}
+
+bool PassInputs::operator==(const PassInputs &other) const {
+  return bytes_ == other.bytes_;
+}
+
+bool CachedPass::Dirty(const PassInputs &inputs) const {
+  return !valid_ || inputs != inputs_;
+}
+
+void CachedPass::Commit(const PassInputs &inputs) {
+  inputs_ = inputs;
+  valid_ = true;
+  ++version_;
+}
+
+void CachedPass::Invalidate() { valid_ = false; }
+
+}  //  namespace data_visualization
@@ -0,0 +1,82 @@
+// Author: Marc Comino 2020
+
+#ifndef PASS_CACHE_H_
+#define PASS_CACHE_H_
+
+#include <eigen3/Eigen/Geometry>
+
+#include <vector>
+
+namespace data_visualization {
+
+/**
+ * @brief PassInputs Byte signature of the values a render pass depends on.
+ */
+class PassInputs {
+ public:
+  /**
+   * @brief Add Appends a plain value to the signature.
+   * @param value Value the pass depends on.
+   * @return This signature, to chain calls.
+   */
+  template <typename T>
+  PassInputs &Add(const T &value) {
+    return Add(&value, sizeof(T));
+  }
+
+  /**
+   * @brief Add Appends the coefficients of a matrix to the signature.
+   * @param matrix Matrix the pass depends on.
+   * @return This signature, to chain calls.
+   */
+  PassInputs &Add(const Eigen::Matrix4f &matrix);
+
+  bool operator==(const PassInputs &other) const;
+  bool operator!=(const PassInputs &other) const { return !(*this == other); }
+
+ private:
+  PassInputs &Add(const void *data, size_t bytes);
+
+  std::vector<unsigned char> bytes_;
+};
+
+/**
+ * @brief CachedPass Tracks the inputs a render pass used to produce its output
+ * texture, so that the pass is only run again when they change.
+ */
+class CachedPass {
+ public:
+  /**
+   * @brief Dirty Compares the inputs against the ones of the last run.
+   * @param inputs Current inputs of the pass.
+   * @return Whether the pass has to run.
+   */
+  bool Dirty(const PassInputs &inputs) const;
+
+  /**
+   * @brief Commit Stores the inputs of a run and increases the version.
+   * @param inputs Inputs the pass has just run with.
+   */
+  void Commit(const PassInputs &inputs);
+
+  /**
+   * @brief Invalidate Makes the pass dirty, e.g. because the output texture
+   * was reallocated.
+   */
+  void Invalidate();
+
+  /**
+   * @brief version Number of times the pass has run. Downstream passes add it
+   * to their inputs.
+   */
+  unsigned int version() const { return version_; }
+
+ private:
+  bool valid_ = false;
+  unsigned int version_ = 0;
+  PassInputs inputs_;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  PASS_CACHE_H_
@@ -0,0 +1,135 @@
+// Author: Marc Comino 2020
+
+#include <render_graph.h>
+
+#include <assert.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace data_visualization {
+
+RenderGraph::RenderGraph(RenderTargetPool *pool, GLsizei width, GLsizei height)
+    : pool_(pool), width_(width), height_(height) {}
+
+RenderGraph::Resource RenderGraph::Import(const std::string &name,
+                                          RenderTarget *target) {
+  resources_.push_back({name, target->internal_format, false, false, target});
+  return static_cast<Resource>(resources_.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::Create(const std::string &name,
+                                          GLint internal_format) {
+  resources_.push_back({name, internal_format, true, false, nullptr});
+  return static_cast<Resource>(resources_.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::Backbuffer() {
+  resources_.push_back({"backbuffer", 0, false, true, nullptr});
+  return static_cast<Resource>(resources_.size() - 1);
+}
+
+void RenderGraph::AddPass(const std::string &name,
+                          const std::vector<Resource> &reads,
+                          const std::vector<Resource> &writes, bool up_to_date,
+                          const std::function<void()> &execute) {
+  passes_.push_back({name, reads, writes, up_to_date, execute});
+}
+
+RenderTarget *RenderGraph::Target(Resource resource) const {
+  return resources_[static_cast<size_t>(resource)].target;
+}
+
+GLuint RenderGraph::Fbo(Resource resource) const {
+  const ResourceNode &node = resources_[static_cast<size_t>(resource)];
+  return node.backbuffer ? 0 : node.target->fbo;
+}
+
+GLuint RenderGraph::Texture(Resource resource) const {
+  const ResourceNode &node = resources_[static_cast<size_t>(resource)];
+  assert(!node.backbuffer);
+  return node.target->texture;
+}
+
+void RenderGraph::Execute(Resource output, PassTimer *timer) {
+  const size_t kPasses = passes_.size();
+  const size_t kResources = resources_.size();
+
+  // Culling. Walk the passes backwards from the output: a pass is needed when
+  // it writes a needed resource, and then the resources it reads are needed,
+  // unless its cached output is still valid.
+  std::vector<bool> needed(kResources, false);
+  std::vector<bool> live(kPasses, false);
+  needed[static_cast<size_t>(output)] = true;
+
+  for (size_t i = kPasses; i-- > 0;) {
+    const PassNode &pass = passes_[i];
+
+    bool contributes = false;
+    for (Resource r : pass.writes) {
+      if (needed[static_cast<size_t>(r)]) {
+        contributes = true;
+        needed[static_cast<size_t>(r)] = false;
+      }
+    }
+
+    if (contributes && !pass.up_to_date) {
+      live[i] = true;
+      for (Resource r : pass.reads) needed[static_cast<size_t>(r)] = true;
+    }
+  }
+
+  // Lifetimes of the transient resources, in live pass indices.
+  std::vector<size_t> first(kResources, kPasses);
+  std::vector<size_t> last(kResources, 0);
+  for (size_t i = 0; i < kPasses; ++i) {
+    if (!live[i]) continue;
+
+    for (const std::vector<Resource> *list :
+         {&passes_[i].reads, &passes_[i].writes}) {
+      for (Resource r : *list) {
+        first[static_cast<size_t>(r)] =
+            std::min(first[static_cast<size_t>(r)], i);
+        last[static_cast<size_t>(r)] = std::max(last[static_cast<size_t>(r)], i);
+      }
+    }
+  }
+
+  stats_ = Stats();
+  std::set<RenderTarget *> transient_targets;
+
+  for (size_t i = 0; i < kPasses; ++i) {
+    if (!live[i]) {
+      ++stats_.culled;
+      continue;
+    }
+
+    for (size_t r = 0; r < kResources; ++r) {
+      if (resources_[r].transient && first[r] == i) {
+        resources_[r].target =
+            pool_->Acquire(width_, height_, resources_[r].internal_format, false);
+        transient_targets.insert(resources_[r].target);
+        ++stats_.transient_resources;
+      }
+    }
+
+    if (timer != nullptr) timer->BeginPass(passes_[i].name);
+    passes_[i].execute();
+    if (timer != nullptr) timer->EndPass();
+    ++stats_.passes;
+
+    for (size_t r = 0; r < kResources; ++r) {
+      if (resources_[r].transient && last[r] == i &&
+          resources_[r].target != nullptr) {
+        pool_->Release(resources_[r].target);
+        resources_[r].target = nullptr;
+      }
+    }
+  }
+
+  stats_.transient_targets = transient_targets.size();
+}
+
+}  //  namespace data_visualization
@@ -0,0 +1,150 @@
+// Author: Marc Comino 2020
+
+#ifndef RENDER_GRAPH_H_
+#define RENDER_GRAPH_H_
+
+#include <GL/glew.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "./render_target_pool.h"
+
+namespace data_visualization {
+
+/**
+ * @brief PassTimer Hooks called around the execution of every pass.
+ */
+class PassTimer {
+ public:
+  virtual ~PassTimer() {}
+
+  virtual void BeginPass(const std::string &name) = 0;
+  virtual void EndPass() = 0;
+};
+
+/**
+ * @brief RenderGraph A frame described as passes that declare the resources
+ * they read and write. Passes that do not contribute to the output, or whose
+ * cached output is still valid, are culled. Transient resources are acquired
+ * from the pool right before their first writer and released right after
+ * their last reader, so resources with non-overlapping lifetimes alias the
+ * same target.
+ */
+class RenderGraph {
+ public:
+  typedef int Resource;
+
+  /**
+   * @brief Stats Summary of the last Execute.
+   */
+  struct Stats {
+    size_t passes = 0;
+    size_t culled = 0;
+    size_t transient_resources = 0;
+    size_t transient_targets = 0;
+  };
+
+  /**
+   * @brief RenderGraph Constructor of the class.
+   * @param pool Pool the transient targets are acquired from.
+   * @param width Allocation width of the transient targets.
+   * @param height Allocation height of the transient targets.
+   */
+  RenderGraph(RenderTargetPool *pool, GLsizei width, GLsizei height);
+
+  /**
+   * @brief Import Registers a target owned outside the graph, which keeps its
+   * contents between frames.
+   * @param name Resource name, for debugging.
+   * @param target The persistent target.
+   * @return The resource handle.
+   */
+  Resource Import(const std::string &name, RenderTarget *target);
+
+  /**
+   * @brief Create Declares a transient resource, only valid during the frame.
+   * @param name Resource name, for debugging.
+   * @param internal_format Texture internal format.
+   * @return The resource handle.
+   */
+  Resource Create(const std::string &name, GLint internal_format);
+
+  /**
+   * @brief Backbuffer The default framebuffer.
+   * @return The resource handle.
+   */
+  Resource Backbuffer();
+
+  /**
+   * @brief AddPass Declares a pass. Passes run in declaration order.
+   * @param name Pass name, reported to the PassTimer.
+   * @param reads Resources sampled by the pass.
+   * @param writes Resources rendered by the pass.
+   * @param up_to_date Whether the writes already hold the pass result, in
+   * which case it does not run and its reads are not needed.
+   * @param execute Renders the pass.
+   */
+  void AddPass(const std::string &name, const std::vector<Resource> &reads,
+               const std::vector<Resource> &writes, bool up_to_date,
+               const std::function<void()> &execute);
+
+  /**
+   * @brief Target Target bound to a resource. Valid for imported resources,
+   * and for transient ones while their passes execute.
+   * @param resource The resource handle.
+   * @return The target, or nullptr for the back buffer.
+   */
+  RenderTarget *Target(Resource resource) const;
+
+  /**
+   * @brief Fbo Framebuffer of a resource, 0 for the back buffer.
+   */
+  GLuint Fbo(Resource resource) const;
+
+  /**
+   * @brief Texture Color texture of a resource.
+   */
+  GLuint Texture(Resource resource) const;
+
+  /**
+   * @brief Execute Culls the passes that do not contribute to the output and
+   * runs the rest.
+   * @param output Resource that has to be produced.
+   * @param timer Optional per-pass timing hooks.
+   */
+  void Execute(Resource output, PassTimer *timer);
+
+  const Stats &stats() const { return stats_; }
+
+ private:
+  struct ResourceNode {
+    std::string name;
+    GLint internal_format;
+    bool transient;
+    bool backbuffer;
+    RenderTarget *target;
+  };
+
+  struct PassNode {
+    std::string name;
+    std::vector<Resource> reads;
+    std::vector<Resource> writes;
+    bool up_to_date;
+    std::function<void()> execute;
+  };
+
+  RenderTargetPool *pool_;
+  GLsizei width_;
+  GLsizei height_;
+
+  std::vector<ResourceNode> resources_;
+  std::vector<PassNode> passes_;
+
+  Stats stats_;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  RENDER_GRAPH_H_
@@ -0,0 +1,156 @@
+// Author: Marc Comino 2020
+
+#include <render_target_pool.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace data_visualization {
+
+size_t BytesPerPixel(GLint internal_format) {
+  switch (internal_format) {
+    case GL_RGBA32F:
+      return 16;
+    case GL_RGBA16F:
+    case GL_RG32F:
+      return 8;
+    case GL_R32F:
+    case GL_RG16F:
+    case GL_RGBA8:
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH_COMPONENT24:
+      return 4;
+    case GL_R16F:
+      return 2;
+    case GL_R8:
+      return 1;
+    default:
+      return 16;
+  }
+}
+
+GLenum PixelFormat(GLint internal_format) {
+  switch (internal_format) {
+    case GL_R32F:
+    case GL_R16F:
+    case GL_R8:
+      return GL_RED;
+    case GL_RG32F:
+    case GL_RG16F:
+      return GL_RG;
+    default:
+      return GL_RGBA;
+  }
+}
+
+RenderTarget *RenderTargetPool::Acquire(GLsizei width, GLsizei height,
+                                        GLint internal_format,
+                                        bool depth_stencil) {
+  const GLsizei kWidth = Bucket(width);
+  const GLsizei kHeight = Bucket(height);
+
+  for (const std::unique_ptr<RenderTarget> &target : targets_) {
+    if (!target->in_use && target->width == kWidth &&
+        target->height == kHeight &&
+        target->internal_format == internal_format &&
+        (target->depth_stencil != 0) == depth_stencil) {
+      target->in_use = true;
+      return target.get();
+    }
+  }
+
+  std::unique_ptr<RenderTarget> target = std::make_unique<RenderTarget>();
+  target->internal_format = internal_format;
+  target->width = kWidth;
+  target->height = kHeight;
+  target->in_use = true;
+
+  glGenFramebuffers(1, &target->fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+
+  glGenTextures(1, &target->texture);
+  glBindTexture(GL_TEXTURE_2D, target->texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, internal_format, kWidth, kHeight, 0, PixelFormat(internal_format), GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->texture, 0);
+
+  if (depth_stencil) {
+    glGenRenderbuffers(1, &target->depth_stencil);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->depth_stencil);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, kWidth, kHeight);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target->depth_stencil);
+  }
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cout << "Framebuffer is not complete!" << glGetError() << std::endl;
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  targets_.push_back(std::move(target));
+  return targets_.back().get();
+}
+
+void RenderTargetPool::Release(RenderTarget *target) {
+  if (target != nullptr) target->in_use = false;
+}
+
+void RenderTargetPool::Trim() {
+  auto unused = std::stable_partition(
+      targets_.begin(), targets_.end(),
+      [](const std::unique_ptr<RenderTarget> &target) {
+        return target->in_use;
+      });
+
+  for (auto it = unused; it != targets_.end(); ++it) Delete(it->get());
+  targets_.erase(unused, targets_.end());
+}
+
+void RenderTargetPool::Clear() {
+  for (const std::unique_ptr<RenderTarget> &target : targets_)
+    Delete(target.get());
+  targets_.clear();
+}
+
+size_t RenderTargetPool::Targets() const { return targets_.size(); }
+
+size_t RenderTargetPool::GpuBytes(bool in_use_only) const {
+  size_t bytes = 0;
+  for (const std::unique_ptr<RenderTarget> &target : targets_) {
+    if (in_use_only && !target->in_use) continue;
+
+    bytes += TargetBytes(target.get());
+  }
+  return bytes;
+}
+
+size_t RenderTargetPool::TargetBytes(const RenderTarget *target) {
+  if (target == nullptr) return 0;
+
+  size_t pixels = static_cast<size_t>(target->width) *
+                  static_cast<size_t>(target->height);
+  size_t bytes = pixels * BytesPerPixel(target->internal_format);
+  if (target->depth_stencil != 0)
+    bytes += pixels * BytesPerPixel(GL_DEPTH24_STENCIL8);
+  return bytes;
+}
+
+GLsizei RenderTargetPool::Bucket(GLsizei size) {
+  size = std::max(size, 1);
+  return (size + kRenderTargetBucket - 1) / kRenderTargetBucket *
+         kRenderTargetBucket;
+}
+
+void RenderTargetPool::Delete(RenderTarget *target) const {
+  glDeleteFramebuffers(1, &target->fbo);
+  glDeleteTextures(1, &target->texture);
+  if (target->depth_stencil != 0)
+    glDeleteRenderbuffers(1, &target->depth_stencil);
+}
+
+}  //  namespace data_visualization
@@ -0,0 +1,114 @@
+// Author: Marc Comino 2020
+
+#ifndef RENDER_TARGET_POOL_H_
+#define RENDER_TARGET_POOL_H_
+
+#include <GL/glew.h>
+
+#include <memory>
+#include <vector>
+
+namespace data_visualization {
+
+/**
+ * @brief kRenderTargetBucket Render target sizes are rounded up to a multiple
+ * of this number of pixels, so that small resizes reuse the same allocation.
+ */
+const GLsizei kRenderTargetBucket = 256;
+
+/**
+ * @brief BytesPerPixel Estimated size of a texel of a color or depth format.
+ */
+size_t BytesPerPixel(GLint internal_format);
+
+/**
+ * @brief PixelFormat Client pixel format matching a color internal format,
+ * for allocating textures without data.
+ */
+GLenum PixelFormat(GLint internal_format);
+
+/**
+ * @brief RenderTarget A framebuffer with a single color texture and an
+ * optional depth and stencil renderbuffer.
+ */
+struct RenderTarget {
+  GLuint fbo = 0;
+  GLuint texture = 0;
+  GLuint depth_stencil = 0;
+
+  GLint internal_format = 0;
+
+  /**
+   * @brief width Allocated width. May be larger than the rendered viewport.
+   */
+  GLsizei width = 0;
+
+  /**
+   * @brief height Allocated height. May be larger than the rendered viewport.
+   */
+  GLsizei height = 0;
+
+  bool in_use = false;
+};
+
+class RenderTargetPool {
+ public:
+  /**
+   * @brief Acquire Returns a free target of the bucketed size and format,
+   * allocating a new one only when the pool has none.
+   * @param width Minimum width.
+   * @param height Minimum height.
+   * @param internal_format Texture internal format, e.g. GL_RGBA16F.
+   * @param depth_stencil Whether a GL_DEPTH24_STENCIL8 renderbuffer is needed.
+   * @return A target owned by the pool, valid until Clear.
+   */
+  RenderTarget *Acquire(GLsizei width, GLsizei height, GLint internal_format,
+                        bool depth_stencil);
+
+  /**
+   * @brief Release Gives a target back to the pool. It is kept allocated so
+   * that it can be reused by a later Acquire.
+   * @param target Target returned by Acquire, or nullptr.
+   */
+  void Release(RenderTarget *target);
+
+  /**
+   * @brief Trim Deletes the targets that are not in use.
+   */
+  void Trim();
+
+  /**
+   * @brief Clear Deletes every target. Requires a current GL context.
+   */
+  void Clear();
+
+  /**
+   * @brief Targets Number of allocated targets.
+   */
+  size_t Targets() const;
+
+  /**
+   * @brief GpuBytes Estimated GPU memory of the allocated targets.
+   * @param in_use_only Whether to account only the targets in use.
+   */
+  size_t GpuBytes(bool in_use_only = false) const;
+
+  /**
+   * @brief TargetBytes Estimated GPU memory of one target, 0 for nullptr.
+   */
+  static size_t TargetBytes(const RenderTarget *target);
+
+  /**
+   * @brief Bucket Rounds a size up to kRenderTargetBucket.
+   */
+  static GLsizei Bucket(GLsizei size);
+
+ private:
+  void Delete(RenderTarget *target) const;
+
+  std::vector<std::unique_ptr<RenderTarget>> targets_;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  RENDER_TARGET_POOL_H_
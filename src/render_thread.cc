@@ -0,0 +1,50 @@
+// Author: Marc Comino 2020
+
+#include <render_thread.h>
+
+#include <QCoreApplication>
+
+#include <utility>
+
+namespace gui {
+
+RenderThread::RenderThread(QGLWidget *widget, std::function<void()> frame)
+    : widget_(widget), frame_(std::move(frame)) {}
+
+void RenderThread::Wake() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_ = true;
+  }
+  wake_condition_.notify_one();
+}
+
+void RenderThread::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_condition_.notify_one();
+  wait();
+}
+
+void RenderThread::run() {
+  widget_->makeCurrent();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_condition_.wait(lock, [this]() { return wake_ || stop_; });
+    if (stop_) break;
+    wake_ = false;
+
+    lock.unlock();
+    frame_();
+    lock.lock();
+  }
+  lock.unlock();
+
+  widget_->doneCurrent();
+  widget_->context()->moveToThread(QCoreApplication::instance()->thread());
+}
+
+}  //  namespace gui
@@ -0,0 +1,57 @@
+// Author: Marc Comino 2020
+
+#ifndef RENDER_THREAD_H_
+#define RENDER_THREAD_H_
+
+#include <QGLWidget>
+#include <QThread>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace gui {
+
+/**
+ * @brief RenderThread Renders frames of a QGLWidget with the widget context
+ * current on its own thread. It sleeps until it is woken, renders one frame
+ * and goes back to sleep, so wakes arriving during a frame coalesce into the
+ * next one.
+ */
+class RenderThread : public QThread {
+ public:
+  /**
+   * @brief RenderThread Constructor of the class. The caller moves the widget
+   * context to the thread before starting it, and the thread moves it back
+   * to the GUI thread when it stops.
+   * @param widget Widget whose context is used.
+   * @param frame Renders and presents a frame.
+   */
+  RenderThread(QGLWidget *widget, std::function<void()> frame);
+
+  /**
+   * @brief Wake Requests a frame. Can be called from any thread.
+   */
+  void Wake();
+
+  /**
+   * @brief Stop Finishes the current frame and joins the thread.
+   */
+  void Stop();
+
+ protected:
+  void run() override;
+
+ private:
+  QGLWidget *widget_;
+  std::function<void()> frame_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_condition_;
+  bool wake_ = false;
+  bool stop_ = false;
+};
+
+}  //  namespace gui
+
+#endif  //  RENDER_THREAD_H_
@@ -0,0 +1,58 @@
+// Author: Marc Comino 2020
+
+#include <resolution_controller.h>
+
+#include <algorithm>
+
+namespace data_visualization {
+
+ResolutionController::ResolutionController()
+    : ResolutionController(Settings()) {}
+
+ResolutionController::ResolutionController(const Settings &settings)
+    : settings_(settings), scale_(settings.max_scale) {}
+
+void ResolutionController::SetBudget(double ms) {
+  settings_.budget_ms = ms;
+  frames_since_change_ = 0;
+}
+
+void ResolutionController::Reset() {
+  scale_ = settings_.max_scale;
+  ao_reduction_ = 0;
+  frames_since_change_ = 0;
+}
+
+bool ResolutionController::Update(double frame_ms) {
+  if (++frames_since_change_ < settings_.settle_frames || frame_ms <= 0.0)
+    return false;
+
+  const double kScale = scale_;
+  const int kAoReduction = ao_reduction_;
+
+  if (frame_ms > settings_.budget_ms) {
+    // Resolution first, it scales every pass.
+    if (scale_ > settings_.min_scale)
+      scale_ = std::max(settings_.min_scale, scale_ - settings_.scale_step);
+    else if (ao_reduction_ < settings_.max_ao_reduction)
+      ++ao_reduction_;
+  } else {
+    // Back up in the opposite order, predicting the new time. Halving the AO
+    // steps at most halves the frame time, and the cost of the passes grows
+    // with the pixel count.
+    const double kLimit = settings_.headroom * settings_.budget_ms;
+    if (ao_reduction_ > 0) {
+      if (frame_ms * 2.0 < kLimit) --ao_reduction_;
+    } else if (scale_ < settings_.max_scale) {
+      const double kUp = std::min(settings_.max_scale, scale_ + settings_.scale_step);
+      const double kRatio = kUp / scale_;
+      if (frame_ms * kRatio * kRatio < kLimit) scale_ = kUp;
+    }
+  }
+
+  const bool kChanged = scale_ != kScale || ao_reduction_ != kAoReduction;
+  if (kChanged) frames_since_change_ = 0;
+  return kChanged;
+}
+
+}  //  namespace data_visualization
@@ -0,0 +1,93 @@
+// Author: Marc Comino 2020
+
+#ifndef RESOLUTION_CONTROLLER_H_
+#define RESOLUTION_CONTROLLER_H_
+
+namespace data_visualization {
+
+/**
+ * @brief ResolutionController Chooses the internal render resolution, and
+ * when that is not enough the AO quality, to keep the GPU frame time within a
+ * budget. It steps down while over the budget, and only steps back up when
+ * the predicted frame time leaves some headroom, so it does not oscillate
+ * around the budget.
+ */
+class ResolutionController {
+ public:
+  struct Settings {
+    /**
+     * @brief budget_ms GPU frame time budget.
+     */
+    double budget_ms = 16.0;
+
+    double min_scale = 0.5;
+    double max_scale = 1.0;
+
+    /**
+     * @brief scale_step Change of the scale of each side per decision. Keeps
+     * the number of distinct sizes, and render targets, small.
+     */
+    double scale_step = 0.125;
+
+    /**
+     * @brief headroom Fraction of the budget the predicted frame time must
+     * stay under to step up.
+     */
+    double headroom = 0.8;
+
+    /**
+     * @brief settle_frames Frames to wait after a change before the next
+     * decision, so that the smoothed GPU times reflect it.
+     */
+    int settle_frames = 16;
+
+    /**
+     * @brief max_ao_reduction Times the AO steps can be halved once the scale
+     * is at its minimum.
+     */
+    int max_ao_reduction = 2;
+  };
+
+  ResolutionController();
+  explicit ResolutionController(const Settings &settings);
+
+  /**
+   * @brief SetBudget Changes the frame time budget.
+   * @param ms Budget in milliseconds.
+   */
+  void SetBudget(double ms);
+
+  double budget_ms() const { return settings_.budget_ms; }
+
+  /**
+   * @brief Reset Goes back to the maximum scale and full AO quality.
+   */
+  void Reset();
+
+  /**
+   * @brief Update Feeds the GPU time of a frame.
+   * @param frame_ms Smoothed GPU frame time in milliseconds.
+   * @return Whether the scale or the AO reduction changed.
+   */
+  bool Update(double frame_ms);
+
+  /**
+   * @brief scale Internal resolution over the window size, per side.
+   */
+  double scale() const { return scale_; }
+
+  /**
+   * @brief ao_reduction Times the AO steps are halved.
+   */
+  int ao_reduction() const { return ao_reduction_; }
+
+ private:
+  Settings settings_;
+  double scale_;
+  int ao_reduction_ = 0;
+  int frames_since_change_ = 0;
+};
+
+}  //  namespace data_visualization
+
+#endif  //  RESOLUTION_CONTROLLER_H_
@@ -0,0 +1,208 @@
+// Author: Marc Comino 2020
+
+#include <scene.h>
+
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./mesh_io.h"
+
+namespace data_representation {
+
+Scene::Scene() { Clear(); }
+
+void Scene::Clear() {
+  vertices_.clear();
+  normals_.clear();
+  indices_.clear();
+  meshes_.clear();
+  instances_.clear();
+  geometry_released_ = false;
+
+  min_ = Eigen::Vector3f(std::numeric_limits<float>::max(),
+                         std::numeric_limits<float>::max(),
+                         std::numeric_limits<float>::max());
+  max_ = Eigen::Vector3f(std::numeric_limits<float>::lowest(),
+                         std::numeric_limits<float>::lowest(),
+                         std::numeric_limits<float>::lowest());
+}
+
+size_t Scene::AddMesh(const TriangleMesh &mesh) {
+  assert(!geometry_released_);
+  MeshRange range;
+  range.first_index = static_cast<uint32_t>(indices_.size());
+  range.index_count = static_cast<uint32_t>(mesh.faces_.size());
+  range.base_vertex = static_cast<uint32_t>(vertices_.size() / 3);
+  range.vertex_count = static_cast<uint32_t>(mesh.vertices_.size() / 3);
+  range.min = mesh.min_;
+  range.max = mesh.max_;
+  meshes_.push_back(range);
+
+  vertices_.insert(vertices_.end(), mesh.vertices_.begin(), mesh.vertices_.end());
+  normals_.insert(normals_.end(), mesh.normals_.begin(), mesh.normals_.end());
+  for (int index : mesh.faces_) indices_.push_back(static_cast<uint32_t>(index));
+
+  return meshes_.size() - 1;
+}
+
+void Scene::AddInstance(size_t mesh, const Eigen::Matrix4f &transform) {
+  assert(mesh < meshes_.size());
+  instances_.push_back({mesh, transform});
+
+  // Transformed corners of the mesh box.
+  const MeshRange &kRange = meshes_[mesh];
+  for (int i = 0; i < 8; ++i) {
+    const Eigen::Vector4f kCorner((i & 1) ? kRange.max[0] : kRange.min[0],
+                                  (i & 2) ? kRange.max[1] : kRange.min[1],
+                                  (i & 4) ? kRange.max[2] : kRange.min[2], 1.0f);
+    const Eigen::Vector3f kPoint = (transform * kCorner).head<3>();
+    min_ = min_.cwiseMin(kPoint);
+    max_ = max_.cwiseMax(kPoint);
+  }
+}
+
+void Scene::BuildDraws(std::vector<DrawCommand> *commands,
+                       std::vector<float> *transforms) const {
+  std::vector<std::vector<size_t>> by_mesh(meshes_.size());
+  for (size_t i = 0; i < instances_.size(); ++i)
+    by_mesh[instances_[i].mesh].push_back(i);
+
+  commands->clear();
+  transforms->clear();
+  transforms->reserve(instances_.size() * 16);
+  for (size_t mesh = 0; mesh < meshes_.size(); ++mesh) {
+    if (by_mesh[mesh].empty()) continue;
+
+    const MeshRange &kRange = meshes_[mesh];
+    DrawCommand command;
+    command.count = kRange.index_count;
+    command.instance_count = static_cast<uint32_t>(by_mesh[mesh].size());
+    command.first_index = kRange.first_index;
+    command.base_vertex = kRange.base_vertex;
+    command.base_instance = static_cast<uint32_t>(transforms->size() / 16);
+    commands->push_back(command);
+
+    for (size_t i : by_mesh[mesh]) {
+      const auto &kTransform = instances_[i].transform;
+      transforms->insert(transforms->end(), kTransform.data(), kTransform.data() + 16);
+    }
+  }
+}
+
+size_t Scene::Triangles() const {
+  size_t triangles = 0;
+  for (const Instance &instance : instances_)
+    triangles += meshes_[instance.mesh].index_count / 3;
+  return triangles;
+}
+
+size_t Scene::Vertices() const {
+  size_t vertices = 0;
+  for (const Instance &instance : instances_) vertices += meshes_[instance.mesh].vertex_count;
+  return vertices;
+}
+
+void Scene::ReleaseGeometry() {
+  // Swapping with empty vectors frees the storage, unlike clear.
+  std::vector<float>().swap(vertices_);
+  std::vector<float>().swap(normals_);
+  std::vector<uint32_t>().swap(indices_);
+  geometry_released_ = true;
+}
+
+size_t Scene::CpuBytes() const {
+  return vertices_.capacity() * sizeof(float) + normals_.capacity() * sizeof(float) +
+         indices_.capacity() * sizeof(uint32_t) + meshes_.capacity() * sizeof(MeshRange) +
+         instances_.capacity() * sizeof(Instance);
+}
+
+bool ReadFromScene(const std::string &filename, Scene *scene, const WeldOptions *weld) {
+  std::ifstream fin(filename);
+  if (!fin.is_open()) return false;
+
+  const size_t kSlash = filename.find_last_of('/');
+  const std::string kDirectory = kSlash == std::string::npos ? "" : filename.substr(0, kSlash + 1);
+
+  // The meshes are loaded in parallel once the whole description is read.
+  std::vector<std::string> paths;
+  std::vector<std::pair<size_t, Eigen::Matrix<float, 4, 4, Eigen::DontAlign>>> instances;
+  std::string line;
+  while (std::getline(fin, line)) {
+    std::istringstream in(line);
+    std::string keyword;
+    if (!(in >> keyword) || keyword[0] == '#') continue;
+
+    if (keyword == "mesh") {
+      std::string path;
+      in >> path;
+      if (!path.empty() && path[0] != '/') path = kDirectory + path;
+      paths.push_back(path);
+    } else if (keyword == "instance") {
+      size_t mesh;
+      float tx, ty, tz;
+      float scale = 1.0f;
+      float rotation = 0.0f;
+      if (!(in >> mesh >> tx >> ty >> tz) || mesh >= paths.size()) {
+        std::cerr << "Wrong instance: " << line << std::endl;
+        return false;
+      }
+      in >> scale >> rotation;
+
+      const Eigen::Affine3f kTransform =
+          Eigen::Translation3f(tx, ty, tz) *
+          Eigen::AngleAxisf(rotation * static_cast<float>(M_PI / 180.0), Eigen::Vector3f::UnitY()) *
+          Eigen::Scaling(scale);
+      instances.emplace_back(mesh, kTransform.matrix());
+    } else {
+      std::cerr << "Unknown scene keyword: " << keyword << std::endl;
+      return false;
+    }
+  }
+
+  // A mesh that fails cancels the ones that have not started. Every load
+  // prints to its own buffer, printed in scene order once all are done.
+  std::vector<TriangleMesh> meshes(paths.size());
+  std::vector<std::ostringstream> logs(paths.size());
+  std::vector<char> failed(paths.size(), 0);
+  TaskGroup loads;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    loads.Run([&, i]() {
+      if (!ReadFromPly(paths[i], &meshes[i], nullptr, &logs[i])) {
+        failed[i] = 1;
+        loads.Cancel();
+        return;
+      }
+      if (weld != nullptr) WeldVertices(&meshes[i], *weld).Print(&logs[i]);
+    });
+  }
+  const bool kLoaded = loads.Wait();
+  for (size_t i = 0; i < paths.size(); ++i) {
+    std::cout << logs[i].str();
+    if (failed[i]) std::cerr << "Could not read " << paths[i] << std::endl;
+  }
+  if (!kLoaded) return false;
+
+  scene->Clear();
+  for (TriangleMesh &mesh : meshes) {
+    scene->AddMesh(mesh);
+    mesh = TriangleMesh();
+  }
+  for (const auto &kInstance : instances) scene->AddInstance(kInstance.first, kInstance.second);
+
+  std::cout << "Loading scene" << std::endl;
+  std::cout << "\tMeshes = " << scene->meshes().size() << std::endl;
+  std::cout << "\tInstances = " << scene->instances().size() << std::endl;
+
+  return !scene->instances().empty();
+}
+
+}  // namespace data_representation
@@ -0,0 +1,163 @@
+// Author: Marc Comino 2020
+
+#ifndef SCENE_H_
+#define SCENE_H_
+
+#include <eigen3/Eigen/Geometry>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "./mesh_processing.h"
+#include "./triangle_mesh.h"
+
+namespace data_representation {
+
+/**
+ * @brief MeshRange Where a mesh lies in the scene arena.
+ */
+struct MeshRange {
+  uint32_t first_index;
+  uint32_t index_count;
+  uint32_t base_vertex;
+  uint32_t vertex_count;
+
+  Eigen::Vector3f min;
+  Eigen::Vector3f max;
+};
+
+/**
+ * @brief Instance A placement of a mesh in the scene.
+ */
+struct Instance {
+  size_t mesh;
+
+  // Unaligned, so that instances can be stored in a std::vector.
+  Eigen::Matrix<float, 4, 4, Eigen::DontAlign> transform;
+};
+
+/**
+ * @brief DrawCommand One instanced draw of a mesh. Same layout as the
+ * DrawElementsIndirectCommand of glMultiDrawElementsIndirect.
+ */
+struct DrawCommand {
+  uint32_t count;
+  uint32_t instance_count;
+  uint32_t first_index;
+  uint32_t base_vertex;
+  uint32_t base_instance;
+};
+
+/**
+ * @brief Scene Several meshes packed into one vertex and index arena, and the
+ * instances placing them. The whole scene is drawn with one instanced draw
+ * per mesh, or a single multi draw indirect.
+ */
+class Scene {
+ public:
+  Scene();
+
+  /**
+   * @brief Clear Removes every mesh and instance.
+   */
+  void Clear();
+
+  /**
+   * @brief AddMesh Appends a mesh to the arena. Its indices stay relative to
+   * its first vertex, the draws add the base vertex.
+   * @param mesh Mesh to append.
+   * @return The mesh index, to add instances of it.
+   */
+  size_t AddMesh(const TriangleMesh &mesh);
+
+  /**
+   * @brief AddInstance Places a mesh in the scene.
+   * @param mesh Mesh index returned by AddMesh.
+   * @param transform Model transform of the instance.
+   */
+  void AddInstance(size_t mesh, const Eigen::Matrix4f &transform);
+
+  /**
+   * @brief BuildDraws Groups the instances by mesh.
+   * @param commands One command per mesh with instances.
+   * @param transforms Column major instance transforms, 16 floats each, in
+   * the base_instance order of the commands.
+   */
+  void BuildDraws(std::vector<DrawCommand> *commands,
+                  std::vector<float> *transforms) const;
+
+  const std::vector<float> &vertices() const { return vertices_; }
+  const std::vector<float> &normals() const { return normals_; }
+  const std::vector<uint32_t> &indices() const { return indices_; }
+  const std::vector<MeshRange> &meshes() const { return meshes_; }
+  const std::vector<Instance> &instances() const { return instances_; }
+
+  /**
+   * @brief ReleaseGeometry Frees the vertex and index arena once it has been
+   * uploaded. The mesh ranges, the instances and the bounding boxes are kept,
+   * so the scene can still be drawn from the GPU buffers, but no mesh can be
+   * added until the next Clear.
+   */
+  void ReleaseGeometry();
+
+  /**
+   * @brief geometry_released Whether ReleaseGeometry freed the arena.
+   */
+  bool geometry_released() const { return geometry_released_; }
+
+  /**
+   * @brief CpuBytes CPU memory of the arena, the ranges and the instances.
+   */
+  size_t CpuBytes() const;
+
+  /**
+   * @brief Triangles Triangles drawn, counting every instance.
+   */
+  size_t Triangles() const;
+
+  /**
+   * @brief Vertices Vertices drawn, counting every instance.
+   */
+  size_t Vertices() const;
+
+  /**
+   * @brief min The minimum point of the bounding box of the instances.
+   */
+  Eigen::Vector3f min_;
+
+  /**
+   * @brief max The maximum point of the bounding box of the instances.
+   */
+  Eigen::Vector3f max_;
+
+ private:
+  std::vector<float> vertices_;
+  std::vector<float> normals_;
+  std::vector<uint32_t> indices_;
+
+  std::vector<MeshRange> meshes_;
+  std::vector<Instance> instances_;
+
+  bool geometry_released_ = false;
+};
+
+/**
+ * @brief ReadFromScene Reads a scene description. Every line is either
+ * "mesh <PLY path>", relative paths being relative to the scene file, or
+ * "instance <mesh> <tx> <ty> <tz> [<scale> [<rotation around y in degrees>]]",
+ * meshes being numbered in order from 0. Lines starting with # are ignored.
+ * The meshes are read and welded in parallel by the default scheduler, and
+ * added to the arena in order.
+ * @param filename The path to the scene.
+ * @param scene The resulting scene.
+ * @param weld If not null, the meshes are welded with these options.
+ * @return Whether it was able to read the file and every mesh.
+ */
+bool ReadFromScene(const std::string &filename, Scene *scene,
+                   const WeldOptions *weld = nullptr);
+
+}  // namespace data_representation
+
+#endif  //  SCENE_H_
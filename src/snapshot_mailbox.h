@@ -0,0 +1,64 @@
+// Author: Marc Comino 2020
+
+#ifndef SNAPSHOT_MAILBOX_H_
+#define SNAPSHOT_MAILBOX_H_
+
+#include <array>
+#include <atomic>
+
+namespace data_visualization {
+
+/**
+ * @brief SnapshotMailbox Hands the latest value over from one writer thread to
+ * one reader thread without locks. It is a triple buffer: the writer fills its
+ * own slot and swaps it with the shared one, the reader swaps the shared slot
+ * with its own when it holds a newer value. Neither side ever waits, and
+ * values published while the reader is busy are replaced by the newest one.
+ */
+template <typename T>
+class SnapshotMailbox {
+ public:
+  SnapshotMailbox() : shared_(1) {}
+
+  /**
+   * @brief Publish Makes a value available to the reader. Writer thread only.
+   * @param value The value.
+   */
+  void Publish(const T &value) {
+    slots_[back_] = value;
+    back_ = shared_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+  }
+
+  /**
+   * @brief Take Reads the newest value published since the last Take. Reader
+   * thread only.
+   * @param value The value, untouched if there is nothing new.
+   * @return Whether there was a new value.
+   */
+  bool Take(T *value) {
+    if ((shared_.load(std::memory_order_acquire) & kFresh) == 0) return false;
+
+    front_ = shared_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    *value = slots_[front_];
+    return true;
+  }
+
+ private:
+  static const int kIndex = 0x3;
+  static const int kFresh = 0x4;
+
+  std::array<T, 3> slots_;
+
+  /**
+   * @brief shared_ Index of the shared slot, with kFresh set when it has not
+   * been taken yet.
+   */
+  std::atomic<int> shared_;
+
+  int front_ = 0;  // Reader slot.
+  int back_ = 2;   // Writer slot.
+};
+
+}  //  namespace data_visualization
+
+#endif  //  SNAPSHOT_MAILBOX_H_
@@ -0,0 +1,140 @@
+// Author: Marc Comino 2020
+
+#include <task_scheduler.h>
+
+#include <chrono>
+#include <utility>
+
+namespace data_representation {
+
+namespace {
+
+/**
+ * @brief kHelpInterval Longest sleep of a thread waiting for a group before
+ * it looks for tasks to run again, e.g. ones spawned by the tasks it waits
+ * for.
+ */
+const std::chrono::microseconds kHelpInterval(500);
+
+/**
+ * @brief WorkerIdentity Scheduler and queue of the calling thread, if it is a
+ * worker.
+ */
+struct WorkerIdentity {
+  const TaskScheduler *scheduler = nullptr;
+  size_t queue = 0;
+};
+
+thread_local WorkerIdentity t_worker;
+
+}  // namespace
+
+TaskScheduler::TaskScheduler(unsigned int threads) {
+  const unsigned int kThreads = threads > 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+  for (unsigned int i = 0; i < kThreads; ++i) queues_.push_back(std::make_unique<Queue>());
+  for (size_t i = 1; i < kThreads; ++i) workers_.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  sleep_condition_.notify_all();
+  for (std::thread &worker : workers_) worker.join();
+}
+
+TaskScheduler &TaskScheduler::Default() {
+  static TaskScheduler scheduler;
+  return scheduler;
+}
+
+void TaskScheduler::Push(Task task) {
+  const size_t kQueue = t_worker.scheduler == this ? t_worker.queue : 0;
+  {
+    std::lock_guard<std::mutex> lock(queues_[kQueue]->mutex);
+    queues_[kQueue]->tasks.push_back(std::move(task));
+    queued_.fetch_add(1);
+  }
+
+  // Taking the lock orders the wake after a worker that just found nothing
+  // to do has started waiting.
+  { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+  sleep_condition_.notify_one();
+}
+
+bool TaskScheduler::RunOne() {
+  const size_t kOwn = t_worker.scheduler == this ? t_worker.queue : 0;
+  const size_t kQueues = queues_.size();
+
+  Task task;
+  bool found = false;
+  for (size_t i = 0; i < kQueues && !found; ++i) {
+    Queue &queue = *queues_[(kOwn + i) % kQueues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) continue;
+
+    // The owner takes its newest task, still warm in cache, and thieves the
+    // oldest one, usually the largest piece of work left.
+    if (i == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    queued_.fetch_sub(1);
+    found = true;
+  }
+  if (!found) return false;
+
+  if (!task.group->cancelled()) task.function();
+  task.group->Finish();
+  return true;
+}
+
+void TaskScheduler::WorkerLoop(size_t queue) {
+  t_worker.scheduler = this;
+  t_worker.queue = queue;
+
+  while (true) {
+    if (RunOne()) continue;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleep_condition_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+    if (stop_ && queued_.load() == 0) return;
+  }
+}
+
+TaskGroup::TaskGroup(TaskScheduler *scheduler)
+    : scheduler_(scheduler != nullptr ? scheduler : &TaskScheduler::Default()) {}
+
+TaskGroup::~TaskGroup() { Wait(); }
+
+void TaskGroup::Run(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++pending_;
+  }
+  scheduler_->Push({std::move(task), this});
+}
+
+bool TaskGroup::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (pending_ > 0) {
+    lock.unlock();
+    const bool kRan = scheduler_->RunOne();
+    lock.lock();
+    if (!kRan && pending_ > 0) done_.wait_for(lock, kHelpInterval);
+  }
+  return !cancelled();
+}
+
+void TaskGroup::Finish() {
+  // Notifying under the lock keeps the group alive until the waiter, which
+  // may destroy it, has seen the last task finish.
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (--pending_ == 0) done_.notify_all();
+}
+
+}  // namespace data_representation
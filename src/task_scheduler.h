@@ -0,0 +1,196 @@
+// Author: Marc Comino 2020
+
+#ifndef TASK_SCHEDULER_H_
+#define TASK_SCHEDULER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace data_representation {
+
+class TaskGroup;
+
+/**
+ * @brief TaskScheduler Work stealing thread pool. Every worker pushes the
+ * tasks it spawns to its own queue and runs them newest first, and steals
+ * the oldest task of another queue when its own is empty. Tasks spawned
+ * outside the pool go to a shared queue. Threads that wait for a TaskGroup
+ * run tasks meanwhile, so tasks can spawn and wait for tasks of their own.
+ */
+class TaskScheduler {
+ public:
+  /**
+   * @brief TaskScheduler Starts the workers.
+   * @param threads Threads running tasks, counting the one that waits for
+   * them, 0 for one per core. With 1 every task runs on the waiting thread.
+   */
+  explicit TaskScheduler(unsigned int threads = 0);
+
+  /**
+   * @brief ~TaskScheduler Runs the queued tasks and joins the workers.
+   */
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  /**
+   * @brief Default Scheduler with one thread per core, shared by the loaders
+   * and the mesh processing unless they are given another one.
+   */
+  static TaskScheduler &Default();
+
+  unsigned int threads() const { return static_cast<unsigned int>(queues_.size()); }
+
+  /**
+   * @brief chunks Number of chunks to split a parallel loop into. A few per
+   * thread, so that threads that finish early steal the remaining ones.
+   */
+  size_t chunks() const { return 4 * queues_.size(); }
+
+ private:
+  friend class TaskGroup;
+
+  struct Task {
+    std::function<void()> function;
+    TaskGroup *group;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief Push Queues a task on the queue of the calling worker, or on the
+   * shared queue from other threads, and wakes a worker.
+   */
+  void Push(Task task);
+
+  /**
+   * @brief RunOne Runs a task of the calling thread queue or, if it is empty,
+   * one stolen from another queue.
+   * @return Whether a task was run.
+   */
+  bool RunOne();
+
+  void WorkerLoop(size_t queue);
+
+  /**
+   * @brief queues_ Queue 0 is shared by the threads outside the pool, the
+   * others belong to one worker each.
+   */
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  /**
+   * @brief queued_ Tasks in all the queues, the workers sleep while it is 0.
+   */
+  std::atomic<size_t> queued_{0};
+
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  bool stop_ = false;
+};
+
+/**
+ * @brief TaskGroup Tasks that are waited for together. Cancelling the group
+ * skips its tasks that have not started; running ones can poll cancelled()
+ * to stop early.
+ */
+class TaskGroup {
+ public:
+  /**
+   * @brief TaskGroup Constructor of the class.
+   * @param scheduler Scheduler of the tasks, nullptr for the default one.
+   */
+  explicit TaskGroup(TaskScheduler *scheduler = nullptr);
+
+  /**
+   * @brief ~TaskGroup Waits for the tasks.
+   */
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  /**
+   * @brief Run Queues a task. Can be called from any thread, including from
+   * the tasks of the group.
+   */
+  void Run(std::function<void()> task);
+
+  /**
+   * @brief Wait Runs queued tasks until every task of the group has finished
+   * or been skipped.
+   * @return Whether the group was not cancelled.
+   */
+  bool Wait();
+
+  /**
+   * @brief Cancel Skips the tasks of the group that have not started yet.
+   */
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+  TaskScheduler *scheduler() const { return scheduler_; }
+
+ private:
+  friend class TaskScheduler;
+
+  /**
+   * @brief Finish Accounts a task that has run or been skipped.
+   */
+  void Finish();
+
+  TaskScheduler *scheduler_;
+  std::atomic<bool> cancelled_{false};
+
+  std::mutex mutex_;
+  std::condition_variable done_;
+  size_t pending_ = 0;
+};
+
+/**
+ * @brief ParallelFor Splits [0, count) into contiguous chunks and calls
+ * work(chunk, begin, end) for each as tasks of a group, the first chunk on
+ * the calling thread. The chunk boundaries only depend on count and chunks,
+ * so per chunk results can be combined deterministically.
+ * @param group Group of the chunks, cancelling it skips the chunks that have
+ * not started.
+ * @param count Number of items.
+ * @param chunks Number of chunks, at most count.
+ * @param work Called once per chunk, concurrently.
+ * @return Whether the group was not cancelled.
+ */
+template <typename Work>
+bool ParallelFor(TaskGroup *group, size_t count, size_t chunks, const Work &work) {
+  chunks = std::max<size_t>(std::min(chunks, count), 1);
+  for (size_t c = 1; c < chunks; ++c)
+    group->Run([&work, c, count, chunks]() { work(c, count * c / chunks, count * (c + 1) / chunks); });
+  if (!group->cancelled()) work(0, 0, count / chunks);
+  return group->Wait();
+}
+
+/**
+ * @brief ParallelFor Runs the chunks in a group of their own.
+ * @param scheduler Scheduler of the chunks, nullptr for the default one.
+ */
+template <typename Work>
+bool ParallelFor(TaskScheduler *scheduler, size_t count, size_t chunks, const Work &work) {
+  TaskGroup group(scheduler);
+  return ParallelFor(&group, count, chunks, work);
+}
+
+}  // namespace data_representation
+
+#endif  // TASK_SCHEDULER_H_
@@ -0,0 +1,1072 @@
+// Author: Marc Comino 2020
+
+#include <vulkan_backend.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace data_visualization {
+
+namespace {
+
+const VkFormat kGFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+const VkFormat kDepthFormat = VK_FORMAT_D32_SFLOAT;
+const VkFormat kAoFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+const VkFormat kNoiseFormat = VK_FORMAT_R32_SFLOAT;
+
+/**
+ * @brief kComputeTile Workgroup side of hbao.comp and blur.comp.
+ */
+const uint32_t kComputeTile = 16;
+
+/**
+ * @brief HbaoConstants Push constants of vk/hbao.comp, same layout as its
+ * Parameters block.
+ */
+struct HbaoConstants {
+  float projection[16];
+  float aspect_ratio;
+  float tan_half_fov;
+  float ray_center[2];
+  float pixel_size[2];
+  int32_t viewport_size[2];
+  int32_t directions;
+  int32_t steps;
+  float radius;
+  float t_bias;
+  float strength;
+};
+
+/**
+ * @brief BlurConstants Push constants of vk/blur.comp.
+ */
+struct BlurConstants {
+  int32_t direction[2];
+  int32_t viewport_size[2];
+};
+
+bool Succeeded(VkResult result, const char *call) {
+  if (result == VK_SUCCESS) return true;
+  std::cerr << "Vulkan: " << call << " failed (" << result << ")" << std::endl;
+  return false;
+}
+
+bool ReadSpirv(const std::string &path, std::vector<uint32_t> *code) {
+  std::ifstream in(path, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+  if (!in.is_open()) {
+    std::cerr << "Vulkan: could not read " << path << std::endl;
+    return false;
+  }
+
+  const std::streamsize kSize = in.tellg();
+  if (kSize <= 0 || kSize % 4 != 0) return false;
+  code->resize(static_cast<size_t>(kSize) / 4);
+  in.seekg(0);
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(code->data()), kSize));
+}
+
+bool CreateShaderModule(VkDevice device, const std::string &path, VkShaderModule *module) {
+  std::vector<uint32_t> code;
+  if (!ReadSpirv(path, &code)) return false;
+
+  VkShaderModuleCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  info.codeSize = code.size() * sizeof(uint32_t);
+  info.pCode = code.data();
+  return Succeeded(vkCreateShaderModule(device, &info, nullptr, module), "vkCreateShaderModule");
+}
+
+bool CreateComputePipeline(VkDevice device, const std::string &path, VkPipelineLayout layout,
+                           VkPipeline *pipeline) {
+  VkShaderModule module;
+  if (!CreateShaderModule(device, path, &module)) return false;
+
+  VkComputePipelineCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  info.stage.module = module;
+  info.stage.pName = "main";
+  info.layout = layout;
+
+  const bool kRes = Succeeded(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, pipeline),
+                              "vkCreateComputePipelines");
+  vkDestroyShaderModule(device, module, nullptr);
+  return kRes;
+}
+
+bool CreatePipelineLayout(VkDevice device, const VkDescriptorSetLayout *set_layout,
+                          VkShaderStageFlags stages, uint32_t constants_size,
+                          VkPipelineLayout *layout) {
+  VkPushConstantRange range = {};
+  range.stageFlags = stages;
+  range.size = constants_size;
+
+  VkPipelineLayoutCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  info.setLayoutCount = set_layout != nullptr ? 1 : 0;
+  info.pSetLayouts = set_layout;
+  info.pushConstantRangeCount = 1;
+  info.pPushConstantRanges = &range;
+  return Succeeded(vkCreatePipelineLayout(device, &info, nullptr, layout), "vkCreatePipelineLayout");
+}
+
+VkDescriptorSetLayoutBinding LayoutBinding(uint32_t binding, VkDescriptorType type) {
+  VkDescriptorSetLayoutBinding layout_binding = {};
+  layout_binding.binding = binding;
+  layout_binding.descriptorType = type;
+  layout_binding.descriptorCount = 1;
+  layout_binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  return layout_binding;
+}
+
+/**
+ * @brief ComputeBarrier Makes the shader writes of a dispatch visible to the
+ * next one. Every storage image stays in the general layout.
+ */
+void ComputeBarrier(VkCommandBuffer commands) {
+  VkMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+}
+
+void ImageBarrier(VkCommandBuffer commands, VkImage image, VkImageLayout from,
+                  VkImageLayout to, VkAccessFlags dst_access,
+                  VkPipelineStageFlags dst_stage) {
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = dst_access;
+  barrier.oldLayout = from;
+  barrier.newLayout = to;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.layerCount = 1;
+  vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dst_stage, 0,
+                       0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+}  //  namespace
+
+VulkanRenderer::~VulkanRenderer() { Release(); }
+
+bool VulkanRenderer::Initialize(const std::string &shader_dir,
+                                const std::vector<float> &noise, int noise_side) {
+  Release();
+
+  if (!CreateDevice() || !CreatePipelines(shader_dir) ||
+      !CreateNoiseTexture(noise, noise_side)) {
+    Release();
+    return false;
+  }
+
+  for (FrameResources &frame : frames_) {
+    VkCommandBufferAllocateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    info.commandBufferCount = 1;
+    info.commandPool = graphics_pool_;
+    bool res = Succeeded(vkAllocateCommandBuffers(device_, &info, &frame.graphics_commands),
+                         "vkAllocateCommandBuffers");
+    info.commandPool = compute_pool_;
+    res = res && Succeeded(vkAllocateCommandBuffers(device_, &info, &frame.compute_commands),
+                           "vkAllocateCommandBuffers");
+
+    VkSemaphoreCreateInfo semaphore_info = {};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    res = res && Succeeded(vkCreateSemaphore(device_, &semaphore_info, nullptr, &frame.g_done),
+                           "vkCreateSemaphore");
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    res = res && Succeeded(vkCreateFence(device_, &fence_info, nullptr, &frame.graphics_fence),
+                           "vkCreateFence");
+    res = res && Succeeded(vkCreateFence(device_, &fence_info, nullptr, &frame.compute_fence),
+                           "vkCreateFence");
+    if (!res) {
+      Release();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool VulkanRenderer::CreateDevice() {
+  VkApplicationInfo application = {};
+  application.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+  application.pApplicationName = "hbao";
+  application.apiVersion = VK_API_VERSION_1_0;
+
+  VkInstanceCreateInfo instance_info = {};
+  instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+  instance_info.pApplicationInfo = &application;
+  if (!Succeeded(vkCreateInstance(&instance_info, nullptr, &instance_), "vkCreateInstance"))
+    return false;
+
+  uint32_t count = 0;
+  vkEnumeratePhysicalDevices(instance_, &count, nullptr);
+  std::vector<VkPhysicalDevice> devices(count);
+  vkEnumeratePhysicalDevices(instance_, &count, devices.data());
+
+  // Prefers a discrete GPU, and takes any device with a graphics and compute
+  // queue otherwise (lavapipe is a CPU device).
+  bool found = false;
+  bool discrete = false;
+  for (VkPhysicalDevice device : devices) {
+    VkPhysicalDeviceProperties device_properties;
+    vkGetPhysicalDeviceProperties(device, &device_properties);
+    const bool kDiscrete = device_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+    if (found && (discrete || !kDiscrete)) continue;
+
+    uint32_t families = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &families, nullptr);
+    std::vector<VkQueueFamilyProperties> properties(families);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &families, properties.data());
+
+    const VkQueueFlags kGraphics = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+    for (uint32_t i = 0; i < families; ++i) {
+      if ((properties[i].queueFlags & kGraphics) != kGraphics) continue;
+
+      physical_device_ = device;
+      graphics_family_ = i;
+      device_name_ = device_properties.deviceName;
+      found = true;
+      discrete = kDiscrete;
+      break;
+    }
+  }
+
+  if (!found) {
+    std::cerr << "Vulkan: no device with a graphics queue" << std::endl;
+    return false;
+  }
+
+  uint32_t families = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &families, nullptr);
+  std::vector<VkQueueFamilyProperties> properties(families);
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &families, properties.data());
+
+  // An async compute family when there is one, a second queue of the graphics
+  // family otherwise, and the graphics queue itself as a last resort.
+  compute_family_ = graphics_family_;
+  uint32_t compute_index = 0;
+  for (uint32_t i = 0; i < families; ++i) {
+    if ((properties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 &&
+        (properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+      compute_family_ = i;
+      break;
+    }
+  }
+  if (compute_family_ == graphics_family_ && properties[graphics_family_].queueCount > 1)
+    compute_index = 1;
+
+  const float kPriorities[] = {1.0f, 1.0f};
+  VkDeviceQueueCreateInfo queue_infos[2] = {};
+  queue_infos[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+  queue_infos[0].queueFamilyIndex = graphics_family_;
+  queue_infos[0].queueCount = compute_index + 1;
+  queue_infos[0].pQueuePriorities = kPriorities;
+  queue_infos[1] = queue_infos[0];
+  queue_infos[1].queueFamilyIndex = compute_family_;
+  queue_infos[1].queueCount = 1;
+
+  VkDeviceCreateInfo device_info = {};
+  device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  device_info.queueCreateInfoCount = compute_family_ != graphics_family_ ? 2 : 1;
+  device_info.pQueueCreateInfos = queue_infos;
+  if (!Succeeded(vkCreateDevice(physical_device_, &device_info, nullptr, &device_), "vkCreateDevice"))
+    return false;
+
+  vkGetDeviceQueue(device_, graphics_family_, 0, &graphics_queue_);
+  vkGetDeviceQueue(device_, compute_family_, compute_index, &compute_queue_);
+
+  VkCommandPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  pool_info.queueFamilyIndex = graphics_family_;
+  if (!Succeeded(vkCreateCommandPool(device_, &pool_info, nullptr, &graphics_pool_), "vkCreateCommandPool"))
+    return false;
+  pool_info.queueFamilyIndex = compute_family_;
+  return Succeeded(vkCreateCommandPool(device_, &pool_info, nullptr, &compute_pool_), "vkCreateCommandPool");
+}
+
+bool VulkanRenderer::CreatePipelines(const std::string &shader_dir) {
+  // G pass render pass. The G buffer ends up ready to be sampled by the AO,
+  // on whichever queue it runs.
+  VkAttachmentDescription attachments[2] = {};
+  attachments[0].format = kGFormat;
+  attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+  attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  attachments[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  attachments[1] = attachments[0];
+  attachments[1].format = kDepthFormat;
+  attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+  VkAttachmentReference color_reference = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+  VkAttachmentReference depth_reference = {1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+  VkSubpassDescription subpass = {};
+  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  subpass.colorAttachmentCount = 1;
+  subpass.pColorAttachments = &color_reference;
+  subpass.pDepthStencilAttachment = &depth_reference;
+
+  VkSubpassDependency dependency = {};
+  dependency.srcSubpass = 0;
+  dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+  dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  dependency.dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  dependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+  VkRenderPassCreateInfo render_pass_info = {};
+  render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+  render_pass_info.attachmentCount = 2;
+  render_pass_info.pAttachments = attachments;
+  render_pass_info.subpassCount = 1;
+  render_pass_info.pSubpasses = &subpass;
+  render_pass_info.dependencyCount = 1;
+  render_pass_info.pDependencies = &dependency;
+  if (!Succeeded(vkCreateRenderPass(device_, &render_pass_info, nullptr, &render_pass_), "vkCreateRenderPass"))
+    return false;
+
+  // Descriptor sets: G buffer, noise and AO image for the HBAO, input and
+  // output images for every blur direction.
+  const VkDescriptorSetLayoutBinding kAoBindings[] = {
+      LayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER),
+      LayoutBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER),
+      LayoutBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)};
+  const VkDescriptorSetLayoutBinding kBlurBindings[] = {
+      LayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+      LayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)};
+
+  VkDescriptorSetLayoutCreateInfo set_info = {};
+  set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  set_info.bindingCount = 3;
+  set_info.pBindings = kAoBindings;
+  if (!Succeeded(vkCreateDescriptorSetLayout(device_, &set_info, nullptr, &ao_set_layout_),
+                 "vkCreateDescriptorSetLayout"))
+    return false;
+  set_info.bindingCount = 2;
+  set_info.pBindings = kBlurBindings;
+  if (!Succeeded(vkCreateDescriptorSetLayout(device_, &set_info, nullptr, &blur_set_layout_),
+                 "vkCreateDescriptorSetLayout"))
+    return false;
+
+  if (!CreatePipelineLayout(device_, nullptr, VK_SHADER_STAGE_VERTEX_BIT, 2 * 16 * sizeof(float), &g_layout_) ||
+      !CreatePipelineLayout(device_, &ao_set_layout_, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(HbaoConstants),
+                            &ao_layout_) ||
+      !CreatePipelineLayout(device_, &blur_set_layout_, VK_SHADER_STAGE_COMPUTE_BIT, sizeof(BlurConstants),
+                            &blur_layout_))
+    return false;
+
+  if (!CreateComputePipeline(device_, shader_dir + "hbao.comp.spv", ao_layout_, &ao_pipeline_) ||
+      !CreateComputePipeline(device_, shader_dir + "blur.comp.spv", blur_layout_, &blur_pipeline_))
+    return false;
+
+  // G pass pipeline: positions in binding 0, instance transforms in binding
+  // 1 at locations 2 to 5, as in the GL vertex array.
+  VkShaderModule vertex_module;
+  VkShaderModule fragment_module;
+  if (!CreateShaderModule(device_, shader_dir + "g.vert.spv", &vertex_module)) return false;
+  if (!CreateShaderModule(device_, shader_dir + "g.frag.spv", &fragment_module)) {
+    vkDestroyShaderModule(device_, vertex_module, nullptr);
+    return false;
+  }
+
+  VkPipelineShaderStageCreateInfo stages[2] = {};
+  stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+  stages[0].module = vertex_module;
+  stages[0].pName = "main";
+  stages[1] = stages[0];
+  stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+  stages[1].module = fragment_module;
+
+  const VkVertexInputBindingDescription kBindings[] = {
+      {0, 3 * sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX},
+      {1, 16 * sizeof(float), VK_VERTEX_INPUT_RATE_INSTANCE}};
+  const VkVertexInputAttributeDescription kAttributes[] = {
+      {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+      {2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 0},
+      {3, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 4 * sizeof(float)},
+      {4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 8 * sizeof(float)},
+      {5, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 12 * sizeof(float)}};
+
+  VkPipelineVertexInputStateCreateInfo vertex_input = {};
+  vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+  vertex_input.vertexBindingDescriptionCount = 2;
+  vertex_input.pVertexBindingDescriptions = kBindings;
+  vertex_input.vertexAttributeDescriptionCount = 5;
+  vertex_input.pVertexAttributeDescriptions = kAttributes;
+
+  VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
+  input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+  input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+  VkPipelineViewportStateCreateInfo viewport = {};
+  viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  viewport.viewportCount = 1;
+  viewport.scissorCount = 1;
+
+  // Without a y flip the framebuffer is laid out like the GL one. Vulkan
+  // measures the winding with y pointing down, so the GL counter-clockwise
+  // front faces are clockwise here.
+  VkPipelineRasterizationStateCreateInfo rasterization = {};
+  rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+  rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+  rasterization.cullMode = VK_CULL_MODE_BACK_BIT;
+  rasterization.frontFace = VK_FRONT_FACE_CLOCKWISE;
+  rasterization.lineWidth = 1.0f;
+
+  VkPipelineMultisampleStateCreateInfo multisample = {};
+  multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+  multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+  VkPipelineDepthStencilStateCreateInfo depth_stencil = {};
+  depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+  depth_stencil.depthTestEnable = VK_TRUE;
+  depth_stencil.depthWriteEnable = VK_TRUE;
+  depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+  VkPipelineColorBlendAttachmentState blend_attachment = {};
+  blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                    VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+  VkPipelineColorBlendStateCreateInfo blend = {};
+  blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+  blend.attachmentCount = 1;
+  blend.pAttachments = &blend_attachment;
+
+  const VkDynamicState kDynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+  VkPipelineDynamicStateCreateInfo dynamic = {};
+  dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+  dynamic.dynamicStateCount = 2;
+  dynamic.pDynamicStates = kDynamicStates;
+
+  VkGraphicsPipelineCreateInfo pipeline_info = {};
+  pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  pipeline_info.stageCount = 2;
+  pipeline_info.pStages = stages;
+  pipeline_info.pVertexInputState = &vertex_input;
+  pipeline_info.pInputAssemblyState = &input_assembly;
+  pipeline_info.pViewportState = &viewport;
+  pipeline_info.pRasterizationState = &rasterization;
+  pipeline_info.pMultisampleState = &multisample;
+  pipeline_info.pDepthStencilState = &depth_stencil;
+  pipeline_info.pColorBlendState = &blend;
+  pipeline_info.pDynamicState = &dynamic;
+  pipeline_info.layout = g_layout_;
+  pipeline_info.renderPass = render_pass_;
+
+  const bool kRes = Succeeded(
+      vkCreateGraphicsPipelines(device_, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &g_pipeline_),
+      "vkCreateGraphicsPipelines");
+  vkDestroyShaderModule(device_, vertex_module, nullptr);
+  vkDestroyShaderModule(device_, fragment_module, nullptr);
+  if (!kRes) return false;
+
+  VkSamplerCreateInfo sampler_info = {};
+  sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  sampler_info.magFilter = VK_FILTER_NEAREST;
+  sampler_info.minFilter = VK_FILTER_NEAREST;
+  sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+  sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  if (!Succeeded(vkCreateSampler(device_, &sampler_info, nullptr, &g_sampler_), "vkCreateSampler"))
+    return false;
+  sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  if (!Succeeded(vkCreateSampler(device_, &sampler_info, nullptr, &noise_sampler_), "vkCreateSampler"))
+    return false;
+
+  const VkDescriptorPoolSize kPoolSizes[] = {
+      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * kFramesInFlight},
+      {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 5 * kFramesInFlight}};
+  VkDescriptorPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.maxSets = 3 * kFramesInFlight;
+  pool_info.poolSizeCount = 2;
+  pool_info.pPoolSizes = kPoolSizes;
+  return Succeeded(vkCreateDescriptorPool(device_, &pool_info, nullptr, &descriptor_pool_),
+                   "vkCreateDescriptorPool");
+}
+
+bool VulkanRenderer::CreateNoiseTexture(const std::vector<float> &noise, int noise_side) {
+  if (noise_side <= 0 || noise.size() != static_cast<size_t>(noise_side) * noise_side) {
+    std::cerr << "Vulkan: invalid noise texture" << std::endl;
+    return false;
+  }
+
+  if (!CreateImage(noise_side, noise_side, kNoiseFormat,
+                   VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                   VK_IMAGE_ASPECT_COLOR_BIT, &noise_))
+    return false;
+
+  Buffer staging;
+  const VkDeviceSize kSize = noise.size() * sizeof(float);
+  if (!CreateBuffer(kSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                    &staging))
+    return false;
+
+  void *mapped = nullptr;
+  vkMapMemory(device_, staging.memory, 0, kSize, 0, &mapped);
+  std::memcpy(mapped, noise.data(), kSize);
+  vkUnmapMemory(device_, staging.memory);
+
+  const bool kRes = SubmitOnce([&](VkCommandBuffer commands) {
+    ImageBarrier(commands, noise_.image, VK_IMAGE_LAYOUT_UNDEFINED,
+                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferImageCopy region = {};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {static_cast<uint32_t>(noise_side), static_cast<uint32_t>(noise_side), 1};
+    vkCmdCopyBufferToImage(commands, staging.buffer, noise_.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = noise_.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+  });
+
+  DestroyBuffer(&staging);
+  return kRes;
+}
+
+bool VulkanRenderer::LoadScene(const data_representation::Scene &scene) {
+  if (!initialized()) return false;
+  vkDeviceWaitIdle(device_);
+
+  DestroyBuffer(&vertices_);
+  DestroyBuffer(&indices_);
+  DestroyBuffer(&instances_);
+
+  std::vector<float> transforms;
+  scene.BuildDraws(&draws_, &transforms);
+  if (draws_.empty()) return false;
+
+  return UploadBuffer(scene.vertices().data(), scene.vertices().size() * sizeof(float),
+                      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &vertices_) &&
+         UploadBuffer(scene.indices().data(), scene.indices().size() * sizeof(uint32_t),
+                      VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &indices_) &&
+         UploadBuffer(transforms.data(), transforms.size() * sizeof(float),
+                      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &instances_);
+}
+
+bool VulkanRenderer::Resize(int width, int height) {
+  if (!initialized() || width <= 0 || height <= 0) return false;
+  if (width == width_ && height == height_) return true;
+
+  vkDeviceWaitIdle(device_);
+  for (FrameResources &frame : frames_) DestroyFrameResources(&frame);
+  vkResetDescriptorPool(device_, descriptor_pool_, 0);
+
+  width_ = width;
+  height_ = height;
+  for (FrameResources &frame : frames_) {
+    if (!CreateFrameResources(&frame)) {
+      width_ = 0;
+      height_ = 0;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VulkanRenderer::CreateFrameResources(FrameResources *frame) {
+  const VkImageUsageFlags kStorage = VK_IMAGE_USAGE_STORAGE_BIT;
+  if (!CreateImage(width_, height_, kGFormat,
+                   VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                   VK_IMAGE_ASPECT_COLOR_BIT, &frame->g) ||
+      !CreateImage(width_, height_, kDepthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                   VK_IMAGE_ASPECT_DEPTH_BIT, &frame->depth) ||
+      !CreateImage(width_, height_, kAoFormat, kStorage, VK_IMAGE_ASPECT_COLOR_BIT, &frame->ao) ||
+      !CreateImage(width_, height_, kAoFormat, kStorage, VK_IMAGE_ASPECT_COLOR_BIT, &frame->blur))
+    return false;
+
+  const VkImageView kAttachments[] = {frame->g.view, frame->depth.view};
+  VkFramebufferCreateInfo framebuffer_info = {};
+  framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+  framebuffer_info.renderPass = render_pass_;
+  framebuffer_info.attachmentCount = 2;
+  framebuffer_info.pAttachments = kAttachments;
+  framebuffer_info.width = static_cast<uint32_t>(width_);
+  framebuffer_info.height = static_cast<uint32_t>(height_);
+  framebuffer_info.layers = 1;
+  if (!Succeeded(vkCreateFramebuffer(device_, &framebuffer_info, nullptr, &frame->framebuffer),
+                 "vkCreateFramebuffer"))
+    return false;
+
+  const VkDescriptorSetLayout kLayouts[] = {ao_set_layout_, blur_set_layout_, blur_set_layout_};
+  VkDescriptorSet sets[3];
+  VkDescriptorSetAllocateInfo allocate_info = {};
+  allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocate_info.descriptorPool = descriptor_pool_;
+  allocate_info.descriptorSetCount = 3;
+  allocate_info.pSetLayouts = kLayouts;
+  if (!Succeeded(vkAllocateDescriptorSets(device_, &allocate_info, sets), "vkAllocateDescriptorSets"))
+    return false;
+  frame->ao_set = sets[0];
+  frame->blur_sets[0] = sets[1];
+  frame->blur_sets[1] = sets[2];
+
+  const VkDescriptorImageInfo kG = {g_sampler_, frame->g.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+  const VkDescriptorImageInfo kNoise = {noise_sampler_, noise_.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+  const VkDescriptorImageInfo kAo = {VK_NULL_HANDLE, frame->ao.view, VK_IMAGE_LAYOUT_GENERAL};
+  const VkDescriptorImageInfo kBlur = {VK_NULL_HANDLE, frame->blur.view, VK_IMAGE_LAYOUT_GENERAL};
+
+  // The horizontal blur goes from the AO to the blur image, the vertical one
+  // back, so that the AO image always holds the result.
+  struct Write {
+    VkDescriptorSet set;
+    uint32_t binding;
+    VkDescriptorType type;
+    const VkDescriptorImageInfo *image;
+  };
+  const Write kWrites[] = {
+      {frame->ao_set, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &kG},
+      {frame->ao_set, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &kNoise},
+      {frame->ao_set, 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &kAo},
+      {frame->blur_sets[0], 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &kAo},
+      {frame->blur_sets[0], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &kBlur},
+      {frame->blur_sets[1], 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &kBlur},
+      {frame->blur_sets[1], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &kAo}};
+
+  std::vector<VkWriteDescriptorSet> writes;
+  for (const Write &kWrite : kWrites) {
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = kWrite.set;
+    write.dstBinding = kWrite.binding;
+    write.descriptorCount = 1;
+    write.descriptorType = kWrite.type;
+    write.pImageInfo = kWrite.image;
+    writes.push_back(write);
+  }
+  vkUpdateDescriptorSets(device_, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+  return SubmitOnce([&](VkCommandBuffer commands) {
+    const VkAccessFlags kAccess = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    ImageBarrier(commands, frame->ao.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                 kAccess, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    ImageBarrier(commands, frame->blur.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                 kAccess, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+  });
+}
+
+void VulkanRenderer::DestroyFrameResources(FrameResources *frame) {
+  if (frame->framebuffer != VK_NULL_HANDLE)
+    vkDestroyFramebuffer(device_, frame->framebuffer, nullptr);
+  frame->framebuffer = VK_NULL_HANDLE;
+  DestroyImage(&frame->g);
+  DestroyImage(&frame->depth);
+  DestroyImage(&frame->ao);
+  DestroyImage(&frame->blur);
+}
+
+bool VulkanRenderer::Render(const std::vector<VulkanFrame> &frames,
+                            const AoParameters &parameters, unsigned int blur,
+                            bool async_compute, VulkanStats *stats) {
+  if (!initialized() || width_ == 0 || draws_.empty()) return false;
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  const VkPipelineStageFlags kComputeWait = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+  vkDeviceWaitIdle(device_);
+  const auto kStart = std::chrono::steady_clock::now();
+
+  bool res = true;
+  for (size_t i = 0; i < frames.size() && res; ++i) {
+    // Frame i + 1 renders its G pass into the other set of resources while
+    // the compute queue is still on frame i. Frame i + 2 waits for frame i.
+    FrameResources &frame = frames_[i % kFramesInFlight];
+    res = WaitFrame(&frame);
+    if (!res) break;
+
+    vkBeginCommandBuffer(frame.graphics_commands, &begin_info);
+    RecordGPass(frame.graphics_commands, frame, frames[i]);
+    if (!async_compute)
+      RecordAo(frame.graphics_commands, frame, frames[i], parameters, blur);
+    vkEndCommandBuffer(frame.graphics_commands);
+
+    VkSubmitInfo submit = {};
+    submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &frame.graphics_commands;
+    if (async_compute) {
+      submit.signalSemaphoreCount = 1;
+      submit.pSignalSemaphores = &frame.g_done;
+    }
+    res = Succeeded(vkQueueSubmit(graphics_queue_, 1, &submit, frame.graphics_fence), "vkQueueSubmit");
+    frame.graphics_pending = res;
+    if (!res || !async_compute) continue;
+
+    vkBeginCommandBuffer(frame.compute_commands, &begin_info);
+    RecordAo(frame.compute_commands, frame, frames[i], parameters, blur);
+    vkEndCommandBuffer(frame.compute_commands);
+
+    submit.waitSemaphoreCount = 1;
+    submit.pWaitSemaphores = &frame.g_done;
+    submit.pWaitDstStageMask = &kComputeWait;
+    submit.signalSemaphoreCount = 0;
+    submit.pSignalSemaphores = nullptr;
+    submit.pCommandBuffers = &frame.compute_commands;
+    res = Succeeded(vkQueueSubmit(compute_queue_, 1, &submit, frame.compute_fence), "vkQueueSubmit");
+    frame.compute_pending = res;
+  }
+
+  for (FrameResources &frame : frames_) res = WaitFrame(&frame) && res;
+
+  stats->frames = frames.size();
+  stats->ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+  stats->async_compute = async_compute;
+  stats->dedicated_queue = async_compute && dedicated_compute_queue();
+  return res;
+}
+
+bool VulkanRenderer::WaitFrame(FrameResources *frame) {
+  std::vector<VkFence> fences;
+  if (frame->graphics_pending) fences.push_back(frame->graphics_fence);
+  if (frame->compute_pending) fences.push_back(frame->compute_fence);
+  frame->graphics_pending = false;
+  frame->compute_pending = false;
+  if (fences.empty()) return true;
+
+  const uint32_t kCount = static_cast<uint32_t>(fences.size());
+  return Succeeded(vkWaitForFences(device_, kCount, fences.data(), VK_TRUE, UINT64_MAX), "vkWaitForFences") &&
+         Succeeded(vkResetFences(device_, kCount, fences.data()), "vkResetFences");
+}
+
+void VulkanRenderer::RecordGPass(VkCommandBuffer commands, const FrameResources &frame,
+                                 const VulkanFrame &camera) {
+  VkClearValue clear[2] = {};
+  clear[1].depthStencil.depth = 1.0f;
+
+  VkRenderPassBeginInfo pass_info = {};
+  pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  pass_info.renderPass = render_pass_;
+  pass_info.framebuffer = frame.framebuffer;
+  pass_info.renderArea.extent = {static_cast<uint32_t>(width_), static_cast<uint32_t>(height_)};
+  pass_info.clearValueCount = 2;
+  pass_info.pClearValues = clear;
+  vkCmdBeginRenderPass(commands, &pass_info, VK_SUBPASS_CONTENTS_INLINE);
+
+  const VkViewport kViewport = {0.0f, 0.0f, static_cast<float>(width_), static_cast<float>(height_),
+                                0.0f, 1.0f};
+  vkCmdSetViewport(commands, 0, 1, &kViewport);
+  vkCmdSetScissor(commands, 0, 1, &pass_info.renderArea);
+
+  float matrices[32];
+  std::memcpy(matrices, camera.projection.data(), 16 * sizeof(float));
+  std::memcpy(matrices + 16, camera.view_model.data(), 16 * sizeof(float));
+  vkCmdBindPipeline(commands, VK_PIPELINE_BIND_POINT_GRAPHICS, g_pipeline_);
+  vkCmdPushConstants(commands, g_layout_, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(matrices), matrices);
+
+  const VkBuffer kBuffers[] = {vertices_.buffer, instances_.buffer};
+  const VkDeviceSize kOffsets[] = {0, 0};
+  vkCmdBindVertexBuffers(commands, 0, 2, kBuffers, kOffsets);
+  vkCmdBindIndexBuffer(commands, indices_.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+  for (const data_representation::DrawCommand &kDraw : draws_)
+    vkCmdDrawIndexed(commands, kDraw.count, kDraw.instance_count, kDraw.first_index,
+                     static_cast<int32_t>(kDraw.base_vertex), kDraw.base_instance);
+
+  vkCmdEndRenderPass(commands);
+}
+
+void VulkanRenderer::RecordAo(VkCommandBuffer commands, const FrameResources &frame,
+                              const VulkanFrame &camera, const AoParameters &parameters,
+                              unsigned int blur) {
+  HbaoConstants constants;
+  std::memcpy(constants.projection, camera.projection.data(), sizeof(constants.projection));
+  constants.tan_half_fov = 1.0f / camera.projection(1, 1);
+  constants.aspect_ratio = camera.projection(1, 1) / camera.projection(0, 0);
+  constants.ray_center[0] = 0.0f;
+  constants.ray_center[1] = 0.0f;
+  constants.pixel_size[0] = 1.0f / width_;
+  constants.pixel_size[1] = 1.0f / height_;
+  constants.viewport_size[0] = width_;
+  constants.viewport_size[1] = height_;
+  constants.directions = parameters.directions;
+  constants.steps = parameters.steps;
+  constants.radius = parameters.radius;
+  constants.t_bias = parameters.t_bias;
+  constants.strength = parameters.strength;
+
+  const uint32_t kGroupsX = (static_cast<uint32_t>(width_) + kComputeTile - 1) / kComputeTile;
+  const uint32_t kGroupsY = (static_cast<uint32_t>(height_) + kComputeTile - 1) / kComputeTile;
+
+  vkCmdBindPipeline(commands, VK_PIPELINE_BIND_POINT_COMPUTE, ao_pipeline_);
+  vkCmdBindDescriptorSets(commands, VK_PIPELINE_BIND_POINT_COMPUTE, ao_layout_, 0, 1,
+                          &frame.ao_set, 0, nullptr);
+  vkCmdPushConstants(commands, ao_layout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+  vkCmdDispatch(commands, kGroupsX, kGroupsY, 1);
+
+  if (blur == 0) return;
+
+  vkCmdBindPipeline(commands, VK_PIPELINE_BIND_POINT_COMPUTE, blur_pipeline_);
+  for (unsigned int i = 0; i < blur; ++i) {
+    for (int direction = 0; direction < 2; ++direction) {
+      const BlurConstants kBlur = {{direction == 0 ? 1 : 0, direction == 0 ? 0 : 1}, {width_, height_}};
+      ComputeBarrier(commands);
+      vkCmdBindDescriptorSets(commands, VK_PIPELINE_BIND_POINT_COMPUTE, blur_layout_, 0, 1,
+                              &frame.blur_sets[direction], 0, nullptr);
+      vkCmdPushConstants(commands, blur_layout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(kBlur), &kBlur);
+      vkCmdDispatch(commands, kGroupsX, kGroupsY, 1);
+    }
+  }
+}
+
+bool VulkanRenderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                  VkMemoryPropertyFlags properties, Buffer *buffer) {
+  VkBufferCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  info.size = std::max<VkDeviceSize>(size, 4);
+  info.usage = usage;
+  info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  if (!Succeeded(vkCreateBuffer(device_, &info, nullptr, &buffer->buffer), "vkCreateBuffer")) return false;
+
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements(device_, buffer->buffer, &requirements);
+  const int kType = FindMemoryType(requirements.memoryTypeBits, properties);
+  if (kType < 0) return false;
+
+  VkMemoryAllocateInfo allocate_info = {};
+  allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocate_info.allocationSize = requirements.size;
+  allocate_info.memoryTypeIndex = static_cast<uint32_t>(kType);
+  if (!Succeeded(vkAllocateMemory(device_, &allocate_info, nullptr, &buffer->memory), "vkAllocateMemory"))
+    return false;
+  return Succeeded(vkBindBufferMemory(device_, buffer->buffer, buffer->memory, 0), "vkBindBufferMemory");
+}
+
+bool VulkanRenderer::UploadBuffer(const void *data, VkDeviceSize size,
+                                  VkBufferUsageFlags usage, Buffer *buffer) {
+  Buffer staging;
+  if (!CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                    &staging) ||
+      !CreateBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer)) {
+    DestroyBuffer(&staging);
+    return false;
+  }
+
+  void *mapped = nullptr;
+  vkMapMemory(device_, staging.memory, 0, size, 0, &mapped);
+  std::memcpy(mapped, data, size);
+  vkUnmapMemory(device_, staging.memory);
+
+  const bool kRes = SubmitOnce([&](VkCommandBuffer commands) {
+    VkBufferCopy region = {};
+    region.size = size;
+    vkCmdCopyBuffer(commands, staging.buffer, buffer->buffer, 1, &region);
+  });
+
+  DestroyBuffer(&staging);
+  return kRes;
+}
+
+void VulkanRenderer::DestroyBuffer(Buffer *buffer) {
+  if (buffer->buffer != VK_NULL_HANDLE) vkDestroyBuffer(device_, buffer->buffer, nullptr);
+  if (buffer->memory != VK_NULL_HANDLE) vkFreeMemory(device_, buffer->memory, nullptr);
+  *buffer = Buffer();
+}
+
+bool VulkanRenderer::CreateImage(int width, int height, VkFormat format,
+                                 VkImageUsageFlags usage, VkImageAspectFlags aspect,
+                                 Image *image) {
+  // Images shared by the graphics and the compute family are concurrent, so
+  // that no ownership transfer is needed between the queues.
+  const uint32_t kFamilies[] = {graphics_family_, compute_family_};
+
+  VkImageCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  info.imageType = VK_IMAGE_TYPE_2D;
+  info.format = format;
+  info.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+  info.mipLevels = 1;
+  info.arrayLayers = 1;
+  info.samples = VK_SAMPLE_COUNT_1_BIT;
+  info.tiling = VK_IMAGE_TILING_OPTIMAL;
+  info.usage = usage;
+  info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  if (compute_family_ != graphics_family_) {
+    info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    info.queueFamilyIndexCount = 2;
+    info.pQueueFamilyIndices = kFamilies;
+  } else {
+    info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  }
+  if (!Succeeded(vkCreateImage(device_, &info, nullptr, &image->image), "vkCreateImage")) return false;
+
+  VkMemoryRequirements requirements;
+  vkGetImageMemoryRequirements(device_, image->image, &requirements);
+  const int kType = FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  if (kType < 0) return false;
+
+  VkMemoryAllocateInfo allocate_info = {};
+  allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocate_info.allocationSize = requirements.size;
+  allocate_info.memoryTypeIndex = static_cast<uint32_t>(kType);
+  if (!Succeeded(vkAllocateMemory(device_, &allocate_info, nullptr, &image->memory), "vkAllocateMemory") ||
+      !Succeeded(vkBindImageMemory(device_, image->image, image->memory, 0), "vkBindImageMemory"))
+    return false;
+
+  VkImageViewCreateInfo view_info = {};
+  view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  view_info.image = image->image;
+  view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+  view_info.format = format;
+  view_info.subresourceRange.aspectMask = aspect;
+  view_info.subresourceRange.levelCount = 1;
+  view_info.subresourceRange.layerCount = 1;
+  return Succeeded(vkCreateImageView(device_, &view_info, nullptr, &image->view), "vkCreateImageView");
+}
+
+void VulkanRenderer::DestroyImage(Image *image) {
+  if (image->view != VK_NULL_HANDLE) vkDestroyImageView(device_, image->view, nullptr);
+  if (image->image != VK_NULL_HANDLE) vkDestroyImage(device_, image->image, nullptr);
+  if (image->memory != VK_NULL_HANDLE) vkFreeMemory(device_, image->memory, nullptr);
+  *image = Image();
+}
+
+int VulkanRenderer::FindMemoryType(uint32_t type_bits, VkMemoryPropertyFlags properties) const {
+  VkPhysicalDeviceMemoryProperties memory;
+  vkGetPhysicalDeviceMemoryProperties(physical_device_, &memory);
+  for (uint32_t i = 0; i < memory.memoryTypeCount; ++i) {
+    if ((type_bits & (1u << i)) != 0 &&
+        (memory.memoryTypes[i].propertyFlags & properties) == properties)
+      return static_cast<int>(i);
+  }
+
+  std::cerr << "Vulkan: no suitable memory type" << std::endl;
+  return -1;
+}
+
+template <typename Record>
+bool VulkanRenderer::SubmitOnce(Record record) {
+  VkCommandBufferAllocateInfo allocate_info = {};
+  allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocate_info.commandPool = graphics_pool_;
+  allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocate_info.commandBufferCount = 1;
+
+  VkCommandBuffer commands;
+  if (!Succeeded(vkAllocateCommandBuffers(device_, &allocate_info, &commands), "vkAllocateCommandBuffers"))
+    return false;
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(commands, &begin_info);
+  record(commands);
+  vkEndCommandBuffer(commands);
+
+  VkSubmitInfo submit = {};
+  submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit.commandBufferCount = 1;
+  submit.pCommandBuffers = &commands;
+  const bool kRes = Succeeded(vkQueueSubmit(graphics_queue_, 1, &submit, VK_NULL_HANDLE), "vkQueueSubmit") &&
+                    Succeeded(vkQueueWaitIdle(graphics_queue_), "vkQueueWaitIdle");
+
+  vkFreeCommandBuffers(device_, graphics_pool_, 1, &commands);
+  return kRes;
+}
+
+void VulkanRenderer::Release() {
+  if (device_ != VK_NULL_HANDLE) {
+    vkDeviceWaitIdle(device_);
+
+    for (FrameResources &frame : frames_) {
+      DestroyFrameResources(&frame);
+      if (frame.g_done != VK_NULL_HANDLE) vkDestroySemaphore(device_, frame.g_done, nullptr);
+      if (frame.graphics_fence != VK_NULL_HANDLE) vkDestroyFence(device_, frame.graphics_fence, nullptr);
+      if (frame.compute_fence != VK_NULL_HANDLE) vkDestroyFence(device_, frame.compute_fence, nullptr);
+      frame = FrameResources();
+    }
+
+    DestroyBuffer(&vertices_);
+    DestroyBuffer(&indices_);
+    DestroyBuffer(&instances_);
+    DestroyImage(&noise_);
+
+    vkDestroySampler(device_, g_sampler_, nullptr);
+    vkDestroySampler(device_, noise_sampler_, nullptr);
+    vkDestroyDescriptorPool(device_, descriptor_pool_, nullptr);
+    vkDestroyPipeline(device_, g_pipeline_, nullptr);
+    vkDestroyPipeline(device_, ao_pipeline_, nullptr);
+    vkDestroyPipeline(device_, blur_pipeline_, nullptr);
+    vkDestroyPipelineLayout(device_, g_layout_, nullptr);
+    vkDestroyPipelineLayout(device_, ao_layout_, nullptr);
+    vkDestroyPipelineLayout(device_, blur_layout_, nullptr);
+    vkDestroyDescriptorSetLayout(device_, ao_set_layout_, nullptr);
+    vkDestroyDescriptorSetLayout(device_, blur_set_layout_, nullptr);
+    vkDestroyRenderPass(device_, render_pass_, nullptr);
+    vkDestroyCommandPool(device_, graphics_pool_, nullptr);
+    vkDestroyCommandPool(device_, compute_pool_, nullptr);
+    vkDestroyDevice(device_, nullptr);
+  }
+  if (instance_ != VK_NULL_HANDLE) vkDestroyInstance(instance_, nullptr);
+
+  instance_ = VK_NULL_HANDLE;
+  physical_device_ = VK_NULL_HANDLE;
+  device_ = VK_NULL_HANDLE;
+  graphics_queue_ = VK_NULL_HANDLE;
+  compute_queue_ = VK_NULL_HANDLE;
+  graphics_pool_ = VK_NULL_HANDLE;
+  compute_pool_ = VK_NULL_HANDLE;
+  render_pass_ = VK_NULL_HANDLE;
+  ao_set_layout_ = VK_NULL_HANDLE;
+  blur_set_layout_ = VK_NULL_HANDLE;
+  g_layout_ = VK_NULL_HANDLE;
+  ao_layout_ = VK_NULL_HANDLE;
+  blur_layout_ = VK_NULL_HANDLE;
+  g_pipeline_ = VK_NULL_HANDLE;
+  ao_pipeline_ = VK_NULL_HANDLE;
+  blur_pipeline_ = VK_NULL_HANDLE;
+  descriptor_pool_ = VK_NULL_HANDLE;
+  g_sampler_ = VK_NULL_HANDLE;
+  noise_sampler_ = VK_NULL_HANDLE;
+  draws_.clear();
+  width_ = 0;
+  height_ = 0;
+}
+
+}  //  namespace data_visualization
@@ -0,0 +1,231 @@
+// Author: Marc Comino 2020
+
+#ifndef VULKAN_BACKEND_H_
+#define VULKAN_BACKEND_H_
+
+#include <vulkan/vulkan.h>
+
+#include <eigen3/Eigen/Geometry>
+#include <string>
+#include <vector>
+
+#include "./ao_technique.h"
+#include "./scene.h"
+
+namespace data_visualization {
+
+/**
+ * @brief VulkanFrame Camera of a frame rendered by the Vulkan backend, with
+ * the GL conventions of Camera.
+ */
+struct VulkanFrame {
+  Eigen::Matrix<float, 4, 4, Eigen::DontAlign> projection;
+  Eigen::Matrix<float, 4, 4, Eigen::DontAlign> view_model;
+};
+
+/**
+ * @brief VulkanStats Throughput of a batch of frames.
+ */
+struct VulkanStats {
+  size_t frames = 0;
+  double ms = 0.0;
+  bool async_compute = false;
+
+  /**
+   * @brief dedicated_queue Whether the compute work went to a different queue
+   * than the G pass, so that it could actually overlap.
+   */
+  bool dedicated_queue = false;
+
+  double FramesPerSecond() const { return ms > 0.0 ? 1000.0 * frames / ms : 0.0; }
+};
+
+/**
+ * @brief VulkanRenderer Headless Vulkan implementation of the G pass, the
+ * compute HBAO and the blur. The G pass runs on a graphics queue and the AO
+ * and blur on a compute queue, with two sets of frame resources so that the
+ * AO of a frame overlaps the G pass of the next one. It renders offscreen and
+ * runs on any conformant driver, including lavapipe.
+ */
+class VulkanRenderer {
+ public:
+  VulkanRenderer() {}
+  ~VulkanRenderer();
+
+  VulkanRenderer(const VulkanRenderer &) = delete;
+  VulkanRenderer &operator=(const VulkanRenderer &) = delete;
+
+  /**
+   * @brief Initialize Creates the instance, the device, its queues and the
+   * pipelines.
+   * @param shader_dir Directory with the SPIR-V of the res/shaders/vk shaders.
+   * @param noise Square noise texture values, in [0, 1].
+   * @param noise_side Side of the noise texture.
+   * @return Whether a usable device was found and every object was created.
+   */
+  bool Initialize(const std::string &shader_dir, const std::vector<float> &noise,
+                  int noise_side);
+
+  /**
+   * @brief LoadScene Uploads the arena and the instance transforms of a scene.
+   * @return Whether the buffers were created.
+   */
+  bool LoadScene(const data_representation::Scene &scene);
+
+  /**
+   * @brief Resize Recreates the per frame targets.
+   * @return Whether the targets were created.
+   */
+  bool Resize(int width, int height);
+
+  /**
+   * @brief Render Renders a batch of frames and waits for the last one.
+   * @param frames Cameras of the frames.
+   * @param parameters HBAO parameters.
+   * @param blur Blur iterations.
+   * @param async_compute Whether to submit the AO and blur to the compute
+   * queue, overlapping the next G pass, or after the G pass in the same
+   * command buffer of the graphics queue.
+   * @param stats Time of the batch.
+   * @return Whether every frame was submitted.
+   */
+  bool Render(const std::vector<VulkanFrame> &frames, const AoParameters &parameters,
+              unsigned int blur, bool async_compute, VulkanStats *stats);
+
+  /**
+   * @brief Release Destroys every Vulkan object.
+   */
+  void Release();
+
+  bool initialized() const { return device_ != VK_NULL_HANDLE; }
+
+  const std::string &device_name() const { return device_name_; }
+
+  /**
+   * @brief dedicated_compute_queue Whether there is a compute queue other
+   * than the graphics one.
+   */
+  bool dedicated_compute_queue() const { return compute_queue_ != graphics_queue_; }
+
+ private:
+  static const size_t kFramesInFlight = 2;
+
+  struct Buffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+  };
+
+  struct Image {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+  };
+
+  /**
+   * @brief FrameResources Everything a frame in flight writes.
+   */
+  struct FrameResources {
+    Image g;
+    Image depth;
+    Image ao;
+    Image blur;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+    VkDescriptorSet ao_set = VK_NULL_HANDLE;
+    VkDescriptorSet blur_sets[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+
+    VkCommandBuffer graphics_commands = VK_NULL_HANDLE;
+    VkCommandBuffer compute_commands = VK_NULL_HANDLE;
+
+    /**
+     * @brief g_done Signaled by the G pass, waited by the compute queue.
+     */
+    VkSemaphore g_done = VK_NULL_HANDLE;
+
+    VkFence graphics_fence = VK_NULL_HANDLE;
+    VkFence compute_fence = VK_NULL_HANDLE;
+    bool graphics_pending = false;
+    bool compute_pending = false;
+  };
+
+  bool CreateDevice();
+  bool CreatePipelines(const std::string &shader_dir);
+  bool CreateNoiseTexture(const std::vector<float> &noise, int noise_side);
+  bool CreateFrameResources(FrameResources *frame);
+  void DestroyFrameResources(FrameResources *frame);
+
+  bool CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                    VkMemoryPropertyFlags properties, Buffer *buffer);
+
+  /**
+   * @brief UploadBuffer Creates a device local buffer with the given data.
+   */
+  bool UploadBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage,
+                    Buffer *buffer);
+  void DestroyBuffer(Buffer *buffer);
+
+  bool CreateImage(int width, int height, VkFormat format, VkImageUsageFlags usage,
+                   VkImageAspectFlags aspect, Image *image);
+  void DestroyImage(Image *image);
+
+  /**
+   * @brief FindMemoryType Index of a memory type allowed by type_bits with
+   * the given properties, or -1.
+   */
+  int FindMemoryType(uint32_t type_bits, VkMemoryPropertyFlags properties) const;
+
+  /**
+   * @brief SubmitOnce Records and runs a command buffer on the graphics queue
+   * and waits for it.
+   */
+  template <typename Record>
+  bool SubmitOnce(Record record);
+
+  void RecordGPass(VkCommandBuffer commands, const FrameResources &frame,
+                   const VulkanFrame &camera);
+  void RecordAo(VkCommandBuffer commands, const FrameResources &frame,
+                const VulkanFrame &camera, const AoParameters &parameters,
+                unsigned int blur);
+
+  bool WaitFrame(FrameResources *frame);
+
+  VkInstance instance_ = VK_NULL_HANDLE;
+  VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
+  VkDevice device_ = VK_NULL_HANDLE;
+  std::string device_name_;
+
+  uint32_t graphics_family_ = 0;
+  uint32_t compute_family_ = 0;
+  VkQueue graphics_queue_ = VK_NULL_HANDLE;
+  VkQueue compute_queue_ = VK_NULL_HANDLE;
+  VkCommandPool graphics_pool_ = VK_NULL_HANDLE;
+  VkCommandPool compute_pool_ = VK_NULL_HANDLE;
+
+  VkRenderPass render_pass_ = VK_NULL_HANDLE;
+  VkDescriptorSetLayout ao_set_layout_ = VK_NULL_HANDLE;
+  VkDescriptorSetLayout blur_set_layout_ = VK_NULL_HANDLE;
+  VkPipelineLayout g_layout_ = VK_NULL_HANDLE;
+  VkPipelineLayout ao_layout_ = VK_NULL_HANDLE;
+  VkPipelineLayout blur_layout_ = VK_NULL_HANDLE;
+  VkPipeline g_pipeline_ = VK_NULL_HANDLE;
+  VkPipeline ao_pipeline_ = VK_NULL_HANDLE;
+  VkPipeline blur_pipeline_ = VK_NULL_HANDLE;
+  VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;
+
+  VkSampler g_sampler_ = VK_NULL_HANDLE;
+  VkSampler noise_sampler_ = VK_NULL_HANDLE;
+  Image noise_;
+
+  Buffer vertices_;
+  Buffer indices_;
+  Buffer instances_;
+  std::vector<data_representation::DrawCommand> draws_;
+
+  int width_ = 0;
+  int height_ = 0;
+  FrameResources frames_[kFramesInFlight];
+};
+
+}  //  namespace data_visualization
+
+#endif  //  VULKAN_BACKEND_H_